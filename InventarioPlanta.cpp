@@ -0,0 +1,2966 @@
+#include "InventarioPlanta.h"
+
+#include <sys/mman.h>
+
+const char* nombreTipoMotor(TipoMotor tipo) {
+    switch (tipo) {
+        case TipoMotor::Alta:   return "MotorAlta";
+        case TipoMotor::Fuerza: return "MotorFuerza";
+        default:                return "MotorTrabajo";
+    }
+}
+
+const char* nombreTipoCarro(TipoCarro tipo) {
+    switch (tipo) {
+        case TipoCarro::Formula1: return "Formula1";
+        case TipoCarro::Omnibus:  return "Omnibus";
+        case TipoCarro::Sport:    return "Sport";
+        default:                  return "DeLujo";
+    }
+}
+
+ConfiguracionReporte configuracionReporte;
+
+// Fichas técnicas de motores y carros
+
+void Motor::escribirFicha(EscritorReporte& escritor) const {
+    char fecha[LONGITUD_FECHA];
+    escritor.campo("Código", "codigo", codigo.vista());
+    escritor.campo("Fecha de salida", "fechaSalida", fechaSalida.escribir(fecha));
+    escritor.campo("Especialista", "especialista", getEspecialista());
+    escritor.campo("Veces reensamblado", "vecesReensamblado", vecesReensamblado);
+}
+
+void Motor::mostrarFichaTecnica() const {
+    EscritorReporte escritor;
+    escritor.iniciarFicha(nombreTipoMotor(tipo));
+    escribirFicha(escritor);
+    escritor.terminarFicha();
+}
+
+void MotorAlta::escribirFicha(EscritorReporte& escritor) const {
+    Motor::escribirFicha(escritor);
+    escritor.campo("Máximas RPM", "maxRPM", maxRPM);
+    escritor.campo("Consumo (km/l)", "consumo", consumo);
+    escritor.campo("Costo", "costo", calcularCosto());
+}
+
+void MotorFuerza::escribirFicha(EscritorReporte& escritor) const {
+    Motor::escribirFicha(escritor);
+    escritor.campo("Caballos de fuerza", "caballosFuerza", caballosFuerza);
+    escritor.campo("Costo", "costo", calcularCosto());
+}
+
+void MotorTrabajo::escribirFicha(EscritorReporte& escritor) const {
+    Motor::escribirFicha(escritor);
+    escritor.campo("Artesanal", "artesanal", artesanal);
+    escritor.campo("Costo", "costo", calcularCosto());
+}
+
+void Carro::escribirFicha(EscritorReporte& escritor) const {
+    char fecha[LONGITUD_FECHA];
+    escritor.campo("Fecha de salida", "fechaSalida", fechaSalida.escribir(fecha));
+    escritor.campo("Cantidad de plazas", "cantidadPlazas", cantidadPlazas);
+    escritor.campo("Velocidad", "velocidad", velocidad, "km/h");
+    escritor.abrirSeccion("--- Ficha técnica del motor ---", "motor");
+    motor->escribirFicha(escritor);
+    escritor.cerrarSeccion();
+}
+
+void Carro::mostrarFichaTecnica() const {
+    EscritorReporte escritor;
+    escritor.iniciarFicha(nombreTipoCarro(tipo));
+    escribirFicha(escritor);
+    escritor.terminarFicha();
+}
+
+void Formula1::escribirFicha(EscritorReporte& escritor) const {
+    escritor.texto("--- Ficha técnica del Formula1 ---");
+    Carro::escribirFicha(escritor);
+    escritor.campo("Peso de la carrocería", "pesoCarroceria", pesoCarroceria, "kg");
+    escritor.campo("Precio de venta", "precioVenta", calcularPrecioVenta());
+}
+
+void Omnibus::escribirFicha(EscritorReporte& escritor) const {
+    escritor.texto("--- Ficha técnica del Ómnibus ---");
+    Carro::escribirFicha(escritor);
+    escritor.campo("Cantidad de puertas", "cantidadPuertas", cantidadPuertas);
+    escritor.campo("Precio de venta", "precioVenta", calcularPrecioVenta());
+}
+
+void Sport::escribirFicha(EscritorReporte& escritor) const {
+    escritor.texto("--- Ficha técnica del Sport ---");
+    Carro::escribirFicha(escritor);
+    escritor.campo("Cantidad de velocidades", "cantidadVelocidades", cantidadVelocidades);
+    escritor.campo("Cambio universal", "cambioUniversal", cambioUniversal);
+    escritor.campo("Precio de venta", "precioVenta", calcularPrecioVenta());
+}
+
+void DeLujo::escribirFicha(EscritorReporte& escritor) const {
+    escritor.texto("--- Ficha técnica del Carro de Lujo ---");
+    Carro::escribirFicha(escritor);
+    escritor.campo("Costo de la tapicería", "costoTapiceria", costoTapiceria);
+    escritor.campo("Precio de venta", "precioVenta", calcularPrecioVenta());
+}
+
+SensibilidadPrecio calcularSensibilidadPrecio(const Carro& carro) {
+    return visitarCarro(carro, [](const auto& concreto) {
+        return SensibilidadPrecio{concreto.calcularPrecioVenta(), concreto.variacionPrecioPorReensamblaje()};
+    });
+}
+
+// Contador de asignaciones de memoria (reemplazo de los operadores new y delete globales)
+
+std::atomic<bool> contarAsignaciones{false};
+std::atomic<uint64_t> asignacionesContadas{0};
+std::atomic<uint64_t> bytesAsignadosContados{0};
+
+ConteoAsignaciones leerAsignaciones() {
+    return {asignacionesContadas.load(std::memory_order_relaxed), bytesAsignadosContados.load(std::memory_order_relaxed)};
+}
+
+// Asignaciones desde la lectura inicio
+ConteoAsignaciones asignacionesDesde(const ConteoAsignaciones& inicio) {
+    ConteoAsignaciones actual = leerAsignaciones();
+    return {actual.asignaciones - inicio.asignaciones, actual.bytes - inicio.bytes};
+}
+
+void anotarAsignacion(std::size_t tamano) {
+    if (contarAsignaciones.load(std::memory_order_relaxed)) {
+        asignacionesContadas.fetch_add(1, std::memory_order_relaxed);
+        bytesAsignadosContados.fetch_add(tamano, std::memory_order_relaxed);
+    }
+}
+
+void* asignarMemoria(std::size_t tamano) {
+    anotarAsignacion(tamano);
+    void* memoria = std::malloc(tamano ? tamano : 1);
+    if (!memoria) {
+        throw std::bad_alloc();
+    }
+    return memoria;
+}
+
+void* asignarMemoriaAlineada(std::size_t tamano, std::align_val_t alineacion) {
+    anotarAsignacion(tamano);
+    std::size_t bytesAlineacion = static_cast<std::size_t>(alineacion);
+    // aligned_alloc pide un tamaño múltiplo de la alineación
+    void* memoria = std::aligned_alloc(bytesAlineacion, (tamano + bytesAlineacion - 1) / bytesAlineacion * bytesAlineacion);
+    if (!memoria) {
+        throw std::bad_alloc();
+    }
+    return memoria;
+}
+
+void* operator new(std::size_t tamano) { return asignarMemoria(tamano); }
+void* operator new[](std::size_t tamano) { return asignarMemoria(tamano); }
+void* operator new(std::size_t tamano, std::align_val_t alineacion) { return asignarMemoriaAlineada(tamano, alineacion); }
+void* operator new[](std::size_t tamano, std::align_val_t alineacion) { return asignarMemoriaAlineada(tamano, alineacion); }
+void operator delete(void* memoria) noexcept { std::free(memoria); }
+void operator delete[](void* memoria) noexcept { std::free(memoria); }
+void operator delete(void* memoria, std::size_t) noexcept { std::free(memoria); }
+void operator delete[](void* memoria, std::size_t) noexcept { std::free(memoria); }
+void operator delete(void* memoria, std::align_val_t) noexcept { std::free(memoria); }
+void operator delete[](void* memoria, std::align_val_t) noexcept { std::free(memoria); }
+void operator delete(void* memoria, std::size_t, std::align_val_t) noexcept { std::free(memoria); }
+void operator delete[](void* memoria, std::size_t, std::align_val_t) noexcept { std::free(memoria); }
+
+// Contador de producción sin contención
+
+thread_local size_t ranuraContadorHilo = 0;
+
+// Métricas de operaciones
+
+const char* nombreOperacionPlanta(OperacionPlanta operacion) {
+    switch (operacion) {
+        case OperacionPlanta::AgregarMotor:              return "agregar_motor";
+        case OperacionPlanta::EnsamblarCarro:            return "ensamblar_carro";
+        case OperacionPlanta::DarDeBajaCarro:            return "dar_de_baja_carro";
+        case OperacionPlanta::Importar:                  return "importar";
+        case OperacionPlanta::MotoresDisponibles:        return "motores_disponibles";
+        case OperacionPlanta::CarrosAltaVelocidad:       return "carros_alta_velocidad";
+        case OperacionPlanta::OmnibusMayorCapacidad:     return "omnibus_mayor_capacidad";
+        case OperacionPlanta::CarrosReensamblados:       return "carros_reensamblados";
+        case OperacionPlanta::CumplimientoPlan:          return "cumplimiento_plan";
+        case OperacionPlanta::ProduccionEntre:           return "produccion_entre";
+        case OperacionPlanta::CumplimientoMensual:       return "cumplimiento_mensual";
+        case OperacionPlanta::ProyeccionPlan:            return "proyeccion_plan";
+        case OperacionPlanta::Ganancias:                 return "ganancias";
+        case OperacionPlanta::Tablero:                   return "tablero";
+        case OperacionPlanta::CompararAgregados:         return "comparar_agregados";
+        case OperacionPlanta::EstadisticasMemoria:       return "estadisticas_memoria";
+        case OperacionPlanta::EstadisticasEspecialistas: return "estadisticas_especialistas";
+        case OperacionPlanta::FichasCarros:              return "fichas_carros";
+        case OperacionPlanta::EnsamblarLote:             return "ensamblar_lote";
+        case OperacionPlanta::Clasificacion:             return "clasificacion";
+        case OperacionPlanta::ArchivarCarros:            return "archivar_carros";
+        default:                                         return "consultar_historico";
+    }
+}
+
+std::atomic<bool> metricasActivas{false};
+HistogramaLatencia latenciaOperaciones[CANTIDAD_OPERACIONES_PLANTA];
+
+// Grabación de la carga de trabajo (--grabar)
+
+std::atomic<bool> grabandoTraza{false};
+thread_local int profundidadOperacion = 0;
+std::string archivoTraza;    // Destino de la grabación (--grabar)
+
+// Almacén columnar (opcional) de los carros ensamblados
+
+void AlmacenColumnarCarros::reservar(size_t cantidad) {
+    tipo.reserve(cantidad);
+    velocidad.reserve(cantidad);
+    cantidadPlazas.reserve(cantidad);
+    costoMotor.reserve(cantidad);
+    pesoCarroceria.reserve(cantidad);
+    cantidadPuertas.reserve(cantidad);
+    cantidadVelocidades.reserve(cantidad);
+    cambioUniversal.reserve(cantidad);
+    costoTapiceria.reserve(cantidad);
+}
+
+void AlmacenColumnarCarros::agregar(const Carro* carro) {
+    tipo.push_back(carro->getTipo());
+    velocidad.push_back(carro->getVelocidad());
+    cantidadPlazas.push_back(carro->getCantidadPlazas());
+    pesoCarroceria.push_back(0);
+    cantidadPuertas.push_back(0);
+    cantidadVelocidades.push_back(0);
+    cambioUniversal.push_back(0);
+    costoTapiceria.push_back(0);
+
+    double costo = visitarCarro(*carro, Sobrecarga{
+        [this](const Formula1& formula1) {
+            pesoCarroceria.back() = formula1.getPesoCarroceria();
+            return formula1.getMotorConcreto()->calcularCosto();
+        },
+        [this](const Omnibus& omnibus) {
+            cantidadPuertas.back() = omnibus.getCantidadPuertas();
+            return omnibus.getMotorConcreto()->calcularCosto();
+        },
+        [this](const Sport& sport) {
+            cantidadVelocidades.back() = sport.getCantidadVelocidades();
+            cambioUniversal.back() = sport.esCambioUniversal();
+            return sport.getMotorConcreto()->calcularCosto();
+        },
+        [this](const DeLujo& deLujo) {
+            costoTapiceria.back() = deLujo.getCostoTapiceria();
+            return deLujo.getMotorConcreto()->calcularCosto();
+        }
+    });
+    costoMotor.push_back(costo);
+}
+
+template <typename T>
+void quitarFila(std::vector<T>& columna, size_t posicion) {
+    columna[posicion] = columna.back();
+    columna.pop_back();
+}
+
+void AlmacenColumnarCarros::quitar(size_t posicion) {
+    quitarFila(tipo, posicion);
+    quitarFila(velocidad, posicion);
+    quitarFila(cantidadPlazas, posicion);
+    quitarFila(costoMotor, posicion);
+    quitarFila(pesoCarroceria, posicion);
+    quitarFila(cantidadPuertas, posicion);
+    quitarFila(cantidadVelocidades, posicion);
+    quitarFila(cambioUniversal, posicion);
+    quitarFila(costoTapiceria, posicion);
+}
+
+void AlmacenColumnarCarros::limpiar() {
+    *this = AlmacenColumnarCarros();
+}
+
+// Ejecución de los reportes por bloques
+
+int hilosReportes = 1;
+
+size_t contarBloques(size_t cantidad, size_t tamanoBloque) {
+    return (cantidad + tamanoBloque - 1) / tamanoBloque;
+}
+
+// Clasificaciones de los K mejores
+// MejoresK conserva los K elementos de mayor clave vistos en un montículo de mínimo de K elementos: cada
+// elemento cuesta O(log K) y el inventario nunca se ordena completo. Los elementos son posiciones en el
+// contenedor recorrido; a igual clave gana la posición menor, así que el resultado no depende de la
+// cantidad de hilos ni del orden en que se combinan los bloques.
+
+struct ElementoClasificado {
+    double clave;
+    size_t posicion;
+};
+
+class MejoresK {
+private:
+    size_t k;
+    std::vector<ElementoClasificado> monticulo;    // El peor de los K en el frente
+
+    // Orden del montículo: a va después de b en la clasificación
+    static bool peor(const ElementoClasificado& a, const ElementoClasificado& b) {
+        return a.clave != b.clave ? a.clave < b.clave : a.posicion > b.posicion;
+    }
+    static bool mejor(const ElementoClasificado& a, const ElementoClasificado& b) { return peor(b, a); }
+
+public:
+    explicit MejoresK(size_t k) : k(k) {}
+
+    void considerar(double clave, size_t posicion) {
+        ElementoClasificado elemento{clave, posicion};
+        if (monticulo.size() < k) {
+            monticulo.push_back(elemento);
+            std::push_heap(monticulo.begin(), monticulo.end(), mejor);
+        } else if (k > 0 && peor(monticulo.front(), elemento)) {
+            std::pop_heap(monticulo.begin(), monticulo.end(), mejor);
+            monticulo.back() = elemento;
+            std::push_heap(monticulo.begin(), monticulo.end(), mejor);
+        }
+    }
+
+    void combinar(const MejoresK& otro) {
+        for (const ElementoClasificado& elemento : otro.monticulo) {
+            considerar(elemento.clave, elemento.posicion);
+        }
+    }
+
+    // Los K mejores, del primero al último
+    std::vector<ElementoClasificado> ordenados() const {
+        std::vector<ElementoClasificado> resultado = monticulo;
+        std::sort(resultado.begin(), resultado.end(), mejor);
+        return resultado;
+    }
+};
+
+// Los k carros de mayor valor(carro) entre los que cumplen incluir(carro), recorriendo carrosEnsamblados
+// por bloques
+template <typename Incluir, typename Valor>
+std::vector<ElementoClasificado> InventarioPlanta::mejoresCarros(size_t k, Incluir incluir, Valor valor) const {
+    size_t cantidad = carrosEnsamblados.size();
+    size_t bloques = contarBloques(cantidad);
+    std::vector<MejoresK> parciales(bloques, MejoresK(k));
+    ejecutarPorBloques(bloques, [&](size_t bloque) {
+        size_t inicio = bloque * BLOQUE_REPORTE;
+        size_t fin = std::min(inicio + BLOQUE_REPORTE, cantidad);
+        for (size_t i = inicio; i < fin; ++i) {
+            const Carro& carro = *carrosEnsamblados[i];
+            if (incluir(carro)) {
+                parciales[bloque].considerar(valor(carro), i);
+            }
+        }
+    });
+
+    MejoresK mejores(k);
+    for (const MejoresK& parcial : parciales) {
+        mejores.combinar(parcial);
+    }
+    return mejores.ordenados();
+}
+
+// Cálculos de los reportes agregados, sobre los punteros o sobre el almacén columnar
+
+void calcularGananciasPorTipo(const std::vector<Carro*>& carros, double ganancias[CANTIDAD_TIPOS_CARRO]) {
+    sumarPorTipoEnBloques(carros.size(), ganancias, [&carros](size_t inicio, size_t fin, double* parcial) {
+        for (size_t i = inicio; i < fin; ++i) {
+            parcial[static_cast<int>(carros[i]->getTipo())] += visitarCarro(*carros[i], [](const auto& concreto) {
+                double precioVenta = concreto.calcularPrecioVenta();
+                double costoMotor = concreto.getMotorConcreto()->calcularCosto();
+                return precioVenta - costoMotor;
+            });
+        }
+    });
+}
+
+void calcularGananciasPorTipo(const AlmacenColumnarCarros& almacen, double ganancias[CANTIDAD_TIPOS_CARRO]) {
+    const TipoCarro* tipo = almacen.tipo.data();
+    const double* velocidad = almacen.velocidad.data();
+    const double* costoMotor = almacen.costoMotor.data();
+    const double* pesoCarroceria = almacen.pesoCarroceria.data();
+    const int* cantidadPuertas = almacen.cantidadPuertas.data();
+    const int* cantidadVelocidades = almacen.cantidadVelocidades.data();
+    const unsigned char* cambioUniversal = almacen.cambioUniversal.data();
+    const double* costoTapiceria = almacen.costoTapiceria.data();
+
+    // Se evalúan las cuatro fórmulas de precio en cada fila y se elige por tipo, sin saltos
+    sumarPorTipoEnBloques(almacen.size(), ganancias, [=](size_t inicio, size_t fin, double* parcial) {
+        double gananciaFormula1 = 0, gananciaOmnibus = 0, gananciaSport = 0, gananciaDeLujo = 0;
+        for (size_t i = inicio; i < fin; ++i) {
+            double costo = costoMotor[i];
+            double precioFormula1 = velocidad[i] * 5 + 1 / pesoCarroceria[i] + costo;
+            double precioOmnibus = (cantidadPuertas[i] * 1.5 + costo) * 3;
+            double precioSport = cantidadVelocidades[i] * 2 + costo + cambioUniversal[i] * 1000.0;
+            double precioDeLujo = (costoTapiceria[i] + costo) * 10;
+
+            gananciaFormula1 += tipo[i] == TipoCarro::Formula1 ? precioFormula1 - costo : 0.0;
+            gananciaOmnibus += tipo[i] == TipoCarro::Omnibus ? precioOmnibus - costo : 0.0;
+            gananciaSport += tipo[i] == TipoCarro::Sport ? precioSport - costo : 0.0;
+            gananciaDeLujo += tipo[i] == TipoCarro::DeLujo ? precioDeLujo - costo : 0.0;
+        }
+        parcial[static_cast<int>(TipoCarro::Formula1)] = gananciaFormula1;
+        parcial[static_cast<int>(TipoCarro::Omnibus)] = gananciaOmnibus;
+        parcial[static_cast<int>(TipoCarro::Sport)] = gananciaSport;
+        parcial[static_cast<int>(TipoCarro::DeLujo)] = gananciaDeLujo;
+    });
+}
+
+void filtrarAltaVelocidad(const std::vector<Carro*>& carros, std::vector<size_t>& posiciones) {
+    filtrarEnBloques(carros.size(), posiciones, [&carros](size_t inicio, size_t fin, std::vector<size_t>& parcial) {
+        for (size_t i = inicio; i < fin; ++i) {
+            if (carros[i]->getVelocidad() > VELOCIDAD_ALTA) {
+                parcial.push_back(i);
+            }
+        }
+    });
+}
+
+void filtrarAltaVelocidad(const AlmacenColumnarCarros& almacen, std::vector<size_t>& posiciones) {
+    const double* velocidad = almacen.velocidad.data();
+    filtrarEnBloques(almacen.size(), posiciones, [velocidad](size_t inicio, size_t fin, std::vector<size_t>& parcial) {
+        for (size_t i = inicio; i < fin; ++i) {
+            if (velocidad[i] > VELOCIDAD_ALTA) {
+                parcial.push_back(i);
+            }
+        }
+    });
+}
+
+// Devuelve la posición del ómnibus de mayor capacidad, o SIN_CARRO si no hay ómnibus
+size_t buscarOmnibusMayorCapacidad(const std::vector<Carro*>& carros) {
+    size_t posicionMayor = SIN_CARRO;
+    int mayorCapacidad = 0;
+    for (size_t i = 0; i < carros.size(); ++i) {
+        if (carros[i]->getTipo() == TipoCarro::Omnibus && carros[i]->getCantidadPlazas() > mayorCapacidad) {
+            mayorCapacidad = carros[i]->getCantidadPlazas();
+            posicionMayor = i;
+        }
+    }
+    return posicionMayor;
+}
+
+size_t buscarOmnibusMayorCapacidad(const AlmacenColumnarCarros& almacen) {
+    size_t posicionMayor = SIN_CARRO;
+    int mayorCapacidad = 0;
+    const TipoCarro* tipo = almacen.tipo.data();
+    const int* cantidadPlazas = almacen.cantidadPlazas.data();
+    size_t cantidad = almacen.size();
+    for (size_t i = 0; i < cantidad; ++i) {
+        if (tipo[i] == TipoCarro::Omnibus && cantidadPlazas[i] > mayorCapacidad) {
+            mayorCapacidad = cantidadPlazas[i];
+            posicionMayor = i;
+        }
+    }
+    return posicionMayor;
+}
+
+void filtrarAltaVelocidad(const VersionCarros& carros, std::vector<size_t>& posiciones) {
+    filtrarEnBloques(carros.size(), posiciones, [&carros](size_t inicio, size_t fin, std::vector<size_t>& parcial) {
+        for (size_t i = inicio; i < fin; ++i) {
+            if (carros[i].getVelocidad() > VELOCIDAD_ALTA) {
+                parcial.push_back(i);
+            }
+        }
+    });
+}
+
+double calcularGanancia(const Carro& carro) {
+    return visitarCarro(carro, [](const auto& concreto) {
+        return concreto.calcularPrecioVenta() - concreto.getMotorConcreto()->calcularCosto();
+    });
+}
+
+void AgregadosProduccion::agregar(const Carro* carro) {
+    int tipo = static_cast<int>(carro->getTipo());
+    ganancia[tipo] += calcularGanancia(*carro);
+    carrosPorTipo[tipo]++;
+    if (carro->getVelocidad() > VELOCIDAD_ALTA) {
+        carrosAltaVelocidad++;
+    }
+    if (carro->getTipo() == TipoCarro::Omnibus) {
+        ClaveOmnibus clave{carro->getCantidadPlazas(), siguienteLlegada++};
+        CapacidadesOmnibus::iterator entrada;
+        if (nodosLibres.empty()) {
+            entrada = capacidadesOmnibus.emplace(clave, carro).first;
+        } else {
+            CapacidadesOmnibus::node_type nodo = std::move(nodosLibres.back());
+            nodosLibres.pop_back();
+            nodo.key() = clave;
+            nodo.mapped() = carro;
+            entrada = capacidadesOmnibus.insert(std::move(nodo)).position;
+        }
+        if (nodosPosicionesLibres.empty()) {
+            posicionesOmnibus.emplace(carro, entrada);
+        } else {
+            PosicionesOmnibus::node_type nodo = std::move(nodosPosicionesLibres.back());
+            nodosPosicionesLibres.pop_back();
+            nodo.key() = carro;
+            nodo.mapped() = entrada;
+            posicionesOmnibus.insert(std::move(nodo));
+        }
+    }
+}
+
+void AgregadosProduccion::quitar(const Carro* carro) {
+    int tipo = static_cast<int>(carro->getTipo());
+    ganancia[tipo] -= calcularGanancia(*carro);
+    if (--carrosPorTipo[tipo] == 0) {
+        ganancia[tipo] = 0;    // Descarta el error de redondeo acumulado
+    }
+    if (carro->getVelocidad() > VELOCIDAD_ALTA) {
+        carrosAltaVelocidad--;
+    }
+    if (carro->getTipo() == TipoCarro::Omnibus) {
+        PosicionesOmnibus::node_type posicion = posicionesOmnibus.extract(carro);
+        nodosLibres.push_back(capacidadesOmnibus.extract(posicion.mapped()));
+        nodosPosicionesLibres.push_back(std::move(posicion));
+    }
+}
+
+const Carro* AgregadosProduccion::omnibusMayorCapacidad() const {
+    return capacidadesOmnibus.empty() ? nullptr : capacidadesOmnibus.rbegin()->second;
+}
+
+InventarioPlanta::~InventarioPlanta() {
+    diario.cerrar();
+    archivoHistorico.cerrar();
+}
+
+Resultado InventarioPlanta::agregarMotor(const DatosMotor& motor) {
+    MedicionLatencia medicion(OperacionPlanta::AgregarMotor);
+    OperacionTrazada traza(OperacionPlanta::AgregarMotor, motor);
+    switch (motor.tipo) {
+        case TipoMotor::Alta:
+            return altaMotorAlta(motor.codigo, motor.fechaSalida, motor.especialista, motor.vecesReensamblado,
+                                 motor.maxRPM, motor.consumo);
+        case TipoMotor::Fuerza:
+            return altaMotorFuerza(motor.codigo, motor.fechaSalida, motor.especialista, motor.vecesReensamblado,
+                                   motor.caballosFuerza);
+        default:
+            return altaMotorTrabajo(motor.codigo, motor.fechaSalida, motor.especialista, motor.vecesReensamblado,
+                                    motor.artesanal);
+    }
+}
+
+Resultado InventarioPlanta::ensamblarCarro(const PedidoCarro& pedido) {
+    MedicionLatencia medicion(OperacionPlanta::EnsamblarCarro);
+    OperacionTrazada traza(OperacionPlanta::EnsamblarCarro, pedido);
+    switch (pedido.tipo) {
+        case TipoCarro::Formula1:
+            return ensamblarFormula1(pedido.fechaSalida, pedido.velocidad, pedido.pesoCarroceria);
+        case TipoCarro::Omnibus:
+            return ensamblarOmnibus(pedido.fechaSalida, pedido.velocidad, pedido.cantidadPuertas);
+        case TipoCarro::Sport:
+            return ensamblarSport(pedido.fechaSalida, pedido.velocidad, pedido.cantidadPlazas,
+                                  pedido.cantidadVelocidades, pedido.cambioUniversal);
+        default:
+            return ensamblarDeLujo(pedido.fechaSalida, pedido.velocidad, pedido.cantidadPlazas, pedido.costoTapiceria);
+    }
+}
+
+CarrosArchivados InventarioPlanta::archivarCarros(Fecha corte) {
+    MedicionLatencia medicion(OperacionPlanta::ArchivarCarros);
+    OperacionTrazada traza(OperacionPlanta::ArchivarCarros, corte);
+    return archivarCarrosAnteriores(corte);
+}
+
+Resultado InventarioPlanta::darDeBajaCarro(std::string_view codigoMotor) {
+    MedicionLatencia medicion(OperacionPlanta::DarDeBajaCarro);
+    OperacionTrazada traza(OperacionPlanta::DarDeBajaCarro, codigoMotor);
+    return retirarCarro(codigoMotor);
+}
+
+// Sin OperacionTrazada: la traza guarda las altas y ensamblajes de la importación, no la ruta del archivo
+ResumenImportacion InventarioPlanta::importar(const std::string& ruta) {
+    MedicionLatencia medicion(OperacionPlanta::Importar);
+    return importarArchivo(ruta);
+}
+
+const char* InventarioPlanta::importarLinea(std::string_view linea) {
+    ResumenImportacion resumen;
+    return importarRegistro(linea, resumen);
+}
+
+bool InventarioPlanta::motorArchivado(const CodigoMotor& codigo) const {
+    return std::binary_search(codigosArchivados.begin(), codigosArchivados.end(), codigo);
+}
+
+bool InventarioPlanta::existeMotor(std::string_view texto) const {
+    CodigoMotor codigo;
+    return CodigoMotor::desdeTexto(texto, codigo) && (indiceMotores.count(codigo) > 0 || motorArchivado(codigo));
+}
+
+bool InventarioPlanta::hayMotorDisponible(TipoMotor tipo) const {
+    switch (tipo) {
+        case TipoMotor::Alta:   return !motoresAltaDisponibles.empty();
+        case TipoMotor::Fuerza: return !motoresFuerzaDisponibles.empty();
+        default:                return !motoresTrabajoDisponibles.empty();
+    }
+}
+
+bool InventarioPlanta::hayMotorArtesanalDisponible() const {
+    return motoresTrabajoDisponibles.hayArtesanal();
+}
+
+size_t InventarioPlanta::cantidadMotoresDisponibles(TipoMotor tipo) const {
+    switch (tipo) {
+        case TipoMotor::Alta:   return motoresAltaDisponibles.size();
+        case TipoMotor::Fuerza: return motoresFuerzaDisponibles.size();
+        default:                return motoresTrabajoDisponibles.size();
+    }
+}
+
+MotoresDisponibles InventarioPlanta::motoresDisponibles() const {
+    MedicionLatencia medicion(OperacionPlanta::MotoresDisponibles);
+    OperacionTrazada traza(OperacionPlanta::MotoresDisponibles);
+    MotoresDisponibles motores;
+    motores.alta.assign(motoresAltaDisponibles.begin(), motoresAltaDisponibles.end());
+    motores.fuerza.assign(motoresFuerzaDisponibles.begin(), motoresFuerzaDisponibles.end());
+    motores.trabajo.reserve(motoresTrabajoDisponibles.size());
+    motoresTrabajoDisponibles.recorrer([&motores](const MotorTrabajo* motor) { motores.trabajo.push_back(motor); });
+    return motores;
+}
+
+std::vector<const Carro*> InventarioPlanta::carrosAltaVelocidad() const {
+    MedicionLatencia medicion(OperacionPlanta::CarrosAltaVelocidad);
+    OperacionTrazada traza(OperacionPlanta::CarrosAltaVelocidad);
+    std::vector<size_t> posiciones;
+    if (usarAlmacenColumnar) {
+        filtrarAltaVelocidad(almacenColumnar, posiciones);
+    } else {
+        filtrarAltaVelocidad(carrosEnsamblados, posiciones);
+    }
+    std::vector<const Carro*> carros;
+    carros.reserve(posiciones.size());
+    for (size_t posicion : posiciones) {
+        carros.push_back(carrosEnsamblados[posicion]);
+    }
+    return carros;
+}
+
+const Carro* InventarioPlanta::omnibusMayorCapacidad() const {
+    MedicionLatencia medicion(OperacionPlanta::OmnibusMayorCapacidad);
+    OperacionTrazada traza(OperacionPlanta::OmnibusMayorCapacidad);
+    return agregados.omnibusMayorCapacidad();
+}
+
+const std::vector<Carro*>& InventarioPlanta::carros() const {
+    return carrosEnsamblados;
+}
+
+void InventarioPlanta::activarAlmacenColumnar() {
+    usarAlmacenColumnar = true;
+    almacenColumnar.limpiar();
+    for (const auto& carro : carrosEnsamblados) {
+        almacenColumnar.agregar(carro);
+    }
+}
+
+void InventarioPlanta::activarEspejoCarros() {
+    usarEspejoCarros = true;
+    espejoCarros.limpiar();
+    for (const auto& carro : carrosEnsamblados) {
+        espejoCarros.agregar(carro);
+    }
+}
+
+std::shared_ptr<const VersionCarros> InventarioPlanta::publicarEspejoCarros() {
+    return espejoCarros.publicar();
+}
+
+std::vector<CarroClasificado> InventarioPlanta::carrosClasificados(const std::vector<ElementoClasificado>& elementos) const {
+    std::vector<CarroClasificado> carros;
+    carros.reserve(elementos.size());
+    for (const ElementoClasificado& elemento : elementos) {
+        carros.push_back({carrosEnsamblados[elemento.posicion], elemento.clave});
+    }
+    return carros;
+}
+
+// Por ganancia (precio de venta menos costo del motor), de todos los carros o de un tipo
+std::vector<CarroClasificado> InventarioPlanta::carrosMasRentables(size_t k, std::optional<TipoCarro> tipo) const {
+    MedicionLatencia medicion(OperacionPlanta::Clasificacion);
+    OperacionTrazada traza(OperacionPlanta::Clasificacion, ClasificacionTrazada::Rentables, k, tipo);
+    return carrosClasificados(mejoresCarros(
+        k, [tipo](const Carro& carro) { return !tipo || carro.getTipo() == *tipo; },
+        [](const Carro& carro) { return calcularGanancia(carro); }));
+}
+
+std::vector<CarroClasificado> InventarioPlanta::carrosMasRapidos(size_t k) const {
+    MedicionLatencia medicion(OperacionPlanta::Clasificacion);
+    OperacionTrazada traza(OperacionPlanta::Clasificacion, ClasificacionTrazada::Rapidos, k);
+    return carrosClasificados(mejoresCarros(
+        k, [](const Carro&) { return true; }, [](const Carro& carro) { return carro.getVelocidad(); }));
+}
+
+// Recorre desde el final el conjunto ordenado que mantienen los agregados: O(k), sin recorrer los carros
+std::vector<CarroClasificado> InventarioPlanta::omnibusDeMayorCapacidad(size_t k) const {
+    MedicionLatencia medicion(OperacionPlanta::Clasificacion);
+    OperacionTrazada traza(OperacionPlanta::Clasificacion, ClasificacionTrazada::Omnibus, k);
+    std::vector<CarroClasificado> omnibus;
+    for (auto entrada = agregados.capacidadesOmnibus.rbegin();
+         entrada != agregados.capacidadesOmnibus.rend() && omnibus.size() < k; ++entrada) {
+        omnibus.push_back({entrada->second, static_cast<double>(entrada->first.plazas)});
+    }
+    return omnibus;
+}
+
+// Por calcularCosto, entre los motores disponibles del tipo
+std::vector<MotorClasificado> InventarioPlanta::motoresMasBaratos(TipoMotor tipo, size_t k) const {
+    MedicionLatencia medicion(OperacionPlanta::Clasificacion);
+    OperacionTrazada traza(OperacionPlanta::Clasificacion, ClasificacionTrazada::MotoresBaratos, k, tipo);
+    std::vector<const Motor*> motores;
+    if (tipo == TipoMotor::Alta) {
+        motores.assign(motoresAltaDisponibles.begin(), motoresAltaDisponibles.end());
+    } else if (tipo == TipoMotor::Fuerza) {
+        motores.assign(motoresFuerzaDisponibles.begin(), motoresFuerzaDisponibles.end());
+    } else {
+        motores.reserve(motoresTrabajoDisponibles.size());
+        motoresTrabajoDisponibles.recorrer([&motores](const MotorTrabajo* motor) { motores.push_back(motor); });
+    }
+
+    MejoresK mejores(k);
+    for (size_t i = 0; i < motores.size(); ++i) {
+        mejores.considerar(-motores[i]->calcularCosto(), i);
+    }
+    std::vector<MotorClasificado> clasificados;
+    for (const ElementoClasificado& elemento : mejores.ordenados()) {
+        clasificados.push_back({motores[elemento.posicion], -elemento.clave});
+    }
+    return clasificados;
+}
+
+std::vector<CarroReensamblado> InventarioPlanta::carrosConMotoresReensamblados() const {
+    MedicionLatencia medicion(OperacionPlanta::CarrosReensamblados);
+    OperacionTrazada traza(OperacionPlanta::CarrosReensamblados);
+    return buscarCarrosReensamblados(carrosEnsamblados.size(), [this](size_t i) -> const Carro& {
+        return *carrosEnsamblados[i];
+    });
+}
+
+CumplimientoPlan InventarioPlanta::cumplimientoPlan() const {
+    MedicionLatencia medicion(OperacionPlanta::CumplimientoPlan);
+    OperacionTrazada traza(OperacionPlanta::CumplimientoPlan);
+    CumplimientoPlan cumplimiento;
+    cumplimiento.motoresProducidos = motoresProducidos;
+    cumplimiento.planMotores = planMotoresAnual;
+    cumplimiento.porcentajeMotores = (static_cast<double>(cumplimiento.motoresProducidos) / planMotoresAnual) * 100;
+    cumplimiento.carrosProducidos = carrosProducidos;
+    cumplimiento.planCarros = planCarrosAnual;
+    cumplimiento.porcentajeCarros = (static_cast<double>(cumplimiento.carrosProducidos) / planCarrosAnual) * 100;
+    return cumplimiento;
+}
+
+ProduccionPeriodo InventarioPlanta::produccionEntre(Fecha desde, Fecha hasta) const {
+    MedicionLatencia medicion(OperacionPlanta::ProduccionEntre);
+    OperacionTrazada traza(OperacionPlanta::ProduccionEntre, desde, hasta);
+    return {desde, hasta, produccionMotores.entre(desde, hasta), produccionCarros.entre(desde, hasta)};
+}
+
+std::vector<CumplimientoMensual> InventarioPlanta::cumplimientoMensual(int anio, int hastaMes) const {
+    MedicionLatencia medicion(OperacionPlanta::CumplimientoMensual);
+    OperacionTrazada traza(OperacionPlanta::CumplimientoMensual, anio, hastaMes);
+    double planMotoresMes = planMotoresAnual / 12.0;
+    double planCarrosMes = planCarrosAnual / 12.0;
+    std::vector<CumplimientoMensual> meses;
+    for (int mes = 1; mes <= hastaMes; ++mes) {
+        Fecha primerDia = Fecha::desdeCivil(1, mes, anio);
+        Fecha ultimoDia = Fecha::desdeDia((mes == 12 ? Fecha::desdeCivil(1, 1, anio + 1)
+                                                     : Fecha::desdeCivil(1, mes + 1, anio)).getDia() - 1);
+        CumplimientoMensual cumplimiento;
+        cumplimiento.mes = mes;
+        cumplimiento.motores = produccionMotores.entre(primerDia, ultimoDia);
+        cumplimiento.carros = produccionCarros.entre(primerDia, ultimoDia);
+        cumplimiento.porcentajeMotores = cumplimiento.motores / planMotoresMes * 100;
+        cumplimiento.porcentajeCarros = cumplimiento.carros / planCarrosMes * 100;
+        meses.push_back(cumplimiento);
+    }
+    return meses;
+}
+
+ProyeccionPlan InventarioPlanta::proyeccionPlan(Fecha corte) const {
+    MedicionLatencia medicion(OperacionPlanta::ProyeccionPlan);
+    OperacionTrazada traza(OperacionPlanta::ProyeccionPlan, corte);
+    int dia, mes, anio;
+    corte.aCivil(dia, mes, anio);
+    Fecha inicioAnio = Fecha::desdeCivil(1, 1, anio);
+
+    ProyeccionPlan proyeccion;
+    proyeccion.corte = corte;
+    proyeccion.diasTranscurridos = corte.getDia() - inicioAnio.getDia() + 1;
+    proyeccion.diasAnio = Fecha::desdeCivil(1, 1, anio + 1).getDia() - inicioAnio.getDia();
+    proyeccion.motoresAcumulados = produccionMotores.entre(inicioAnio, corte);
+    proyeccion.carrosAcumulados = produccionCarros.entre(inicioAnio, corte);
+    double escala = static_cast<double>(proyeccion.diasAnio) / proyeccion.diasTranscurridos;
+    proyeccion.motoresProyectados = proyeccion.motoresAcumulados * escala;
+    proyeccion.carrosProyectados = proyeccion.carrosAcumulados * escala;
+    proyeccion.porcentajeMotores = proyeccion.motoresProyectados / planMotoresAnual * 100;
+    proyeccion.porcentajeCarros = proyeccion.carrosProyectados / planCarrosAnual * 100;
+    return proyeccion;
+}
+
+GananciasPorTipo InventarioPlanta::ganancias() const {
+    MedicionLatencia medicion(OperacionPlanta::Ganancias);
+    OperacionTrazada traza(OperacionPlanta::Ganancias);
+    GananciasPorTipo ganancias;
+    ganancias.total = 0;
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        ganancias.porTipo[i] = agregados.ganancia[i];
+        ganancias.total += agregados.ganancia[i];
+    }
+    return ganancias;
+}
+
+TableroProduccion InventarioPlanta::tablero() const {
+    MedicionLatencia medicion(OperacionPlanta::Tablero);
+    OperacionTrazada traza(OperacionPlanta::Tablero);
+    TableroProduccion tablero;
+    tablero.motoresAlta = motoresAltaDisponibles.size();
+    tablero.motoresFuerza = motoresFuerzaDisponibles.size();
+    tablero.motoresTrabajo = motoresTrabajoDisponibles.size();
+    tablero.motoresArtesanales = motoresTrabajoDisponibles.cantidadArtesanales();
+    tablero.carrosEnsamblados = carrosEnsamblados.size();
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        tablero.carrosPorTipo[i] = agregados.carrosPorTipo[i];
+    }
+    tablero.ganancias = ganancias();
+    tablero.carrosAltaVelocidad = agregados.carrosAltaVelocidad;
+    const Carro* omnibusMayor = agregados.omnibusMayorCapacidad();
+    tablero.mayorCapacidadOmnibus = omnibusMayor ? omnibusMayor->getCantidadPlazas() : 0;
+    tablero.cumplimiento = cumplimientoPlan();
+    tablero.historico = resumenHistorico();
+    return tablero;
+}
+
+bool gananciasCoinciden(double incremental, double recalculada) {
+    return std::fabs(incremental - recalculada) <= 1e-9 * std::max(1.0, std::fabs(recalculada));
+}
+
+ComparacionAgregados InventarioPlanta::compararAgregados() const {
+    MedicionLatencia medicion(OperacionPlanta::CompararAgregados);
+    OperacionTrazada traza(OperacionPlanta::CompararAgregados);
+    ComparacionAgregados comparacion;
+    std::vector<size_t> rapidos;
+    size_t posicionOmnibus;
+    if (usarAlmacenColumnar) {
+        calcularGananciasPorTipo(almacenColumnar, comparacion.gananciaRecalculada);
+        filtrarAltaVelocidad(almacenColumnar, rapidos);
+        posicionOmnibus = buscarOmnibusMayorCapacidad(almacenColumnar);
+    } else {
+        calcularGananciasPorTipo(carrosEnsamblados, comparacion.gananciaRecalculada);
+        filtrarAltaVelocidad(carrosEnsamblados, rapidos);
+        posicionOmnibus = buscarOmnibusMayorCapacidad(carrosEnsamblados);
+    }
+
+    comparacion.coinciden = true;
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        comparacion.gananciaIncremental[i] = agregados.ganancia[i];
+        comparacion.coinciden = comparacion.coinciden &&
+                                gananciasCoinciden(agregados.ganancia[i], comparacion.gananciaRecalculada[i]);
+    }
+    comparacion.altaVelocidadIncremental = agregados.carrosAltaVelocidad;
+    comparacion.altaVelocidadRecalculada = static_cast<long>(rapidos.size());
+    const Carro* omnibusMayor = agregados.omnibusMayorCapacidad();
+    comparacion.capacidadIncremental = omnibusMayor ? omnibusMayor->getCantidadPlazas() : 0;
+    comparacion.capacidadRecalculada =
+        posicionOmnibus != SIN_CARRO ? carrosEnsamblados[posicionOmnibus]->getCantidadPlazas() : 0;
+    comparacion.coinciden = comparacion.coinciden &&
+                            comparacion.altaVelocidadIncremental == comparacion.altaVelocidadRecalculada &&
+                            comparacion.capacidadIncremental == comparacion.capacidadRecalculada;
+    return comparacion;
+}
+
+template <typename T>
+EstadisticasPool estadisticasPool(const char* nombre, const PoolObjetos<T>& pool) {
+    return {nombre, pool.getVivos(), pool.getCapacidad(), pool.getBloques(), pool.getAsignaciones(),
+            pool.getReutilizaciones()};
+}
+
+std::vector<EstadisticasPool> InventarioPlanta::estadisticasMemoria() const {
+    MedicionLatencia medicion(OperacionPlanta::EstadisticasMemoria);
+    OperacionTrazada traza(OperacionPlanta::EstadisticasMemoria);
+    return {
+        estadisticasPool("Motor de Alta", poolMotoresAlta),
+        estadisticasPool("Motor de Fuerza", poolMotoresFuerza),
+        estadisticasPool("Motor Trabajo", poolMotoresTrabajo),
+        estadisticasPool("Formula1", poolFormula1),
+        estadisticasPool("Omnibus", poolOmnibus),
+        estadisticasPool("Sport", poolSport),
+        estadisticasPool("De Lujo", poolDeLujo),
+    };
+}
+
+// Especialistas con motores en el inventario o con carros retirados, de más a menos reensamblajes
+std::vector<EstadisticasEspecialista> InventarioPlanta::estadisticasEspecialistas() const {
+    MedicionLatencia medicion(OperacionPlanta::EstadisticasEspecialistas);
+    OperacionTrazada traza(OperacionPlanta::EstadisticasEspecialistas);
+    std::vector<EstadisticasEspecialista> resultado;
+    for (uint32_t numero = 0; numero < especialistas.size(); ++numero) {
+        const CalidadEspecialista& calidad = especialistas.calidad(numero);
+        if (calidad.motores > 0 || calidad.carrosRetirados > 0) {
+            resultado.push_back({&especialistas.nombre(numero), calidad});
+        }
+    }
+    std::sort(resultado.begin(), resultado.end(),
+              [](const EstadisticasEspecialista& a, const EstadisticasEspecialista& b) {
+                  if (a.calidad.reensamblados != b.calidad.reensamblados) {
+                      return a.calidad.reensamblados > b.calidad.reensamblados;
+                  }
+                  return *a.nombre < *b.nombre;
+              });
+    return resultado;
+}
+
+// Ensamblaje de un lote de pedidos con la mayor ganancia
+// ensamblarCarro toma para cada pedido el último motor disponible del tipo que corresponde, sin mirar su
+// costo. ensamblarLote planifica el lote completo: atiende la mayor cantidad posible de pedidos (nunca
+// menos que uno por uno) y, entre las asignaciones que lo logran, elige la de mayor ganancia total. La
+// ganancia de un carro se separa en una parte que depende solo del pedido y otra que depende solo del
+// motor, así que no hace falta un algoritmo de emparejamiento general: en cada clase basta elegir por
+// separado los mejores pedidos (cuando faltan motores) y los mejores motores, con nth_element, en
+// O(n + k log k).
+//   Formula1 y Sport: la ganancia no depende del motor. Los Formula1 toman los motores de alta como
+//     ensamblarCarro (el último primero); los Sport, primero los motores de trabajo estándar y después
+//     los artesanales que no usan los carros de lujo, de menor a mayor costo.
+//   Ómnibus: la parte del motor es 2 × su costo; toman los motores de fuerza de mayor costo.
+//   De Lujo: la parte del motor es 9 × su costo, que puede ser negativa; toman los artesanales de mayor
+//     costo. Compiten con los Sport por los artesanales: se prueba cada cantidad de carros de lujo que
+//     atiende la mayor cantidad de pedidos y se elige la de mayor ganancia, con sumas acumuladas de los
+//     mejores pedidos y motores de cada clase.
+// Los carros se arman en el orden del lote.
+
+double gananciaPorPedido(const PedidoCarro& pedido) {
+    switch (pedido.tipo) {
+        case TipoCarro::Formula1: return pedido.velocidad * 5 + 1 / pedido.pesoCarroceria;
+        case TipoCarro::Omnibus:  return pedido.cantidadPuertas * 1.5 * 3;
+        case TipoCarro::Sport:    return pedido.cantidadVelocidades * 2 + (pedido.cambioUniversal ? 1000 : 0);
+        default:                  return pedido.costoTapiceria * 10;
+    }
+}
+
+double gananciaPorMotor(TipoCarro tipo, const Motor& motor) {
+    switch (tipo) {
+        case TipoCarro::Omnibus: return 2 * motor.calcularCosto();
+        case TipoCarro::DeLujo:  return 9 * motor.calcularCosto();
+        default:                 return 0;
+    }
+}
+
+// Devuelve los cantidad candidatos de mayor valor[candidato], de mayor a menor (a igual valor, el menor
+// candidato primero)
+std::vector<size_t> elegirMayores(std::vector<size_t> candidatos, size_t cantidad, const std::vector<double>& valor) {
+    auto mayor = [&valor](size_t a, size_t b) {
+        return valor[a] != valor[b] ? valor[a] > valor[b] : a < b;
+    };
+    if (cantidad < candidatos.size()) {
+        std::nth_element(candidatos.begin(), candidatos.begin() + cantidad, candidatos.end(), mayor);
+        candidatos.resize(cantidad);
+    }
+    std::sort(candidatos.begin(), candidatos.end(), mayor);
+    return candidatos;
+}
+
+// Convierte la fecha del pedido y comprueba las plazas de los Sport y De Lujo
+Resultado validarPedido(const PedidoCarro& pedido, Fecha& fechaSalida) {
+    if (!Fecha::desdeTexto(pedido.fechaSalida, fechaSalida)) {
+        return Resultado::FechaInvalida;
+    }
+    if ((pedido.tipo == TipoCarro::Sport || pedido.tipo == TipoCarro::DeLujo) &&
+        (pedido.cantidadPlazas < 2 || pedido.cantidadPlazas > 4)) {
+        return Resultado::PlazasInvalidas;
+    }
+    return Resultado::Exito;
+}
+
+// Ganancia que darían los pedidos válidos ensamblados uno por uno con las reglas de ensamblarCarro;
+// trabajo son los motores de trabajo disponibles en orden de llegada
+double InventarioPlanta::gananciaAsignacionHabitual(const std::vector<PedidoCarro>& pedidos,
+                                                    const std::vector<Resultado>& resultados,
+                                                    const std::vector<MotorTrabajo*>& trabajo) const {
+    size_t alta = motoresAltaDisponibles.size();
+    size_t fuerza = motoresFuerzaDisponibles.size();
+    std::vector<bool> usado(trabajo.size(), false);
+    size_t ultimo = trabajo.size();
+    size_t primerArtesanal = 0;
+    double ganancia = 0;
+    for (size_t i = 0; i < pedidos.size(); ++i) {
+        if (resultados[i] != Resultado::Exito) {
+            continue;
+        }
+        const PedidoCarro& pedido = pedidos[i];
+        const Motor* motor = nullptr;
+        switch (pedido.tipo) {
+            case TipoCarro::Formula1:
+                if (alta > 0) {
+                    motor = motoresAltaDisponibles[--alta];
+                }
+                break;
+            case TipoCarro::Omnibus:
+                if (fuerza > 0) {
+                    motor = motoresFuerzaDisponibles[--fuerza];
+                }
+                break;
+            case TipoCarro::Sport:
+                while (ultimo > 0 && usado[ultimo - 1]) {
+                    ultimo--;
+                }
+                if (ultimo > 0) {
+                    motor = trabajo[--ultimo];
+                    usado[ultimo] = true;
+                }
+                break;
+            default:
+                while (primerArtesanal < trabajo.size() &&
+                       (usado[primerArtesanal] || !trabajo[primerArtesanal]->esArtesanal())) {
+                    primerArtesanal++;
+                }
+                if (primerArtesanal < trabajo.size()) {
+                    motor = trabajo[primerArtesanal];
+                    usado[primerArtesanal] = true;
+                }
+                break;
+        }
+        if (motor) {
+            ganancia += gananciaPorPedido(pedido) + gananciaPorMotor(pedido.tipo, *motor);
+        }
+    }
+    return ganancia;
+}
+
+AsignacionLote InventarioPlanta::ensamblarLote(const std::vector<PedidoCarro>& pedidos) {
+    MedicionLatencia medicion(OperacionPlanta::EnsamblarLote);
+    OperacionTrazada traza(OperacionPlanta::EnsamblarLote, pedidos);
+    auto inicio = std::chrono::steady_clock::now();
+    AsignacionLote lote;
+    lote.resultados.assign(pedidos.size(), Resultado::Exito);
+    std::vector<Fecha> fechas(pedidos.size());
+    std::vector<double> gananciaPedido(pedidos.size());
+    std::vector<size_t> porTipo[CANTIDAD_TIPOS_CARRO];
+    for (size_t i = 0; i < pedidos.size(); ++i) {
+        lote.resultados[i] = validarPedido(pedidos[i], fechas[i]);
+        if (lote.resultados[i] == Resultado::Exito) {
+            gananciaPedido[i] = gananciaPorPedido(pedidos[i]);
+            porTipo[static_cast<int>(pedidos[i].tipo)].push_back(i);
+        }
+    }
+
+    std::vector<MotorTrabajo*> trabajo;
+    trabajo.reserve(motoresTrabajoDisponibles.size());
+    motoresTrabajoDisponibles.recorrer([&trabajo](MotorTrabajo* motor) { trabajo.push_back(motor); });
+    lote.gananciaHabitual = gananciaAsignacionHabitual(pedidos, lote.resultados, trabajo);
+
+    // Los pedidos elegidos reciben motores[j] en el orden del lote; el resto queda sin motor
+    std::vector<Motor*> asignados(pedidos.size(), nullptr);
+    auto asignar = [&](const std::vector<size_t>& candidatos, const std::vector<Motor*>& motores, Resultado sinMotor) {
+        std::vector<size_t> elegidos = elegirMayores(candidatos, motores.size(), gananciaPedido);
+        std::sort(elegidos.begin(), elegidos.end());
+        for (size_t j = 0; j < elegidos.size(); ++j) {
+            asignados[elegidos[j]] = motores[j];
+        }
+        for (size_t i : candidatos) {
+            if (!asignados[i]) {
+                lote.resultados[i] = sinMotor;
+            }
+        }
+    };
+
+    // Formula1: los últimos motores de alta
+    const std::vector<size_t>& formula1 = porTipo[static_cast<int>(TipoCarro::Formula1)];
+    std::vector<Motor*> motores;
+    size_t cantidadAlta = std::min(formula1.size(), motoresAltaDisponibles.size());
+    for (size_t j = 0; j < cantidadAlta; ++j) {
+        motores.push_back(motoresAltaDisponibles[motoresAltaDisponibles.size() - 1 - j]);
+    }
+    asignar(formula1, motores, Resultado::SinMotoresDisponibles);
+
+    // Ómnibus: los motores de fuerza de mayor costo
+    const std::vector<size_t>& omnibus = porTipo[static_cast<int>(TipoCarro::Omnibus)];
+    std::vector<double> costo(motoresFuerzaDisponibles.size());
+    std::vector<size_t> candidatos(motoresFuerzaDisponibles.size());
+    for (size_t j = 0; j < candidatos.size(); ++j) {
+        costo[j] = motoresFuerzaDisponibles[j]->calcularCosto();
+        candidatos[j] = j;
+    }
+    std::vector<size_t> fuerzaElegidos = elegirMayores(candidatos, std::min(omnibus.size(), candidatos.size()), costo);
+    motores.clear();
+    for (size_t j : fuerzaElegidos) {
+        motores.push_back(motoresFuerzaDisponibles[j]);
+    }
+    asignar(omnibus, motores, Resultado::SinMotoresDisponibles);
+
+    // De Lujo: los d artesanales de mayor costo. Los Sport pueden usar los motores de trabajo restantes, así
+    // que se prueba cada d que no atiende menos pedidos en total
+    const std::vector<size_t>& deLujo = porTipo[static_cast<int>(TipoCarro::DeLujo)];
+    const std::vector<size_t>& sport = porTipo[static_cast<int>(TipoCarro::Sport)];
+    costo.assign(trabajo.size(), 0);
+    candidatos.clear();
+    for (size_t j = 0; j < trabajo.size(); ++j) {
+        if (trabajo[j]->esArtesanal()) {
+            costo[j] = trabajo[j]->calcularCosto();
+            candidatos.push_back(j);
+        }
+    }
+    size_t maximoDeLujo = std::min(deLujo.size(), candidatos.size());
+    size_t minimoDeLujo = std::min(maximoDeLujo, trabajo.size() - std::min(trabajo.size(), sport.size()));
+    std::vector<size_t> artesanalesElegidos = elegirMayores(candidatos, maximoDeLujo, costo);
+    std::vector<size_t> deLujoMejores = elegirMayores(deLujo, maximoDeLujo, gananciaPedido);
+    std::vector<size_t> sportMejores =
+        elegirMayores(sport, std::min(sport.size(), trabajo.size() - minimoDeLujo), gananciaPedido);
+    std::vector<double> gananciaSport(sportMejores.size() + 1, 0);    // gananciaSport[k]: la de los k mejores
+    for (size_t k = 0; k < sportMejores.size(); ++k) {
+        gananciaSport[k + 1] = gananciaSport[k] + gananciaPedido[sportMejores[k]];
+    }
+    size_t cantidadDeLujo = minimoDeLujo;
+    double gananciaDeLujo = 0;
+    double mejorGanancia = 0;
+    for (size_t d = 0; d <= maximoDeLujo; ++d) {
+        if (d > 0) {
+            gananciaDeLujo += gananciaPedido[deLujoMejores[d - 1]] +
+                              gananciaPorMotor(TipoCarro::DeLujo, *trabajo[artesanalesElegidos[d - 1]]);
+        }
+        double ganancia = gananciaDeLujo + gananciaSport[std::min(sport.size(), trabajo.size() - d)];
+        if (d >= minimoDeLujo && (d == minimoDeLujo || ganancia >= mejorGanancia)) {
+            cantidadDeLujo = d;
+            mejorGanancia = ganancia;
+        }
+    }
+    artesanalesElegidos.resize(cantidadDeLujo);
+    std::vector<bool> trabajoUsado(trabajo.size(), false);
+    motores.clear();
+    for (size_t j : artesanalesElegidos) {
+        motores.push_back(trabajo[j]);
+        trabajoUsado[j] = true;
+    }
+    asignar(deLujo, motores,
+            trabajo.empty() ? Resultado::SinMotoresDisponibles : Resultado::SinMotoresArtesanales);
+
+    // Sport: los estándar, del último al primero, y después los artesanales restantes de menor costo
+    motores.clear();
+    for (size_t j = trabajo.size(); j > 0 && motores.size() < sport.size(); --j) {
+        if (!trabajo[j - 1]->esArtesanal()) {
+            motores.push_back(trabajo[j - 1]);
+            trabajoUsado[j - 1] = true;
+        }
+    }
+    if (motores.size() < sport.size()) {
+        candidatos.clear();
+        for (size_t j = 0; j < trabajo.size(); ++j) {
+            if (trabajo[j]->esArtesanal() && !trabajoUsado[j]) {
+                costo[j] = -costo[j];
+                candidatos.push_back(j);
+            }
+        }
+        for (size_t j : elegirMayores(candidatos, std::min(sport.size() - motores.size(), candidatos.size()), costo)) {
+            motores.push_back(trabajo[j]);
+            trabajoUsado[j] = true;
+        }
+    }
+    asignar(sport, motores, Resultado::SinMotoresDisponibles);
+
+    // Quitar de una vez los motores asignados de los inventarios de disponibles
+    motoresAltaDisponibles.resize(motoresAltaDisponibles.size() - cantidadAlta);
+    std::vector<bool> fuerzaUsado(motoresFuerzaDisponibles.size(), false);
+    for (size_t j : fuerzaElegidos) {
+        fuerzaUsado[j] = true;
+    }
+    size_t conservados = 0;
+    for (size_t j = 0; j < motoresFuerzaDisponibles.size(); ++j) {
+        if (!fuerzaUsado[j]) {
+            motoresFuerzaDisponibles[conservados++] = motoresFuerzaDisponibles[j];
+        }
+    }
+    motoresFuerzaDisponibles.resize(conservados);
+    std::vector<const MotorTrabajo*> trabajoAsignado;
+    for (size_t j = 0; j < trabajo.size(); ++j) {
+        if (trabajoUsado[j]) {
+            trabajoAsignado.push_back(trabajo[j]);
+        }
+    }
+    std::sort(trabajoAsignado.begin(), trabajoAsignado.end());
+    motoresTrabajoDisponibles.quitarSi([&trabajoAsignado](const MotorTrabajo* motor) {
+        return std::binary_search(trabajoAsignado.begin(), trabajoAsignado.end(), motor);
+    });
+    lote.milisegundosPlan = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+
+    for (size_t i = 0; i < pedidos.size(); ++i) {
+        if (asignados[i]) {
+            lote.ganancia += calcularGanancia(*armarCarro(pedidos[i], fechas[i], asignados[i]));
+            lote.ensamblados++;
+        }
+    }
+    return lote;
+}
+
+const char* mensajeResultado(Resultado resultado) {
+    switch (resultado) {
+        case Resultado::Exito:                 return "Operación realizada exitosamente.";
+        case Resultado::CodigoDuplicado:       return "Ya existe un motor con ese código.";
+        case Resultado::CaballosFueraDeRango:  return "Caballos de fuerza fuera del rango permitido.";
+        case Resultado::PlazasInvalidas:       return "Cantidad de plazas inválida.";
+        case Resultado::SinMotoresDisponibles: return "No hay motores disponibles.";
+        case Resultado::SinMotoresArtesanales: return "No hay motores artesanales disponibles.";
+        case Resultado::CarroNoEncontrado:     return "No se encontró un carro con el código de motor proporcionado.";
+        case Resultado::CodigoInvalido:        return "El código del motor debe tener 12 caracteres.";
+        case Resultado::FechaInvalida:         return "Fecha inválida, use el formato DD/MM/AAAA.";
+        case Resultado::SinArchivoHistorico:   return "No hay un archivo histórico abierto (use --estado o --historico).";
+    }
+    return "";
+}
+
+// Convierte el código y la fecha de un motor nuevo y comprueba que el código no esté registrado
+Resultado InventarioPlanta::validarMotorNuevo(std::string_view textoCodigo, std::string_view textoFecha,
+                                              CodigoMotor& codigo, Fecha& fecha) const {
+    if (!CodigoMotor::desdeTexto(textoCodigo, codigo)) {
+        return Resultado::CodigoInvalido;
+    }
+    if (!Fecha::desdeTexto(textoFecha, fecha)) {
+        return Resultado::FechaInvalida;
+    }
+    if (indiceMotores.count(codigo) || motorArchivado(codigo)) {
+        return Resultado::CodigoDuplicado;
+    }
+    return Resultado::Exito;
+}
+
+// Registra un motor recién creado en el índice por código, la producción por fecha y la calidad de su
+// especialista; devuelve su entrada del índice
+EntradaIndiceMotor& InventarioPlanta::registrarMotorNuevo(Motor* motor) {
+    EntradaIndiceMotor& entrada = indiceMotores[motor->getCodigo()];
+    entrada = {motor, SIN_CARRO};
+    produccionMotores.agregar(motor->getFechaSalida(), 1);
+    CalidadEspecialista& calidad = especialistas.calidad(motor->getEntradaEspecialista());
+    calidad.motores++;
+    calidad.reensamblados += motor->getVecesReensamblado();
+    return entrada;
+}
+
+Resultado InventarioPlanta::altaMotorAlta(std::string_view textoCodigo, std::string_view textoFecha,
+                                          std::string_view especialista, int vecesReensamblado, double maxRPM,
+                                          double consumo) {
+    CodigoMotor codigo;
+    Fecha fechaSalida;
+    Resultado resultado = validarMotorNuevo(textoCodigo, textoFecha, codigo, fechaSalida);
+    if (resultado != Resultado::Exito) {
+        return resultado;
+    }
+    const Especialista* entradaEspecialista = especialistas.registrar(especialista);
+    MotorAlta* motorAlta = poolMotoresAlta.crear(codigo, fechaSalida, entradaEspecialista, vecesReensamblado, maxRPM, consumo);
+    motoresAltaDisponibles.push_back(motorAlta);
+    registrarMotorNuevo(motorAlta);
+    motoresProducidos++;
+    registrarAltaEnDiario(motorAlta);
+    return Resultado::Exito;
+}
+
+Resultado InventarioPlanta::altaMotorFuerza(std::string_view textoCodigo, std::string_view textoFecha,
+                                            std::string_view especialista, int vecesReensamblado, int caballosFuerza) {
+    if (caballosFuerza < 80 || caballosFuerza > 4000) {
+        return Resultado::CaballosFueraDeRango;
+    }
+    CodigoMotor codigo;
+    Fecha fechaSalida;
+    Resultado resultado = validarMotorNuevo(textoCodigo, textoFecha, codigo, fechaSalida);
+    if (resultado != Resultado::Exito) {
+        return resultado;
+    }
+    const Especialista* entradaEspecialista = especialistas.registrar(especialista);
+    MotorFuerza* motorFuerza = poolMotoresFuerza.crear(codigo, fechaSalida, entradaEspecialista, vecesReensamblado, caballosFuerza);
+    motoresFuerzaDisponibles.push_back(motorFuerza);
+    registrarMotorNuevo(motorFuerza);
+    motoresProducidos++;
+    registrarAltaEnDiario(motorFuerza);
+    return Resultado::Exito;
+}
+
+Resultado InventarioPlanta::altaMotorTrabajo(std::string_view textoCodigo, std::string_view textoFecha,
+                                             std::string_view especialista, int vecesReensamblado, bool artesanal) {
+    CodigoMotor codigo;
+    Fecha fechaSalida;
+    Resultado resultado = validarMotorNuevo(textoCodigo, textoFecha, codigo, fechaSalida);
+    if (resultado != Resultado::Exito) {
+        return resultado;
+    }
+    const Especialista* entradaEspecialista = especialistas.registrar(especialista);
+    MotorTrabajo* motorTrabajo = poolMotoresTrabajo.crear(codigo, fechaSalida, entradaEspecialista, vecesReensamblado, artesanal);
+    motoresTrabajoDisponibles.agregar(motorTrabajo);
+    registrarMotorNuevo(motorTrabajo);
+    motoresProducidos++;
+    registrarAltaEnDiario(motorTrabajo);
+    return Resultado::Exito;
+}
+
+Resultado InventarioPlanta::ensamblarFormula1(std::string_view textoFecha, double velocidad, double pesoCarroceria) {
+    Fecha fechaSalida;
+    if (!Fecha::desdeTexto(textoFecha, fechaSalida)) {
+        return Resultado::FechaInvalida;
+    }
+    if (motoresAltaDisponibles.empty()) {
+        return Resultado::SinMotoresDisponibles;
+    }
+    MotorAlta* motor = motoresAltaDisponibles.back();
+    motoresAltaDisponibles.pop_back();
+
+    Formula1* formula1 = poolFormula1.crear(motor, velocidad, fechaSalida, pesoCarroceria);
+    registrarCarroEnsamblado(formula1);
+    registrarEnsamblajeEnDiario(formula1);
+    return Resultado::Exito;
+}
+
+Resultado InventarioPlanta::ensamblarOmnibus(std::string_view textoFecha, double velocidad, int cantidadPuertas) {
+    Fecha fechaSalida;
+    if (!Fecha::desdeTexto(textoFecha, fechaSalida)) {
+        return Resultado::FechaInvalida;
+    }
+    if (motoresFuerzaDisponibles.empty()) {
+        return Resultado::SinMotoresDisponibles;
+    }
+    MotorFuerza* motor = motoresFuerzaDisponibles.back();
+    motoresFuerzaDisponibles.pop_back();
+
+    Omnibus* omnibus = poolOmnibus.crear(motor, velocidad, fechaSalida, cantidadPuertas);
+    registrarCarroEnsamblado(omnibus);
+    registrarEnsamblajeEnDiario(omnibus);
+    return Resultado::Exito;
+}
+
+Resultado InventarioPlanta::ensamblarSport(std::string_view textoFecha, double velocidad, int cantidadPlazas,
+                                           int cantidadVelocidades, bool cambioUniversal) {
+    Fecha fechaSalida;
+    if (!Fecha::desdeTexto(textoFecha, fechaSalida)) {
+        return Resultado::FechaInvalida;
+    }
+    if (cantidadPlazas < 2 || cantidadPlazas > 4) {
+        return Resultado::PlazasInvalidas;
+    }
+    if (motoresTrabajoDisponibles.empty()) {
+        return Resultado::SinMotoresDisponibles;
+    }
+    MotorTrabajo* motor = motoresTrabajoDisponibles.tomarUltimo();
+
+    Sport* sport = poolSport.crear(motor, cantidadPlazas, velocidad, fechaSalida, cantidadVelocidades, cambioUniversal);
+    registrarCarroEnsamblado(sport);
+    registrarEnsamblajeEnDiario(sport);
+    return Resultado::Exito;
+}
+
+Resultado InventarioPlanta::ensamblarDeLujo(std::string_view textoFecha, double velocidad, int cantidadPlazas,
+                                            double costoTapiceria) {
+    Fecha fechaSalida;
+    if (!Fecha::desdeTexto(textoFecha, fechaSalida)) {
+        return Resultado::FechaInvalida;
+    }
+    if (cantidadPlazas < 2 || cantidadPlazas > 4) {
+        return Resultado::PlazasInvalidas;
+    }
+    if (motoresTrabajoDisponibles.empty()) {
+        return Resultado::SinMotoresDisponibles;
+    }
+
+    // Tomar un motor artesanal
+    MotorTrabajo* motor = motoresTrabajoDisponibles.tomarArtesanal();
+    if (!motor) {
+        return Resultado::SinMotoresArtesanales;
+    }
+
+    DeLujo* deLujo = poolDeLujo.crear(motor, cantidadPlazas, velocidad, fechaSalida, costoTapiceria);
+    registrarCarroEnsamblado(deLujo);
+    registrarEnsamblajeEnDiario(deLujo);
+    return Resultado::Exito;
+}
+
+// Arma el carro del pedido con un motor del tipo que corresponde, que ya salió de los disponibles
+Carro* InventarioPlanta::armarCarro(const PedidoCarro& pedido, Fecha fechaSalida, Motor* motor) {
+    Carro* carro;
+    switch (pedido.tipo) {
+        case TipoCarro::Formula1:
+            carro = poolFormula1.crear(static_cast<MotorAlta*>(motor), pedido.velocidad, fechaSalida,
+                                       pedido.pesoCarroceria);
+            break;
+        case TipoCarro::Omnibus:
+            carro = poolOmnibus.crear(static_cast<MotorFuerza*>(motor), pedido.velocidad, fechaSalida,
+                                      pedido.cantidadPuertas);
+            break;
+        case TipoCarro::Sport:
+            carro = poolSport.crear(static_cast<MotorTrabajo*>(motor), pedido.cantidadPlazas, pedido.velocidad,
+                                    fechaSalida, pedido.cantidadVelocidades, pedido.cambioUniversal);
+            break;
+        default:
+            carro = poolDeLujo.crear(static_cast<MotorTrabajo*>(motor), pedido.cantidadPlazas, pedido.velocidad,
+                                     fechaSalida, pedido.costoTapiceria);
+            break;
+    }
+    registrarCarroEnsamblado(carro);
+    registrarEnsamblajeEnDiario(carro);
+    return carro;
+}
+
+template <typename T>
+bool quitarDisponible(std::vector<T*>& disponibles, T* motor) {
+    if (!disponibles.empty() && disponibles.back() == motor) {
+        disponibles.pop_back();
+        return true;
+    }
+    auto posicion = std::find(disponibles.begin(), disponibles.end(), motor);
+    if (posicion == disponibles.end()) {
+        return false;
+    }
+    disponibles.erase(posicion);
+    return true;
+}
+
+// Ensambla el pedido con el motor del código indicado, que debe estar disponible y ser del tipo que
+// corresponde (artesanal para un carro de lujo)
+Resultado InventarioPlanta::ensamblarConMotor(const PedidoCarro& pedido, std::string_view textoCodigo) {
+    static const TipoMotor tipoMotorDelCarro[CANTIDAD_TIPOS_CARRO] = {TipoMotor::Alta, TipoMotor::Fuerza,
+                                                                       TipoMotor::Trabajo, TipoMotor::Trabajo};
+    Fecha fechaSalida;
+    Resultado resultado = validarPedido(pedido, fechaSalida);
+    if (resultado != Resultado::Exito) {
+        return resultado;
+    }
+    CodigoMotor codigo;
+    if (!CodigoMotor::desdeTexto(textoCodigo, codigo)) {
+        return Resultado::CodigoInvalido;
+    }
+    auto entrada = indiceMotores.find(codigo);
+    if (entrada == indiceMotores.end() || entrada->second.posicionCarro != SIN_CARRO ||
+        entrada->second.motor->getTipo() != tipoMotorDelCarro[static_cast<int>(pedido.tipo)]) {
+        return Resultado::SinMotoresDisponibles;
+    }
+
+    Motor* motor = entrada->second.motor;
+    if (pedido.tipo == TipoCarro::DeLujo && !static_cast<MotorTrabajo*>(motor)->esArtesanal()) {
+        return Resultado::SinMotoresArtesanales;
+    }
+    bool disponible = visitarMotor(*motor, Sobrecarga{
+        [this](MotorAlta& motorAlta) { return quitarDisponible(motoresAltaDisponibles, &motorAlta); },
+        [this](MotorFuerza& motorFuerza) { return quitarDisponible(motoresFuerzaDisponibles, &motorFuerza); },
+        [this](MotorTrabajo& motorTrabajo) { return motoresTrabajoDisponibles.quitar(&motorTrabajo); }
+    });
+    if (!disponible) {
+        return Resultado::SinMotoresDisponibles;
+    }
+    armarCarro(pedido, fechaSalida, motor);
+    return Resultado::Exito;
+}
+
+
+// entrada es la del motor del carro en el índice, si quien llama ya la tiene (evita volver a buscarla)
+void InventarioPlanta::registrarCarroEnsamblado(Carro* carro, EntradaIndiceMotor* entrada) {
+    carrosEnsamblados.push_back(carro);
+    if (entrada == nullptr) {
+        entrada = &indiceMotores[carro->getMotor()->getCodigo()];
+    }
+    entrada->posicionCarro = carrosEnsamblados.size() - 1;
+    if (usarAlmacenColumnar) {
+        almacenColumnar.agregar(carro);
+    }
+    if (usarEspejoCarros) {
+        espejoCarros.agregar(carro);
+    }
+    agregados.agregar(carro);
+    produccionCarros.agregar(carro->getFechaSalida(), 1);
+    carrosProducidos++;
+
+    if (verificarAgregadosSiempre) {
+        verificarAgregados();
+    }
+}
+
+// Quita el carro de la posición indicada del inventario: el último carro ocupa su lugar (sin desplazar el
+// vector). No toca la entrada del índice de su motor.
+void InventarioPlanta::quitarCarroEnsamblado(size_t posicion) {
+    Carro* carro = carrosEnsamblados[posicion];
+    Carro* ultimo = carrosEnsamblados.back();
+    if (ultimo != carro) {
+        carrosEnsamblados[posicion] = ultimo;
+        indiceMotores[ultimo->getMotor()->getCodigo()].posicionCarro = posicion;
+    }
+    carrosEnsamblados.pop_back();
+    if (usarAlmacenColumnar) {
+        almacenColumnar.quitar(posicion);
+    }
+    if (usarEspejoCarros) {
+        espejoCarros.quitar(posicion);
+    }
+}
+
+void InventarioPlanta::destruirCarro(Carro* carro) {
+    visitarCarro(*carro, Sobrecarga{
+        [this](Formula1& formula1) { poolFormula1.destruir(&formula1); },
+        [this](Omnibus& omnibus) { poolOmnibus.destruir(&omnibus); },
+        [this](Sport& sport) { poolSport.destruir(&sport); },
+        [this](DeLujo& deLujo) { poolDeLujo.destruir(&deLujo); }
+    });
+}
+
+void InventarioPlanta::destruirMotor(Motor* motor) {
+    visitarMotor(*motor, Sobrecarga{
+        [this](MotorAlta& motorAlta) { poolMotoresAlta.destruir(&motorAlta); },
+        [this](MotorFuerza& motorFuerza) { poolMotoresFuerza.destruir(&motorFuerza); },
+        [this](MotorTrabajo& motorTrabajo) { poolMotoresTrabajo.destruir(&motorTrabajo); }
+    });
+}
+
+Resultado InventarioPlanta::retirarCarro(std::string_view textoCodigo) {
+    CodigoMotor codigoMotor;
+    if (!CodigoMotor::desdeTexto(textoCodigo, codigoMotor)) {
+        return Resultado::CarroNoEncontrado;
+    }
+    auto entrada = indiceMotores.find(codigoMotor);
+    if (entrada == indiceMotores.end() || entrada->second.posicionCarro == SIN_CARRO) {
+        return Resultado::CarroNoEncontrado;
+    }
+
+    size_t posicion = entrada->second.posicionCarro;
+    Carro* carro = carrosEnsamblados[posicion];
+    registrarRetiroEnHistorico(carro);
+    agregados.quitar(carro);
+    produccionCarros.agregar(carro->getFechaSalida(), -1);
+
+    // El carro no pasó la prueba, se desarma y el motor vuelve al inventario
+    Motor* motor = entrada->second.motor;
+    motor->setVecesReensamblado(motor->getVecesReensamblado() + 1);
+    CalidadEspecialista& calidad = especialistas.calidad(motor->getEntradaEspecialista());
+    calidad.reensamblados++;
+    calidad.carrosRetirados++;
+
+    // Devolver el motor al inventario correspondiente; si el carro era de lujo, el motor deja de ser artesanal
+    bool eraDeLujo = carro->getTipo() == TipoCarro::DeLujo;
+    visitarMotor(*motor, Sobrecarga{
+        [this](MotorAlta& motorAlta) { motoresAltaDisponibles.push_back(&motorAlta); },
+        [this](MotorFuerza& motorFuerza) { motoresFuerzaDisponibles.push_back(&motorFuerza); },
+        [this, eraDeLujo](MotorTrabajo& motorTrabajo) {
+            motoresTrabajoDisponibles.agregar(&motorTrabajo, motorTrabajo.esArtesanal() && !eraDeLujo);
+        }
+    });
+
+    quitarCarroEnsamblado(posicion);
+    entrada->second.posicionCarro = SIN_CARRO;
+    destruirCarro(carro);
+
+    if (verificarAgregadosSiempre) {
+        verificarAgregados();
+    }
+    registrarBajaEnDiario(textoCodigo);
+    return Resultado::Exito;
+}
+
+// Muestra las diferencias entre los agregados incrementales y un recálculo completo del inventario
+void mostrarDiferenciasAgregados(const ComparacionAgregados& comparacion) {
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        if (!gananciasCoinciden(comparacion.gananciaIncremental[i], comparacion.gananciaRecalculada[i])) {
+            std::cout << "Diferencia en la ganancia del tipo " << i << ": incremental "
+                      << comparacion.gananciaIncremental[i] << ", recalculada " << comparacion.gananciaRecalculada[i]
+                      << std::endl;
+        }
+    }
+    if (comparacion.altaVelocidadIncremental != comparacion.altaVelocidadRecalculada) {
+        std::cout << "Diferencia en carros de alta velocidad: incremental " << comparacion.altaVelocidadIncremental
+                  << ", recalculado " << comparacion.altaVelocidadRecalculada << std::endl;
+    }
+    if (comparacion.capacidadIncremental != comparacion.capacidadRecalculada) {
+        std::cout << "Diferencia en la mayor capacidad de ómnibus: incremental " << comparacion.capacidadIncremental
+                  << ", recalculada " << comparacion.capacidadRecalculada << std::endl;
+    }
+}
+
+void InventarioPlanta::verificarAgregados() const {
+    mostrarDiferenciasAgregados(compararAgregados());
+}
+
+void InventarioPlanta::liberarInventario() {
+    motoresAltaDisponibles.clear();
+    motoresFuerzaDisponibles.clear();
+    motoresTrabajoDisponibles.clear();
+    carrosEnsamblados.clear();
+    indiceMotores.clear();
+    almacenColumnar.limpiar();
+    espejoCarros.limpiar();
+    agregados = AgregadosProduccion();
+    produccionMotores.limpiar();
+    produccionCarros.limpiar();
+    especialistas.clear();
+
+    poolFormula1.liberarTodo();
+    poolOmnibus.liberarTodo();
+    poolSport.liberarTodo();
+    poolDeLujo.liberarTodo();
+    poolMotoresAlta.liberarTodo();
+    poolMotoresFuerza.liberarTodo();
+    poolMotoresTrabajo.liberarTodo();
+    motoresProducidos.reiniciar(0);
+    carrosProducidos.reiniciar(0);
+}
+
+// Instantáneas binarias del estado de la planta
+//
+// Formato (versión 4, enteros y decimales en el orden de bytes de la máquina):
+//   Cabecera:      magia "PLNTSNAP", versión (u32), generación del diario (u32), planMotoresAnual y
+//                  planCarrosAnual (i32), motoresProducidos y carrosProducidos (i64), cantidad de motores y
+//                  de carros (u64), suma de verificación del contenido (u64)
+//   Especialistas: cantidad (u64) y, por cada uno, nombre (longitud u16 y bytes) y carrosRetirados (i64),
+//                  seguidos de ceros hasta una posición múltiplo de 8
+//   Motores:       RegistroMotorInstantanea (48 bytes): el código empaquetado, la fecha como número de día
+//                  y el especialista como posición en la tabla anterior
+//   Carros:        RegistroCarroInstantanea (32 bytes); el carro i lleva el motor montado número i
+//   Histórico:     registros generados para el archivo histórico (u64)
+// Los motores disponibles van primero, en el orden de su inventario, seguidos de los motores montados en
+// el orden de carrosEnsamblados. Los registros tienen ancho fijo y se copian tal cual desde el archivo
+// mapeado: la carga no convierte texto ni busca especialistas por nombre. Los objetos, el índice por
+// código y los agregados se siguen armando uno por uno al cargar.
+// La instantánea se escribe en un archivo temporal que luego reemplaza al anterior con rename, y se
+// carga mapeando el archivo en memoria.
+
+const char MAGIA_INSTANTANEA[8] = {'P', 'L', 'N', 'T', 'S', 'N', 'A', 'P'};
+const uint32_t VERSION_INSTANTANEA = 4;
+const size_t TAMANO_CABECERA_INSTANTANEA = 8 + 4 + 4 + 4 + 4 + 8 + 8 + 8 + 8 + 8;
+
+struct RegistroMotorInstantanea {
+    double valor1;                  // maxRPM o caballos de fuerza
+    double valor2;                  // consumo
+    char codigo[LONGITUD_CODIGO_MOTOR];
+    int32_t dia;                    // Fecha de salida
+    uint32_t especialista;          // Posición en la tabla de especialistas de la instantánea
+    int32_t vecesReensamblado;
+    uint8_t tipo;
+    uint8_t montado;
+    uint8_t artesanal;
+    uint8_t relleno[5];
+};
+
+struct RegistroCarroInstantanea {
+    double velocidad;
+    double valor;                   // pesoCarroceria, cantidadPuertas, cantidadVelocidades o costoTapiceria
+    int32_t dia;                    // Fecha de salida
+    int32_t cantidadPlazas;
+    uint8_t tipo;
+    uint8_t cambioUniversal;
+    uint8_t relleno[6];
+};
+
+static_assert(sizeof(RegistroMotorInstantanea) == 48 && sizeof(RegistroCarroInstantanea) == 32,
+              "Los registros de la instantánea tienen ancho fijo");
+
+// FNV-1a sobre palabras de 8 bytes (los bytes finales, de a uno)
+uint64_t sumaFNV1a(const char* datos, size_t longitud) {
+    uint64_t suma = 1469598103934665603ULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= longitud; i += sizeof(uint64_t)) {
+        uint64_t palabra;
+        std::memcpy(&palabra, datos + i, sizeof(palabra));
+        suma ^= palabra;
+        suma *= 1099511628211ULL;
+    }
+    for (; i < longitud; ++i) {
+        suma ^= static_cast<unsigned char>(datos[i]);
+        suma *= 1099511628211ULL;
+    }
+    return suma;
+}
+RegistroMotorInstantanea registroMotorInstantanea(const Motor* motor, bool montado) {
+    RegistroMotorInstantanea registro{};
+    visitarMotor(*motor, Sobrecarga{
+        [&](const MotorAlta& alta) { registro.valor1 = alta.getMaxRPM(); registro.valor2 = alta.getConsumo(); },
+        [&](const MotorFuerza& fuerza) { registro.valor1 = fuerza.getCaballosFuerza(); },
+        [&](const MotorTrabajo& trabajo) { registro.artesanal = trabajo.esArtesanal(); }
+    });
+    std::memcpy(registro.codigo, motor->getCodigo().vista().data(), LONGITUD_CODIGO_MOTOR);
+    registro.dia = motor->getFechaSalida().getDia();
+    registro.especialista = motor->getNumeroEspecialista();
+    registro.vecesReensamblado = motor->getVecesReensamblado();
+    registro.tipo = static_cast<uint8_t>(motor->getTipo());
+    registro.montado = montado;
+    return registro;
+}
+
+RegistroCarroInstantanea registroCarroInstantanea(const Carro* carro) {
+    RegistroCarroInstantanea registro{};
+    visitarCarro(*carro, Sobrecarga{
+        [&](const Formula1& formula1) { registro.valor = formula1.getPesoCarroceria(); },
+        [&](const Omnibus& omnibus) { registro.valor = omnibus.getCantidadPuertas(); },
+        [&](const Sport& sport) {
+            registro.valor = sport.getCantidadVelocidades();
+            registro.cambioUniversal = sport.esCambioUniversal();
+        },
+        [&](const DeLujo& deLujo) { registro.valor = deLujo.getCostoTapiceria(); }
+    });
+    registro.velocidad = carro->getVelocidad();
+    registro.dia = carro->getFechaSalida().getDia();
+    registro.cantidadPlazas = carro->getCantidadPlazas();
+    registro.tipo = static_cast<uint8_t>(carro->getTipo());
+    return registro;
+}
+
+// Escribe todo el contenido en ruta de forma atómica (archivo temporal, fsync y rename)
+bool escribirArchivoAtomico(const std::string& ruta, const std::string& contenido) {
+    std::string temporal = ruta + ".tmp";
+    int descriptor = open(temporal.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        return false;
+    }
+    size_t escritos = 0;
+    while (escritos < contenido.size()) {
+        ssize_t n = write(descriptor, contenido.data() + escritos, contenido.size() - escritos);
+        if (n <= 0) {
+            close(descriptor);
+            unlink(temporal.c_str());
+            return false;
+        }
+        escritos += n;
+    }
+    if (fsync(descriptor) != 0 || close(descriptor) != 0 || rename(temporal.c_str(), ruta.c_str()) != 0) {
+        unlink(temporal.c_str());
+        return false;
+    }
+
+    // Sincronizar el directorio para que el rename sobreviva a una caída
+    size_t barra = ruta.find_last_of('/');
+    std::string directorio = barra == std::string::npos ? "." : ruta.substr(0, barra + 1);
+    int descriptorDirectorio = open(directorio.c_str(), O_RDONLY);
+    if (descriptorDirectorio >= 0) {
+        fsync(descriptorDirectorio);
+        close(descriptorDirectorio);
+    }
+    return true;
+}
+
+bool InventarioPlanta::guardarInstantanea(const std::string& ruta) {
+    auto inicio = std::chrono::steady_clock::now();
+    // La instantánea cuenta los registros históricos generados: tienen que estar en el disco antes
+    if (!archivoHistorico.confirmar()) {
+        return false;
+    }
+    EscritorBinario cuerpo;
+    uint64_t cantidadMotores = motoresAltaDisponibles.size() + motoresFuerzaDisponibles.size() +
+                               motoresTrabajoDisponibles.size() + carrosEnsamblados.size();
+    cuerpo.contenido().reserve(cantidadMotores * sizeof(RegistroMotorInstantanea) +
+                               carrosEnsamblados.size() * sizeof(RegistroCarroInstantanea) + 4096);
+
+    // Los motores y reensamblajes por especialista se recalculan al cargar; las bajas no se pueden deducir
+    cuerpo.valor<uint64_t>(especialistas.size());
+    for (uint32_t numero = 0; numero < especialistas.size(); ++numero) {
+        cuerpo.cadena(especialistas.nombre(numero));
+        cuerpo.valor<int64_t>(especialistas.calidad(numero).carrosRetirados);
+    }
+    while ((TAMANO_CABECERA_INSTANTANEA + cuerpo.tamano()) % sizeof(uint64_t) != 0) {
+        cuerpo.valor<uint8_t>(0);
+    }
+
+    for (const auto& motor : motoresAltaDisponibles) {
+        cuerpo.valor(registroMotorInstantanea(motor, false));
+    }
+    for (const auto& motor : motoresFuerzaDisponibles) {
+        cuerpo.valor(registroMotorInstantanea(motor, false));
+    }
+    motoresTrabajoDisponibles.recorrer([&](const MotorTrabajo* motor) {
+        cuerpo.valor(registroMotorInstantanea(motor, false));
+    });
+    for (const auto& carro : carrosEnsamblados) {
+        cuerpo.valor(registroMotorInstantanea(carro->getMotor(), true));
+    }
+    for (const auto& carro : carrosEnsamblados) {
+        cuerpo.valor(registroCarroInstantanea(carro));
+    }
+    cuerpo.valor<uint64_t>(registrosHistoricos);
+
+    EscritorBinario archivo;
+    archivo.contenido().append(MAGIA_INSTANTANEA, sizeof(MAGIA_INSTANTANEA));
+    archivo.valor<uint32_t>(VERSION_INSTANTANEA);
+    archivo.valor<uint32_t>(generacionDiario);
+    archivo.valor<int32_t>(planMotoresAnual);
+    archivo.valor<int32_t>(planCarrosAnual);
+    archivo.valor<int64_t>(motoresProducidos);
+    archivo.valor<int64_t>(carrosProducidos);
+    archivo.valor<uint64_t>(cantidadMotores);
+    archivo.valor<uint64_t>(carrosEnsamblados.size());
+    archivo.valor<uint64_t>(sumaFNV1a(cuerpo.contenido().data(), cuerpo.contenido().size()));
+    archivo.contenido() += cuerpo.contenido();
+
+    bool correcto = cuerpo.esCorrecto() && escribirArchivoAtomico(ruta, archivo.contenido());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    if (correcto) {
+        std::cout << "Instantánea guardada en " << ruta << ": " << cantidadMotores << " motores, "
+                  << carrosEnsamblados.size() << " carros (" << archivo.contenido().size() << " bytes, " << ms
+                  << " ms)." << std::endl;
+    } else {
+        std::cout << "No se pudo guardar la instantánea en " << ruta << "." << std::endl;
+    }
+    return correcto;
+}
+
+// Crea un motor leído de una instantánea y lo registra; si no está montado, vuelve a su inventario.
+// Devuelve su entrada del índice.
+EntradaIndiceMotor& InventarioPlanta::restaurarMotor(TipoMotor tipo, bool montado, const CodigoMotor& codigo,
+                                                     Fecha fechaSalida, const Especialista* especialista, int veces,
+                                                     double valor1, double valor2, bool artesanal) {
+    Motor* motor;
+    switch (tipo) {
+        case TipoMotor::Alta: {
+            MotorAlta* alta = poolMotoresAlta.crear(codigo, fechaSalida, especialista, veces, valor1, valor2);
+            if (!montado) {
+                motoresAltaDisponibles.push_back(alta);
+            }
+            motor = alta;
+            break;
+        }
+        case TipoMotor::Fuerza: {
+            MotorFuerza* fuerza = poolMotoresFuerza.crear(codigo, fechaSalida, especialista, veces,
+                                                          static_cast<int>(valor1));
+            if (!montado) {
+                motoresFuerzaDisponibles.push_back(fuerza);
+            }
+            motor = fuerza;
+            break;
+        }
+        default: {
+            MotorTrabajo* trabajo = poolMotoresTrabajo.crear(codigo, fechaSalida, especialista, veces, artesanal);
+            if (!montado) {
+                motoresTrabajoDisponibles.agregar(trabajo);
+            }
+            motor = trabajo;
+            break;
+        }
+    }
+    return registrarMotorNuevo(motor);
+}
+
+// Crea un carro leído de una instantánea sobre el motor de la entrada y lo registra en el inventario
+void InventarioPlanta::restaurarCarro(TipoCarro tipo, EntradaIndiceMotor& entrada, int cantidadPlazas, double velocidad,
+                                      Fecha fechaSalida, double valor, bool cambioUniversal) {
+    Motor* motor = entrada.motor;
+    Carro* carro;
+    switch (tipo) {
+        case TipoCarro::Formula1:
+            carro = poolFormula1.crear(static_cast<MotorAlta*>(motor), velocidad, fechaSalida, valor);
+            break;
+        case TipoCarro::Omnibus:
+            carro = poolOmnibus.crear(static_cast<MotorFuerza*>(motor), velocidad, fechaSalida,
+                                      static_cast<int>(valor));
+            break;
+        case TipoCarro::Sport:
+            carro = poolSport.crear(static_cast<MotorTrabajo*>(motor), cantidadPlazas, velocidad, fechaSalida,
+                                    static_cast<int>(valor), cambioUniversal);
+            break;
+        default:
+            carro = poolDeLujo.crear(static_cast<MotorTrabajo*>(motor), cantidadPlazas, velocidad, fechaSalida,
+                                     valor);
+            break;
+    }
+    registrarCarroEnsamblado(carro, &entrada);
+}
+
+// Lee los especialistas y los registros de ancho fijo; devuelve false si faltan datos o un registro no es
+// válido
+bool InventarioPlanta::restaurarRegistros(LectorBinario& lector, uint64_t cantidadMotores, uint64_t cantidadCarros,
+                                          size_t longitudCuerpo) {
+    uint64_t cantidadEspecialistas = lector.valor<uint64_t>();
+    if (cantidadEspecialistas > longitudCuerpo) {
+        return false;
+    }
+    std::vector<const Especialista*> entradasEspecialistas;
+    entradasEspecialistas.reserve(cantidadEspecialistas);
+    for (uint64_t i = 0; i < cantidadEspecialistas && lector.esCorrecto(); ++i) {
+        const Especialista* especialista = especialistas.registrar(lector.vistaCadena());
+        especialistas.calidad(especialista).carrosRetirados = lector.valor<int64_t>();
+        entradasEspecialistas.push_back(especialista);
+    }
+    while (lector.esCorrecto() && (longitudCuerpo - lector.restantes() + TAMANO_CABECERA_INSTANTANEA) %
+                                      sizeof(uint64_t) != 0) {
+        lector.valor<uint8_t>();
+    }
+    if (!lector.esCorrecto() || cantidadCarros > cantidadMotores ||
+        cantidadMotores > lector.restantes() / sizeof(RegistroMotorInstantanea)) {
+        return false;
+    }
+    indiceMotores.reserve(cantidadMotores);
+    carrosEnsamblados.reserve(cantidadCarros);
+
+    std::vector<EntradaIndiceMotor*> montados;
+    montados.reserve(cantidadCarros);
+    for (uint64_t i = 0; i < cantidadMotores; ++i) {
+        RegistroMotorInstantanea registro = lector.valor<RegistroMotorInstantanea>();
+        if (registro.especialista >= entradasEspecialistas.size() || registro.tipo > 2) {
+            return false;
+        }
+        CodigoMotor codigo;
+        CodigoMotor::desdeTexto(std::string_view(registro.codigo, LONGITUD_CODIGO_MOTOR), codigo);
+        EntradaIndiceMotor& entrada = restaurarMotor(static_cast<TipoMotor>(registro.tipo), registro.montado,
+                                                     codigo, Fecha::desdeDia(registro.dia),
+                                                     entradasEspecialistas[registro.especialista],
+                                                     registro.vecesReensamblado, registro.valor1, registro.valor2,
+                                                     registro.artesanal);
+        if (registro.montado) {
+            montados.push_back(&entrada);
+        }
+    }
+    if (montados.size() != cantidadCarros || cantidadCarros > lector.restantes() / sizeof(RegistroCarroInstantanea)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < cantidadCarros; ++i) {
+        RegistroCarroInstantanea registro = lector.valor<RegistroCarroInstantanea>();
+        if (registro.tipo > 3) {
+            return false;
+        }
+        restaurarCarro(static_cast<TipoCarro>(registro.tipo), *montados[i], registro.cantidadPlazas,
+                       registro.velocidad, Fecha::desdeDia(registro.dia), registro.valor, registro.cambioUniversal);
+    }
+    return lector.esCorrecto();
+}
+
+// Reconstruye el inventario a partir del contenido de una instantánea; el inventario debe estar vacío
+bool InventarioPlanta::restaurarInstantanea(const char* datos, size_t longitud) {
+    if (longitud < TAMANO_CABECERA_INSTANTANEA || std::memcmp(datos, MAGIA_INSTANTANEA, sizeof(MAGIA_INSTANTANEA)) != 0) {
+        std::cout << "El archivo no es una instantánea de la planta." << std::endl;
+        return false;
+    }
+    LectorBinario cabecera(datos + sizeof(MAGIA_INSTANTANEA), TAMANO_CABECERA_INSTANTANEA - sizeof(MAGIA_INSTANTANEA));
+    uint32_t version = cabecera.valor<uint32_t>();
+    uint32_t generacion = cabecera.valor<uint32_t>();
+    if (version != VERSION_INSTANTANEA) {
+        std::cout << "Versión de instantánea no soportada: " << version << "." << std::endl;
+        return false;
+    }
+    int32_t planMotores = cabecera.valor<int32_t>();
+    int32_t planCarros = cabecera.valor<int32_t>();
+    int64_t producidosMotores = cabecera.valor<int64_t>();
+    int64_t producidosCarros = cabecera.valor<int64_t>();
+    uint64_t cantidadMotores = cabecera.valor<uint64_t>();
+    uint64_t cantidadCarros = cabecera.valor<uint64_t>();
+    uint64_t suma = cabecera.valor<uint64_t>();
+
+    const char* cuerpo = datos + TAMANO_CABECERA_INSTANTANEA;
+    size_t longitudCuerpo = longitud - TAMANO_CABECERA_INSTANTANEA;
+    if (sumaFNV1a(cuerpo, longitudCuerpo) != suma) {
+        std::cout << "La instantánea está dañada (suma de verificación incorrecta)." << std::endl;
+        return false;
+    }
+
+    LectorBinario lector(cuerpo, longitudCuerpo);
+    if (!restaurarRegistros(lector, cantidadMotores, cantidadCarros, longitudCuerpo)) {
+        std::cout << "La instantánea está incompleta o contiene registros inválidos." << std::endl;
+        liberarInventario();
+        return false;
+    }
+    uint64_t historicos = lector.valor<uint64_t>();
+    if (!lector.esCorrecto()) {
+        std::cout << "La instantánea está incompleta." << std::endl;
+        liberarInventario();
+        return false;
+    }
+
+    planMotoresAnual = planMotores;
+    planCarrosAnual = planCarros;
+    motoresProducidos.reiniciar(producidosMotores);
+    carrosProducidos.reiniciar(producidosCarros);
+    generacionDiario = generacion;
+    registrosHistoricos = historicos;
+    return true;
+}
+
+bool InventarioPlanta::cargarInstantanea(const std::string& ruta) {
+    auto inicio = std::chrono::steady_clock::now();
+    int descriptor = open(ruta.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        std::cout << "No se pudo abrir la instantánea " << ruta << "." << std::endl;
+        return false;
+    }
+    struct stat informacion;
+    if (fstat(descriptor, &informacion) != 0 || informacion.st_size == 0) {
+        close(descriptor);
+        std::cout << "La instantánea " << ruta << " está vacía." << std::endl;
+        return false;
+    }
+
+    size_t longitud = informacion.st_size;
+    void* mapa = mmap(nullptr, longitud, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (mapa == MAP_FAILED) {
+        std::cout << "No se pudo mapear la instantánea " << ruta << "." << std::endl;
+        return false;
+    }
+    madvise(mapa, longitud, MADV_SEQUENTIAL);
+
+    liberarInventario();
+    bool correcto = restaurarInstantanea(static_cast<const char*>(mapa), longitud);
+    munmap(mapa, longitud);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    if (correcto) {
+        std::cout << "Instantánea cargada desde " << ruta << ": " << indiceMotores.size() << " motores, "
+                  << carrosEnsamblados.size() << " carros (" << ms << " ms)." << std::endl;
+    }
+    return correcto;
+}
+
+// Diario de operaciones (write-ahead log)
+//
+// Entre dos instantáneas, cada alta de motor, ensamblaje, baja de carro y archivo de carros antiguos se
+// agrega al diario <archivoEstado>.diario. Al iniciar, el diario se reproduce sobre la instantánea
+// cargada; compactar guarda una instantánea nueva y vacía el diario.
+//
+// Formato (versión 1):
+//   Cabecera: magia "PLNTDIAR", versión (u32), generación (u32)
+//   Registros: longitud del contenido (u32), suma FNV-1a del contenido (u32, 32 bits bajos), contenido
+//   Contenido: operación (u8) seguida de
+//     AltaMotor:  el mismo RegistroMotorInstantanea que la instantánea, seguido del especialista (la
+//                 única cadena de su propia tabla, en la posición 0)
+//     Ensamblaje: tipo (u8), cantidadPlazas (i32), velocidad (f64), valor propio del tipo (f64),
+//                 cambioUniversal (u8), fechaSalida y código del motor asignado
+//     Baja:       código del motor del carro
+//     Archivo:    fecha de corte
+// Los ensamblajes se reproducen con el motor guardado, que debe seguir disponible: es el que eligen las
+// reglas de ensamblarCarro, salvo en los lotes de ensamblarLote, que eligen los motores por su costo.
+//
+// Los registros se acumulan en memoria y se escriben con un solo write y fdatasync por grupo: al
+// terminar cada opción del menú o una importación, o cuando el grupo alcanza TAMANO_GRUPO_DIARIO. Antes
+// de cada grupo se confirma el archivo histórico, que así nunca queda detrás del diario.
+// La instantánea guarda la generación del diario que la continúa, así que si la planta se cae entre
+// el rename de la instantánea y el vaciado del diario, el diario viejo se descarta en vez de aplicarse
+// dos veces. Un registro incompleto o dañado al final (caída a mitad de una escritura) se descarta.
+
+
+void InventarioPlanta::registrarAltaEnDiario(const Motor* motor) {
+    if (!diario.abierto()) {
+        return;
+    }
+    // El especialista va por nombre, como única entrada de la tabla propia del registro
+    RegistroMotorInstantanea registroMotor = registroMotorInstantanea(motor, false);
+    registroMotor.especialista = 0;
+    EscritorBinario& registro = diario.iniciarRegistro(OperacionDiario::AltaMotor);
+    registro.valor(registroMotor);
+    registro.cadena(motor->getEspecialista());
+    diario.terminarRegistro();
+}
+
+void InventarioPlanta::registrarEnsamblajeEnDiario(const Carro* carro) {
+    if (!diario.abierto()) {
+        return;
+    }
+    EscritorBinario& registro = diario.iniciarRegistro(OperacionDiario::Ensamblaje);
+    double valor = 0;
+    bool cambioUniversal = false;
+    visitarCarro(*carro, Sobrecarga{
+        [&](const Formula1& formula1) { valor = formula1.getPesoCarroceria(); },
+        [&](const Omnibus& omnibus) { valor = omnibus.getCantidadPuertas(); },
+        [&](const Sport& sport) {
+            valor = sport.getCantidadVelocidades();
+            cambioUniversal = sport.esCambioUniversal();
+        },
+        [&](const DeLujo& deLujo) { valor = deLujo.getCostoTapiceria(); }
+    });
+    registro.valor<uint8_t>(static_cast<uint8_t>(carro->getTipo()));
+    registro.valor<int32_t>(carro->getCantidadPlazas());
+    registro.valor<double>(carro->getVelocidad());
+    registro.valor<double>(valor);
+    registro.valor<uint8_t>(cambioUniversal);
+    char fecha[LONGITUD_FECHA];
+    registro.cadena(carro->getFechaSalida().escribir(fecha));
+    registro.cadena(carro->getMotor()->getCodigo().vista());
+    diario.terminarRegistro();
+}
+
+void InventarioPlanta::registrarBajaEnDiario(std::string_view codigoMotor) {
+    if (!diario.abierto()) {
+        return;
+    }
+    diario.iniciarRegistro(OperacionDiario::Baja).cadena(codigoMotor);
+    diario.terminarRegistro();
+}
+
+void InventarioPlanta::registrarArchivoEnDiario(Fecha corte) {
+    if (!diario.abierto()) {
+        return;
+    }
+    char fecha[LONGITUD_FECHA];
+    diario.iniciarRegistro(OperacionDiario::Archivo).cadena(corte.escribir(fecha));
+    diario.terminarRegistro();
+}
+
+void InventarioPlanta::confirmarDiario() {
+    archivoHistorico.confirmar();
+    diario.confirmar();
+}
+
+// Vuelve a ejecutar la operación de un registro; devuelve false si el resultado no coincide con el original
+bool InventarioPlanta::aplicarRegistroDiario(LectorBinario& lector) {
+    OperacionDiario operacion = static_cast<OperacionDiario>(lector.valor<uint8_t>());
+    switch (operacion) {
+        case OperacionDiario::AltaMotor: {
+            RegistroMotorInstantanea registro = lector.valor<RegistroMotorInstantanea>();
+            std::string especialista = lector.cadena();
+            if (!lector.esCorrecto() || !lector.terminado() || registro.especialista != 0 ||
+                registro.tipo > static_cast<uint8_t>(TipoMotor::Trabajo)) {
+                return false;
+            }
+            DatosMotor motor;
+            char fecha[LONGITUD_FECHA];
+            motor.tipo = static_cast<TipoMotor>(registro.tipo);
+            motor.codigo.assign(registro.codigo, LONGITUD_CODIGO_MOTOR);
+            motor.fechaSalida = std::string(Fecha::desdeDia(registro.dia).escribir(fecha));
+            motor.especialista = std::move(especialista);
+            motor.vecesReensamblado = registro.vecesReensamblado;
+            motor.maxRPM = registro.valor1;
+            motor.consumo = registro.valor2;
+            motor.caballosFuerza = static_cast<int>(registro.valor1);
+            motor.artesanal = registro.artesanal;
+            return agregarMotor(motor) == Resultado::Exito;
+        }
+        case OperacionDiario::Ensamblaje: {
+            PedidoCarro pedido;
+            uint8_t tipo = lector.valor<uint8_t>();
+            pedido.cantidadPlazas = lector.valor<int32_t>();
+            pedido.velocidad = lector.valor<double>();
+            double valor = lector.valor<double>();
+            pedido.cambioUniversal = lector.valor<uint8_t>();
+            pedido.fechaSalida = lector.cadena();
+            std::string codigoMotor = lector.cadena();
+            if (!lector.esCorrecto() || !lector.terminado() || tipo >= CANTIDAD_TIPOS_CARRO) {
+                return false;
+            }
+            pedido.tipo = static_cast<TipoCarro>(tipo);
+            pedido.pesoCarroceria = valor;
+            pedido.cantidadPuertas = static_cast<int>(valor);
+            pedido.cantidadVelocidades = static_cast<int>(valor);
+            pedido.costoTapiceria = valor;
+            return ensamblarConMotor(pedido, codigoMotor) == Resultado::Exito;
+        }
+        case OperacionDiario::Baja: {
+            std::string_view codigoMotor = lector.vistaCadena();
+            if (!lector.esCorrecto() || !lector.terminado()) {
+                return false;
+            }
+            return darDeBajaCarro(codigoMotor) == Resultado::Exito;
+        }
+        case OperacionDiario::Archivo: {
+            Fecha corte;
+            bool fechaValida = Fecha::desdeTexto(lector.vistaCadena(), corte);
+            if (!lector.esCorrecto() || !lector.terminado() || !fechaValida) {
+                return false;
+            }
+            return archivarCarros(corte).resultado == Resultado::Exito;
+        }
+    }
+    return false;
+}
+
+// Reproduce el diario de ruta sobre el estado actual y lo deja abierto para agregar operaciones
+bool InventarioPlanta::abrirDiario(const std::string& ruta) {
+    auto inicio = std::chrono::steady_clock::now();
+    archivoDiario = ruta;
+    size_t longitudValida = 0;
+    size_t longitud = 0;
+    long reproducidos = 0;
+    long inconsistentes = 0;
+    bool vigente = false;
+
+    int descriptor = open(ruta.c_str(), O_RDONLY);
+    if (descriptor >= 0) {
+        struct stat informacion;
+        if (fstat(descriptor, &informacion) == 0) {
+            longitud = informacion.st_size;
+        }
+        // Un diario más corto que la cabecera quedó a medio crear y no tiene operaciones
+        void* mapa = nullptr;
+        if (longitud >= TAMANO_CABECERA_DIARIO) {
+            mapa = mmap(nullptr, longitud, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        }
+        close(descriptor);
+        if (mapa == MAP_FAILED) {
+            std::cout << "No se pudo mapear el diario " << ruta << "." << std::endl;
+            return false;
+        }
+
+        if (mapa) {
+            madvise(mapa, longitud, MADV_SEQUENTIAL);
+            const char* datos = static_cast<const char*>(mapa);
+            LectorBinario cabecera(datos + sizeof(MAGIA_DIARIO), TAMANO_CABECERA_DIARIO - sizeof(MAGIA_DIARIO));
+            uint32_t version = cabecera.valor<uint32_t>();
+            uint32_t generacion = cabecera.valor<uint32_t>();
+            if (std::memcmp(datos, MAGIA_DIARIO, sizeof(MAGIA_DIARIO)) != 0 || version != VERSION_DIARIO) {
+                munmap(mapa, longitud);
+                std::cout << "El archivo " << ruta << " no es un diario de operaciones soportado." << std::endl;
+                return false;
+            }
+            if (generacion > generacionDiario) {
+                munmap(mapa, longitud);
+                std::cout << "El diario " << ruta << " es posterior a la instantánea cargada (generación "
+                          << generacion << ", se esperaba " << generacionDiario << ")." << std::endl;
+                return false;
+            }
+
+            // Un diario de una generación anterior ya está incluido en la instantánea
+            vigente = generacion == generacionDiario;
+            longitudValida = TAMANO_CABECERA_DIARIO;
+            while (vigente && longitud - longitudValida >= TAMANO_ENCABEZADO_REGISTRO) {
+                LectorBinario encabezado(datos + longitudValida, TAMANO_ENCABEZADO_REGISTRO);
+                uint32_t longitudRegistro = encabezado.valor<uint32_t>();
+                uint32_t suma = encabezado.valor<uint32_t>();
+                const char* contenido = datos + longitudValida + TAMANO_ENCABEZADO_REGISTRO;
+                if (longitud - longitudValida - TAMANO_ENCABEZADO_REGISTRO < longitudRegistro ||
+                    static_cast<uint32_t>(sumaFNV1a(contenido, longitudRegistro)) != suma) {
+                    break;
+                }
+                LectorBinario lector(contenido, longitudRegistro);
+                if (!aplicarRegistroDiario(lector)) {
+                    inconsistentes++;
+                }
+                reproducidos++;
+                longitudValida += TAMANO_ENCABEZADO_REGISTRO + longitudRegistro;
+            }
+            munmap(mapa, longitud);
+        }
+    }
+
+    if (!diario.abrir(ruta)) {
+        std::cout << "No se pudo abrir el diario " << ruta << "." << std::endl;
+        return false;
+    }
+    bool correcto = vigente ? diario.recortarArchivo(longitudValida, reproducidos) : diario.reiniciar(generacionDiario);
+    if (!correcto) {
+        std::cout << "No se pudo preparar el diario " << ruta << "." << std::endl;
+        diario.cerrar();
+        return false;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    if (reproducidos > 0) {
+        std::cout << "Diario reproducido desde " << ruta << ": " << reproducidos << " operaciones (" << ms << " ms)."
+                  << std::endl;
+    }
+    if (vigente && longitudValida < longitud) {
+        std::cout << "Se descartaron " << longitud - longitudValida << " bytes incompletos o dañados al final del diario."
+                  << std::endl;
+    }
+    if (inconsistentes > 0) {
+        std::cout << "Advertencia: " << inconsistentes << " operaciones del diario no produjeron el mismo resultado."
+                  << std::endl;
+    }
+    return true;
+}
+
+// Incorpora el diario a una instantánea nueva y lo vacía
+bool InventarioPlanta::compactarDiario() {
+    if (!diario.abierto()) {
+        return guardarInstantanea(archivoEstado);
+    }
+    long registros = diario.getRegistros();
+    long grupos = diario.getGruposConfirmados();
+    generacionDiario++;
+    if (!guardarInstantanea(archivoEstado)) {
+        generacionDiario--;
+        return false;
+    }
+    if (!diario.reiniciar(generacionDiario)) {
+        std::cout << "No se pudo vaciar el diario " << archivoDiario << "." << std::endl;
+        return false;
+    }
+    std::cout << "Diario compactado: " << registros << " operaciones (" << grupos << " grupos confirmados)."
+              << std::endl;
+    return true;
+}
+
+bool InventarioPlanta::abrirEstado(const std::string& ruta) {
+    archivoEstado = ruta;
+    bool conInstantanea = access(archivoEstado.c_str(), F_OK) == 0;
+    if (conInstantanea && !cargarInstantanea(archivoEstado)) {
+        return false;
+    }
+    if (!abrirArchivoHistorico(archivoEstado + ".historico")) {
+        return false;
+    }
+    uint64_t registrosInstantanea = registrosHistoricos;
+    return abrirDiario(archivoEstado + ".diario") &&
+           conciliarArchivoHistorico(conInstantanea || registrosHistoricos > 0, registrosInstantanea);
+}
+
+void InventarioPlanta::cerrarEstado() {
+    if (tieneEstado()) {
+        compactarDiario();
+        diario.cerrar();
+    }
+}
+
+void InventarioPlanta::cerrarDiario() {
+    diario.cerrar();
+}
+
+// Archivo histórico de carros
+//
+// Los carros con fecha de salida anterior a un corte (opción del menú o --archivar) salen del inventario
+// en memoria junto con su motor y se agregan a <archivoEstado>.historico (o al archivo de --historico),
+// igual que los carros dados de baja antes de desarmarse. El archivo solo crece: los registros se
+// codifican campo por campo en bloques independientes, y una consulta lee y decodifica de a un bloque,
+// salteando los que no tienen carros en el rango de fechas pedido. En memoria quedan solo los totales y
+// los códigos de los motores archivados, que siguen reservados.
+//
+// Formato (versión 1):
+//   Cabecera: magia "PLNTHIST", versión (u32)
+//   Bloques:  longitud del contenido (u32), cantidad de registros (u32), primer y último día de salida de
+//             sus carros (i32), suma FNV-1a del contenido (u32, 32 bits bajos), contenido
+//   Registro: banderas (u8: tipo de carro, retirado, cambioUniversal, artesanal), día de salida del carro
+//             (diferencia con el registro anterior) y del motor (diferencia con el del carro), código del
+//             motor (cantidad de caracteres iguales al del registro anterior, u8, y el resto), especialista
+//             (posición en el diccionario del bloque; la primera vez, seguida del nombre), vecesReensamblado,
+//             cantidadPlazas, velocidad, valor propio del tipo de carro y valores del motor
+// Los enteros van en base 128 (los que pueden ser negativos, en zigzag) y los decimales que son un número
+// exacto de centésimos, como ese número; los demás decimales ocupan 8 bytes.
+//
+// Los registros se numeran en el orden en que se generan y la instantánea guarda cuántos generó el estado
+// (registrosHistoricos). El archivo se confirma antes de cada grupo del diario, así que al iniciar puede
+// tener registros de más, de operaciones que no llegaron al diario (se recortan), o de menos, de
+// operaciones del diario cuyo bloque no llegó al disco (la reproducción los vuelve a agregar); la
+// reproducción no repite los que ya están en el archivo.
+
+RegistroHistorico registroHistorico(const Carro& carro, ClaseHistorico clase) {
+    RegistroHistorico registro;
+    registro.clase = clase;
+    registro.tipo = carro.getTipo();
+    registro.fechaSalida = carro.getFechaSalida();
+    registro.cantidadPlazas = carro.getCantidadPlazas();
+    registro.velocidad = carro.getVelocidad();
+    visitarCarro(carro, Sobrecarga{
+        [&](const Formula1& formula1) { registro.valorPropio = formula1.getPesoCarroceria(); },
+        [&](const Omnibus& omnibus) { registro.valorPropio = omnibus.getCantidadPuertas(); },
+        [&](const Sport& sport) {
+            registro.valorPropio = sport.getCantidadVelocidades();
+            registro.cambioUniversal = sport.esCambioUniversal();
+        },
+        [&](const DeLujo& deLujo) { registro.valorPropio = deLujo.getCostoTapiceria(); }
+    });
+    const Motor& motor = *carro.getMotor();
+    registro.codigoMotor = motor.getCodigo();
+    registro.fechaMotor = motor.getFechaSalida();
+    registro.especialista = motor.getEntradaEspecialista();
+    registro.vecesReensamblado = motor.getVecesReensamblado();
+    visitarMotor(motor, Sobrecarga{
+        [&](const MotorAlta& alta) {
+            registro.valorMotor1 = alta.getMaxRPM();
+            registro.valorMotor2 = alta.getConsumo();
+        },
+        [&](const MotorFuerza& fuerza) { registro.valorMotor1 = fuerza.getCaballosFuerza(); },
+        [&](const MotorTrabajo& trabajo) { registro.artesanal = trabajo.esArtesanal(); }
+    });
+    return registro;
+}
+
+
+// Agrega el registro que sigue en la numeración del estado, salvo que ya esté en el archivo (reproducción
+// del diario)
+void InventarioPlanta::agregarAlHistorico(const RegistroHistorico& registro) {
+    uint64_t numero = registrosHistoricos++;
+    if (numero >= archivoHistorico.getRegistros()) {
+        archivoHistorico.agregar(registro);
+    }
+}
+
+void sumarAlResumenHistorico(ResumenHistorico& resumen, const RegistroHistorico& registro, double ganancia) {
+    if (registro.clase == ClaseHistorico::Retirado) {
+        resumen.retirados++;
+        return;
+    }
+    int tipo = static_cast<int>(registro.tipo);
+    resumen.archivadosPorTipo[tipo]++;
+    resumen.gananciaArchivada[tipo] += ganancia;
+}
+
+// Se llama con el carro todavía armado, antes de desarmarlo
+void InventarioPlanta::registrarRetiroEnHistorico(const Carro* carro) {
+    if (!archivoHistorico.abierto()) {
+        return;
+    }
+    RegistroHistorico registro = registroHistorico(*carro, ClaseHistorico::Retirado);
+    agregarAlHistorico(registro);
+    sumarAlResumenHistorico(totalesHistorico, registro, 0);
+}
+
+CarrosArchivados InventarioPlanta::archivarCarrosAnteriores(Fecha corte) {
+    CarrosArchivados archivados;
+    if (!archivoHistorico.abierto()) {
+        archivados.resultado = Resultado::SinArchivoHistorico;
+        return archivados;
+    }
+
+    // Desde el final, para que el carro que ocupa el lugar del archivado ya esté revisado
+    size_t codigosAnteriores = codigosArchivados.size();
+    for (size_t i = carrosEnsamblados.size(); i-- > 0;) {
+        Carro* carro = carrosEnsamblados[i];
+        if (!(carro->getFechaSalida() < corte)) {
+            continue;
+        }
+        RegistroHistorico registro = registroHistorico(*carro, ClaseHistorico::Archivado);
+        double ganancia = calcularGanancia(*carro);
+        agregarAlHistorico(registro);
+        sumarAlResumenHistorico(totalesHistorico, registro, ganancia);
+        archivados.carros++;
+        archivados.ganancia += ganancia;
+
+        // El carro y su motor salen de la planta; la producción por fecha los sigue contando
+        agregados.quitar(carro);
+        Motor* motor = carro->getMotor();
+        CalidadEspecialista& calidad = especialistas.calidad(motor->getEntradaEspecialista());
+        calidad.motores--;
+        calidad.reensamblados -= motor->getVecesReensamblado();
+        codigosArchivados.push_back(motor->getCodigo());
+        indiceMotores.erase(motor->getCodigo());
+        quitarCarroEnsamblado(i);
+        destruirCarro(carro);
+        destruirMotor(motor);
+    }
+    std::sort(codigosArchivados.begin() + codigosAnteriores, codigosArchivados.end());
+    std::inplace_merge(codigosArchivados.begin(), codigosArchivados.begin() + codigosAnteriores,
+                       codigosArchivados.end());
+
+    if (verificarAgregadosSiempre) {
+        verificarAgregados();
+    }
+    registrarArchivoEnDiario(corte);
+    return archivados;
+}
+
+ResumenHistorico InventarioPlanta::resumenHistorico() const {
+    ResumenHistorico resumen = totalesHistorico;
+    resumen.abierto = archivoHistorico.abierto();
+    resumen.registros = archivoHistorico.getRegistros();
+    resumen.bytes = archivoHistorico.getBytes();
+    return resumen;
+}
+
+// Recalcula los totales y los códigos reservados leyendo todo el archivo, y vuelve a contar en la
+// producción por fecha los carros archivados antes de la instantánea (los archivados al reproducir el
+// diario estaban en la instantánea y ya se contaron)
+bool InventarioPlanta::cargarTotalesHistorico(uint64_t registrosInstantanea) {
+    totalesHistorico = {};
+    codigosArchivados.clear();
+    bool correcto = archivoHistorico.recorrer(INT32_MIN, INT32_MAX, [&](const RegistroHistorico& registro, uint64_t numero) {
+        double ganancia = 0;
+        if (registro.clase == ClaseHistorico::Archivado) {
+            ganancia = visitarRegistroHistorico(registro, [](const Carro& carro) { return calcularGanancia(carro); });
+            codigosArchivados.push_back(registro.codigoMotor);
+            if (numero < registrosInstantanea) {
+                produccionCarros.agregar(registro.fechaSalida, 1);
+                produccionMotores.agregar(registro.fechaMotor, 1);
+            }
+        }
+        sumarAlResumenHistorico(totalesHistorico, registro, ganancia);
+        return true;
+    });
+    std::sort(codigosArchivados.begin(), codigosArchivados.end());
+    if (!correcto) {
+        std::cout << "No se pudo leer el archivo histórico " << archivoHistorico.getRuta() << "." << std::endl;
+    }
+    return correcto;
+}
+
+// Abre el archivo histórico antes de reproducir el diario
+bool InventarioPlanta::abrirArchivoHistorico(const std::string& ruta) {
+    if (archivoHistorico.abierto()) {
+        std::cout << "Ya hay un archivo histórico abierto (" << archivoHistorico.getRuta() << ")." << std::endl;
+        return false;
+    }
+    if (!archivoHistorico.abrir(ruta)) {
+        return false;
+    }
+    if (registrosHistoricos > archivoHistorico.getRegistros()) {
+        std::cout << "Advertencia: faltan " << registrosHistoricos - archivoHistorico.getRegistros()
+                  << " registros en el archivo histórico " << ruta << "." << std::endl;
+        registrosHistoricos = archivoHistorico.getRegistros();
+    }
+    return true;
+}
+
+// Termina de abrir el archivo después de reproducir el diario. Si el estado ya existía, recorta los
+// registros que no llegaron al diario; si no (estado nuevo o --historico sin --estado), el estado
+// continúa la numeración del archivo.
+bool InventarioPlanta::conciliarArchivoHistorico(bool estadoExistente, uint64_t registrosInstantanea) {
+    if (!archivoHistorico.confirmar()) {
+        return false;
+    }
+    uint64_t enArchivo = archivoHistorico.getRegistros();
+    if (!estadoExistente) {
+        registrosHistoricos = enArchivo;
+    } else if (enArchivo > registrosHistoricos) {
+        if (!archivoHistorico.recortar(registrosHistoricos)) {
+            return false;
+        }
+        std::cout << "Se descartaron " << enArchivo - registrosHistoricos
+                  << " registros del archivo histórico que no llegaron al diario." << std::endl;
+    }
+    return cargarTotalesHistorico(registrosInstantanea);
+}
+
+bool InventarioPlanta::recortarHistorico(uint64_t registros) {
+    return !archivoHistorico.abierto() || archivoHistorico.recortar(registros);
+}
+
+// Importación masiva de motores y pedidos de carros
+//
+// Formato del archivo: un registro por línea, campos separados por comas; las líneas vacías
+// y las que empiezan con '#' se ignoran.
+//   MOTOR,ALTA,codigo,fechaSalida,especialista,vecesReensamblado,maxRPM,consumo
+//   MOTOR,FUERZA,codigo,fechaSalida,especialista,vecesReensamblado,caballosFuerza
+//   MOTOR,TRABAJO,codigo,fechaSalida,especialista,vecesReensamblado,artesanal (1/0)
+//   CARRO,FORMULA1,fechaSalida,velocidad,pesoCarroceria
+//   CARRO,OMNIBUS,fechaSalida,velocidad,cantidadPuertas
+//   CARRO,SPORT,fechaSalida,velocidad,cantidadPlazas,cantidadVelocidades,cambioUniversal (1/0)
+//   CARRO,DELUJO,fechaSalida,velocidad,cantidadPlazas,costoTapiceria
+// Los pedidos de carros se atienden en el orden del archivo con los motores disponibles en ese momento,
+// aplicando las mismas reglas que el menú interactivo.
+
+const size_t TAMANO_BLOQUE_IMPORTACION = 1 << 20;    // Se lee el archivo en bloques de 1 MiB
+const int MAX_CAMPOS_IMPORTACION = 8;
+const int MAX_RECHAZOS_MOSTRADOS = 10;
+
+bool leerEntero(std::string_view campo, int& valor) {
+    auto resultado = std::from_chars(campo.data(), campo.data() + campo.size(), valor);
+    return resultado.ec == std::errc() && resultado.ptr == campo.data() + campo.size();
+}
+
+bool leerEntero(std::string_view campo, uint64_t& valor) {
+    auto resultado = std::from_chars(campo.data(), campo.data() + campo.size(), valor);
+    return resultado.ec == std::errc() && resultado.ptr == campo.data() + campo.size();
+}
+
+bool leerDecimal(std::string_view campo, double& valor) {
+    auto resultado = std::from_chars(campo.data(), campo.data() + campo.size(), valor);
+    return resultado.ec == std::errc() && resultado.ptr == campo.data() + campo.size();
+}
+
+bool leerBooleano(std::string_view campo, bool& valor) {
+    if (campo == "1") {
+        valor = true;
+    } else if (campo == "0") {
+        valor = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Separa los campos de un registro; devuelve la cantidad, o -1 si son más de MAX_CAMPOS_IMPORTACION
+int separarCampos(std::string_view linea, std::string_view campos[MAX_CAMPOS_IMPORTACION]) {
+    int cantidadCampos = 0;
+    while (true) {
+        size_t coma = linea.find(',');
+        if (cantidadCampos == MAX_CAMPOS_IMPORTACION) {
+            return -1;
+        }
+        campos[cantidadCampos++] = linea.substr(0, coma);
+        if (coma == std::string_view::npos) {
+            return cantidadCampos;
+        }
+        linea.remove_prefix(coma + 1);
+    }
+}
+
+// Lee los campos de un registro CARRO; devuelve nullptr si son válidos o el motivo del rechazo
+const char* leerPedidoCarro(const std::string_view campos[], int cantidadCampos, PedidoCarro& pedido) {
+    const char* formatoInvalido = "formato inválido";
+    if (cantidadCampos < 4 || !leerDecimal(campos[3], pedido.velocidad)) {
+        return formatoInvalido;
+    }
+    pedido.fechaSalida = campos[2];
+
+    if (campos[1] == "FORMULA1") {
+        pedido.tipo = TipoCarro::Formula1;
+        if (cantidadCampos != 5 || !leerDecimal(campos[4], pedido.pesoCarroceria)) {
+            return formatoInvalido;
+        }
+    } else if (campos[1] == "OMNIBUS") {
+        pedido.tipo = TipoCarro::Omnibus;
+        if (cantidadCampos != 5 || !leerEntero(campos[4], pedido.cantidadPuertas)) {
+            return formatoInvalido;
+        }
+    } else if (campos[1] == "SPORT") {
+        pedido.tipo = TipoCarro::Sport;
+        if (cantidadCampos != 7 || !leerEntero(campos[4], pedido.cantidadPlazas) ||
+            !leerEntero(campos[5], pedido.cantidadVelocidades) || !leerBooleano(campos[6], pedido.cambioUniversal)) {
+            return formatoInvalido;
+        }
+    } else if (campos[1] == "DELUJO") {
+        pedido.tipo = TipoCarro::DeLujo;
+        if (cantidadCampos != 6 || !leerEntero(campos[4], pedido.cantidadPlazas) ||
+            !leerDecimal(campos[5], pedido.costoTapiceria)) {
+            return formatoInvalido;
+        }
+    } else {
+        return "tipo de carro inválido";
+    }
+    return nullptr;
+}
+
+// Procesa un registro; devuelve nullptr si se cargó o el motivo del rechazo
+const char* InventarioPlanta::importarRegistro(std::string_view linea, ResumenImportacion& resumen) {
+    std::string_view campos[MAX_CAMPOS_IMPORTACION];
+    int cantidadCampos = separarCampos(linea, campos);
+    if (cantidadCampos < 0) {
+        return "demasiados campos";
+    }
+
+    const char* formatoInvalido = "formato inválido";
+    Resultado resultado;
+
+    if (campos[0] == "MOTOR") {
+        DatosMotor motor;
+        if (cantidadCampos < 6 || !leerEntero(campos[5], motor.vecesReensamblado)) {
+            return formatoInvalido;
+        }
+        motor.codigo = campos[2];
+        motor.fechaSalida = campos[3];
+        motor.especialista = campos[4];
+
+        if (campos[1] == "ALTA") {
+            motor.tipo = TipoMotor::Alta;
+            if (cantidadCampos != 8 || !leerDecimal(campos[6], motor.maxRPM) || !leerDecimal(campos[7], motor.consumo)) {
+                return formatoInvalido;
+            }
+        } else if (campos[1] == "FUERZA") {
+            motor.tipo = TipoMotor::Fuerza;
+            if (cantidadCampos != 7 || !leerEntero(campos[6], motor.caballosFuerza)) {
+                return formatoInvalido;
+            }
+        } else if (campos[1] == "TRABAJO") {
+            motor.tipo = TipoMotor::Trabajo;
+            if (cantidadCampos != 7 || !leerBooleano(campos[6], motor.artesanal)) {
+                return formatoInvalido;
+            }
+        } else {
+            return "tipo de motor inválido";
+        }
+
+        resultado = agregarMotor(motor);
+        if (resultado != Resultado::Exito) {
+            return mensajeResultado(resultado);
+        }
+        resumen.motoresCargados++;
+        return nullptr;
+    }
+
+    if (campos[0] == "CARRO") {
+        PedidoCarro pedido;
+        const char* motivo = leerPedidoCarro(campos, cantidadCampos, pedido);
+        if (motivo) {
+            return motivo;
+        }
+
+        resultado = ensamblarCarro(pedido);
+        if (resultado != Resultado::Exito) {
+            return mensajeResultado(resultado);
+        }
+        resumen.carrosCargados++;
+        return nullptr;
+    }
+
+    return "tipo de registro inválido";
+}
+
+ResumenImportacion InventarioPlanta::importarArchivo(const std::string& ruta) {
+    ResumenImportacion resumen;
+
+    FILE* archivo = std::fopen(ruta.c_str(), "rb");
+    if (!archivo) {
+        return resumen;
+    }
+    resumen.abierto = true;
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<char> bloque(TAMANO_BLOQUE_IMPORTACION);
+    size_t pendientes = 0;    // Bytes de una línea incompleta al inicio del bloque
+    long numeroLinea = 0;
+    bool finArchivo = false;
+
+    while (!finArchivo) {
+        if (pendientes == bloque.size()) {
+            bloque.resize(bloque.size() * 2);    // Línea más larga que el bloque
+        }
+        size_t leidos = std::fread(bloque.data() + pendientes, 1, bloque.size() - pendientes, archivo);
+        finArchivo = leidos == 0;
+        size_t total = pendientes + leidos;
+
+        const char* cursor = bloque.data();
+        const char* fin = bloque.data() + total;
+        while (cursor < fin) {
+            const char* salto = static_cast<const char*>(std::memchr(cursor, '\n', fin - cursor));
+            if (!salto && !finArchivo) {
+                break;    // La línea continúa en el siguiente bloque
+            }
+            const char* finLinea = salto ? salto : fin;
+
+            std::string_view linea(cursor, finLinea - cursor);
+            if (!linea.empty() && linea.back() == '\r') {
+                linea.remove_suffix(1);
+            }
+            numeroLinea++;
+
+            if (!linea.empty() && linea[0] != '#') {
+                const char* motivo = importarRegistro(linea, resumen);
+                if (motivo) {
+                    if (resumen.rechazados < MAX_RECHAZOS_MOSTRADOS) {
+                        resumen.primerosRechazos.push_back("Línea " + std::to_string(numeroLinea) +
+                                                           " rechazada: " + motivo);
+                    }
+                    resumen.rechazados++;
+                }
+            }
+            cursor = finLinea + (salto ? 1 : 0);
+        }
+
+        pendientes = fin - cursor;
+        std::memmove(bloque.data(), cursor, pendientes);
+    }
+    std::fclose(archivo);
+
+    resumen.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    return resumen;
+}
+
+// Lee un lote de pedidos: registros CARRO con el formato del archivo de importación. Devuelve false si no
+// se pudo abrir; los registros con errores de formato se cuentan en rechazados y no entran al lote.
+bool leerLotePedidos(const std::string& ruta, std::vector<PedidoCarro>& pedidos, long& rechazados) {
+    FILE* archivo = std::fopen(ruta.c_str(), "r");
+    if (!archivo) {
+        return false;
+    }
+    char* linea = nullptr;
+    size_t capacidad = 0;
+    ssize_t longitud;
+    while ((longitud = getline(&linea, &capacidad, archivo)) >= 0) {
+        std::string_view registro(linea, static_cast<size_t>(longitud));
+        while (!registro.empty() && (registro.back() == '\n' || registro.back() == '\r')) {
+            registro.remove_suffix(1);
+        }
+        if (registro.empty() || registro[0] == '#') {
+            continue;
+        }
+        std::string_view campos[MAX_CAMPOS_IMPORTACION];
+        int cantidadCampos = separarCampos(registro, campos);
+        PedidoCarro pedido;
+        if (cantidadCampos < 0 || campos[0] != "CARRO" || leerPedidoCarro(campos, cantidadCampos, pedido)) {
+            rechazados++;
+            continue;
+        }
+        pedidos.push_back(std::move(pedido));
+    }
+    std::free(linea);
+    std::fclose(archivo);
+    return true;
+}
+
+// Grabación y reproducción de la carga de trabajo
+// Con --grabar traza, cada operación que el menú o los clientes del servicio piden a InventarioPlanta se
+// anota con sus datos de entrada y el momento en que empezó: altas de motores, pedidos de carros y lotes,
+// bajas, archivos de carros antiguos y cada consulta o reporte (también los del servicio que se arman
+// sobre el espejo de carros). La importación se graba como las altas y ensamblajes que la componen, así
+// que la traza no depende del archivo importado. La grabación empieza con el menú o el servicio, después
+// de las opciones de inicio.
+//
+// --reproducir traza ejecuta las operaciones en el orden grabado, de a una, contra el motor de la planta:
+// lo más rápido posible o, con --ritmo, a los tiempos grabados (divididos por el factor: 2 va al doble de
+// velocidad). Los reportes se escriben completos en formato de texto a /dev/null, y las escrituras se
+// confirman en el diario si hay uno abierto, como en el menú. La reproducción es determinista si parte del
+// mismo estado que la grabación: las mismas opciones de inicio, o una copia de la instantánea de --estado.
+// Al terminar muestra los percentiles de latencia de cada operación.
+//
+// Formato (versión 1):
+//   Cabecera:  magia "PLNTTRAZ", versión (u32)
+//   Registros: longitud del contenido y contenido: nanosegundos desde el registro anterior, operación (u8)
+//              y sus datos
+//   Datos:     motor: tipo (u8), código, fechaSalida, especialista, vecesReensamblado y, según el tipo,
+//              maxRPM y consumo (f64), caballosFuerza o artesanal (u8)
+//              pedido: tipo (u8), fechaSalida, velocidad (f64) y, según el tipo, pesoCarroceria (f64),
+//              cantidadPuertas, cantidadPlazas, cantidadVelocidades y cambioUniversal (u8), o
+//              cantidadPlazas y costoTapiceria (f64); un lote lleva la cantidad de pedidos y los pedidos
+//              baja: código del motor; fechas: días desde el 01/01/1970
+//              clasificación: clase (u8), k y el tipo de carro (u8, 0 = todos, o el tipo más uno) o de motor
+// Los enteros van en base 128 (en zigzag los que pueden ser negativos) y las cadenas como en la
+// instantánea. La traza se escribe en bloques de TAMANO_BLOQUE_TRAZA sin sincronizar con el disco: si la
+// planta se cae se pierde lo último grabado, y un registro incompleto al final se descarta al reproducir.
+
+void escribirCampoTraza(EscritorBinario& escritor, const DatosMotor& motor) {
+    escritor.valor<uint8_t>(static_cast<uint8_t>(motor.tipo));
+    escritor.cadena(motor.codigo);
+    escritor.cadena(motor.fechaSalida);
+    escritor.cadena(motor.especialista);
+    escritor.varint(codificarZigzag(motor.vecesReensamblado));
+    switch (motor.tipo) {
+        case TipoMotor::Alta:
+            escritor.valor<double>(motor.maxRPM);
+            escritor.valor<double>(motor.consumo);
+            break;
+        case TipoMotor::Fuerza:
+            escritor.varint(codificarZigzag(motor.caballosFuerza));
+            break;
+        default:
+            escritor.valor<uint8_t>(motor.artesanal);
+            break;
+    }
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, const PedidoCarro& pedido) {
+    escritor.valor<uint8_t>(static_cast<uint8_t>(pedido.tipo));
+    escritor.cadena(pedido.fechaSalida);
+    escritor.valor<double>(pedido.velocidad);
+    switch (pedido.tipo) {
+        case TipoCarro::Formula1:
+            escritor.valor<double>(pedido.pesoCarroceria);
+            break;
+        case TipoCarro::Omnibus:
+            escritor.varint(codificarZigzag(pedido.cantidadPuertas));
+            break;
+        case TipoCarro::Sport:
+            escritor.varint(codificarZigzag(pedido.cantidadPlazas));
+            escritor.varint(codificarZigzag(pedido.cantidadVelocidades));
+            escritor.valor<uint8_t>(pedido.cambioUniversal);
+            break;
+        default:
+            escritor.varint(codificarZigzag(pedido.cantidadPlazas));
+            escritor.valor<double>(pedido.costoTapiceria);
+            break;
+    }
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, const std::vector<PedidoCarro>& pedidos) {
+    escritor.varint(pedidos.size());
+    for (const PedidoCarro& pedido : pedidos) {
+        escribirCampoTraza(escritor, pedido);
+    }
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, std::string_view texto) {
+    escritor.cadena(texto);
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, Fecha fecha) {
+    escritor.varint(codificarZigzag(fecha.getDia()));
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, int valor) {
+    escritor.varint(codificarZigzag(valor));
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, size_t valor) {
+    escritor.varint(valor);
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, std::optional<TipoCarro> tipo) {
+    escritor.valor<uint8_t>(tipo ? static_cast<uint8_t>(*tipo) + 1 : 0);
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, TipoMotor tipo) {
+    escritor.valor<uint8_t>(static_cast<uint8_t>(tipo));
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, ClaseHistorico clase) {
+    escritor.valor<uint8_t>(static_cast<uint8_t>(clase));
+}
+
+void escribirCampoTraza(EscritorBinario& escritor, ClasificacionTrazada clasificacion) {
+    escritor.valor<uint8_t>(static_cast<uint8_t>(clasificacion));
+}
+
+// Los hilos del servicio graban a la vez: los datos se codifican fuera del mutex y el registro se agrega
+// con él tomado, así los tiempos de la traza quedan en orden
+class GrabadorTraza {
+private:
+    int descriptor = -1;
+    std::mutex mutex;
+    EscritorBinario pendiente;
+    std::chrono::steady_clock::time_point anterior;
+    uint64_t registros = 0;
+    uint64_t bytes = 0;    // Escritos en el archivo
+    bool correcto = true;
+
+    void volcar() {
+        const std::string& datos = pendiente.contenido();
+        size_t escritos = 0;
+        while (escritos < datos.size()) {
+            ssize_t n = write(descriptor, datos.data() + escritos, datos.size() - escritos);
+            if (n <= 0) {
+                correcto = false;
+                break;
+            }
+            escritos += n;
+        }
+        bytes += escritos;
+        pendiente.recortar(0);
+    }
+
+public:
+    bool abrir(const std::string& ruta) {
+        descriptor = open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (descriptor < 0) {
+            return false;
+        }
+        pendiente.contenido().append(MAGIA_TRAZA, sizeof(MAGIA_TRAZA));
+        pendiente.valor<uint32_t>(VERSION_TRAZA);
+        anterior = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void agregar(OperacionPlanta operacion, const std::string& datos) {
+        std::lock_guard<std::mutex> bloqueo(mutex);
+        if (descriptor < 0) {
+            return;
+        }
+        auto ahora = std::chrono::steady_clock::now();
+        EscritorBinario tiempo;
+        tiempo.varint(std::chrono::duration_cast<std::chrono::nanoseconds>(ahora - anterior).count());
+        anterior = ahora;
+
+        pendiente.varint(tiempo.tamano() + 1 + datos.size());
+        pendiente.contenido() += tiempo.contenido();
+        pendiente.valor<uint8_t>(static_cast<uint8_t>(operacion));
+        pendiente.contenido() += datos;
+        registros++;
+        if (pendiente.tamano() >= TAMANO_BLOQUE_TRAZA) {
+            volcar();
+        }
+    }
+
+    // Escribe lo pendiente y cierra el archivo; devuelve false si alguna escritura falló
+    bool cerrar() {
+        std::lock_guard<std::mutex> bloqueo(mutex);
+        if (descriptor < 0) {
+            return correcto;
+        }
+        volcar();
+        close(descriptor);
+        descriptor = -1;
+        return correcto;
+    }
+
+    uint64_t getRegistros() const { return registros; }
+    uint64_t getBytes() const { return bytes; }
+};
+
+GrabadorTraza grabadorTraza;
+
+void agregarRegistroTraza(OperacionPlanta operacion, const std::string& datos) {
+    grabadorTraza.agregar(operacion, datos);
+}
+
+bool iniciarGrabacionTraza() {
+    if (archivoTraza.empty()) {
+        return true;
+    }
+    if (!grabadorTraza.abrir(archivoTraza)) {
+        std::cout << "No se pudo crear la traza " << archivoTraza << "." << std::endl;
+        return false;
+    }
+    grabandoTraza = true;
+    return true;
+}
+
+void terminarGrabacionTraza() {
+    if (!grabandoTraza) {
+        return;
+    }
+    grabandoTraza = false;
+    if (grabadorTraza.cerrar()) {
+        std::cout << "Traza guardada en " << archivoTraza << " (" << grabadorTraza.getRegistros() << " operaciones, "
+                  << grabadorTraza.getBytes() << " bytes)." << std::endl;
+    } else {
+        std::cout << "No se pudo escribir la traza " << archivoTraza << "." << std::endl;
+    }
+}
+
@@ -0,0 +1,3021 @@
+#ifndef INVENTARIO_PLANTA_H
+#define INVENTARIO_PLANTA_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <chrono>
+#include <string_view>
+#include <cstddef>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <deque>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <new>
+#include <cstdlib>
+#include <cstdarg>
+#include <optional>
+#include <mutex>
+#include <shared_mutex>
+#include <variant>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Tipos concretos de motores y carros
+// Ambas jerarquías son cerradas: cada objeto guarda su tipo y se despacha con visitarMotor/visitarCarro
+// (un switch y static_cast) en lugar de dynamic_cast.
+
+enum class TipoMotor : unsigned char { Alta, Fuerza, Trabajo };
+enum class TipoCarro : unsigned char { Formula1, Omnibus, Sport, DeLujo };
+const int CANTIDAD_TIPOS_CARRO = 4;
+
+// Combina varias lambdas en un solo visitante
+template <typename... Lambdas>
+struct Sobrecarga : Lambdas... {
+    using Lambdas::operator()...;
+};
+template <typename... Lambdas>
+Sobrecarga(Lambdas...) -> Sobrecarga<Lambdas...>;
+
+const char* nombreTipoMotor(TipoMotor tipo);
+
+const char* nombreTipoCarro(TipoCarro tipo);
+
+// Escritura de reportes
+// Las fichas técnicas se describen campo por campo a un EscritorReporte, que las formatea en un búfer
+// reutilizable y lo escribe al destino (pantalla o archivo) en bloques grandes. El formato de texto
+// reproduce la presentación original; CSV y JSON sirven para procesar los reportes con otras herramientas.
+// La paginación (desde/límite) cuenta fichas completas.
+
+enum class FormatoReporte { Texto, CSV, JSON };
+
+// Fichas de un listado que quedan dentro de la paginación: [inicio, fin). fichaBase es la cantidad de
+// fichas vistas antes del listado y primera indica si todavía no se escribió ninguna ficha.
+struct ReservaFichas {
+    size_t inicio = 0;
+    size_t fin = 0;
+    long fichaBase = 0;
+    bool primera = true;
+};
+
+struct ConfiguracionReporte {
+    FormatoReporte formato = FormatoReporte::Texto;
+    std::string archivo;    // Vacío: pantalla
+    long desde = 0;         // Fichas a omitir al inicio
+    long limite = 0;        // Máximo de fichas (0: sin límite)
+};
+
+class EscritorReporte {
+private:
+    static const size_t TAMANO_VOLCADO = 64 * 1024;
+    static const int MAX_PROFUNDIDAD = 4;
+
+    FormatoReporte formato;
+    FILE* destino;
+    bool cerrarDestino = false;
+    std::string bufer;
+
+    long desde;
+    long limite;
+    long fichasVistas = 0;
+    long fichasEscritas = 0;
+    bool truncado = false;
+
+    // Estado del formato estructurado
+    const char* tipoFicha = "";
+    const char* seccion = "";
+    int profundidad = 0;
+    bool primerElemento[MAX_PROFUNDIDAD] = {true};
+
+    void agregarNumero(double valor) {
+        char texto[32];
+        int longitud = std::snprintf(texto, sizeof(texto), formato == FormatoReporte::Texto ? "%g" : "%.15g", valor);
+        bufer.append(texto, longitud);
+    }
+
+    void agregarEntero(long valor) {
+        char texto[24];
+        auto resultado = std::to_chars(texto, texto + sizeof(texto), valor);
+        bufer.append(texto, resultado.ptr - texto);
+    }
+
+    void agregarJSON(std::string_view texto) {
+        bufer += '"';
+        for (char c : texto) {
+            if (c == '"' || c == '\\') {
+                bufer += '\\';
+                bufer += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                bufer += escape;
+            } else {
+                bufer += c;
+            }
+        }
+        bufer += '"';
+    }
+
+    void agregarCSV(std::string_view texto) {
+        if (texto.find_first_of(",\"\n") == std::string_view::npos) {
+            bufer.append(texto);
+            return;
+        }
+        bufer += '"';
+        for (char c : texto) {
+            if (c == '"') {
+                bufer += '"';
+            }
+            bufer += c;
+        }
+        bufer += '"';
+    }
+
+    void separarElementoJSON() {
+        if (!primerElemento[profundidad]) {
+            bufer += ',';
+        }
+        primerElemento[profundidad] = false;
+    }
+
+    // Escribe un campo con la presentación del formato; escribirValor agrega solo el valor
+    template <typename EscribirValor>
+    void escribirCampo(const char* etiqueta, const char* clave, const char* unidad, EscribirValor escribirValor) {
+        switch (formato) {
+            case FormatoReporte::Texto:
+                bufer += etiqueta;
+                bufer += ": ";
+                escribirValor();
+                if (*unidad) {
+                    bufer += ' ';
+                    bufer += unidad;
+                }
+                bufer += '\n';
+                break;
+            case FormatoReporte::CSV:
+                agregarEntero(fichasVistas);
+                bufer += ',';
+                bufer += tipoFicha;
+                bufer += ',';
+                bufer += seccion;
+                bufer += ',';
+                bufer += clave;
+                bufer += ',';
+                escribirValor();
+                bufer += '\n';
+                break;
+            case FormatoReporte::JSON:
+                separarElementoJSON();
+                agregarJSON(clave);
+                bufer += ':';
+                escribirValor();
+                break;
+        }
+        if (bufer.size() >= TAMANO_VOLCADO) {
+            volcar();
+        }
+    }
+
+public:
+    // Sin archivo en la configuración, el reporte se escribe en pantalla (la salida estándar, o el flujo que
+    // la reemplace, como la conexión de un cliente del servicio)
+    explicit EscritorReporte(const ConfiguracionReporte& configuracion = ConfiguracionReporte(), FILE* pantalla = stdout)
+        : formato(configuracion.formato), destino(pantalla), desde(configuracion.desde), limite(configuracion.limite) {
+        bufer.reserve(TAMANO_VOLCADO + 4096);
+        if (!configuracion.archivo.empty()) {
+            FILE* archivo = std::fopen(configuracion.archivo.c_str(), "w");
+            if (archivo) {
+                destino = archivo;
+                cerrarDestino = true;
+            } else {
+                std::cout << "No se pudo abrir " << configuracion.archivo << "; se usará la pantalla." << std::endl;
+            }
+        }
+        if (formato == FormatoReporte::CSV) {
+            bufer += "ficha,tipo,seccion,campo,valor\n";
+        } else if (formato == FormatoReporte::JSON) {
+            bufer += '[';
+        }
+    }
+
+    // Fragmento de un listado que se formatea aparte (por ejemplo en otro hilo) y luego se agrega al
+    // reporte con agregarFragmento; su primera ficha es la ficha número primeraFicha del listado reservado
+    EscritorReporte(const EscritorReporte& reporte, const ReservaFichas& reserva, size_t primeraFicha)
+        : formato(reporte.formato), destino(nullptr), desde(0), limite(0),
+          fichasVistas(reserva.fichaBase + static_cast<long>(primeraFicha)) {
+        primerElemento[0] = reserva.primera && primeraFicha == reserva.inicio;
+    }
+
+    EscritorReporte(const EscritorReporte&) = delete;
+    EscritorReporte& operator=(const EscritorReporte&) = delete;
+
+    ~EscritorReporte() {
+        terminar();
+    }
+
+    bool escribeEnArchivo() const { return cerrarDestino; }
+    bool limiteAlcanzado() const { return limite > 0 && fichasEscritas >= limite; }
+    FormatoReporte getFormato() const { return formato; }
+    std::string& contenido() { return bufer; }
+
+    // Aplica la paginación a las siguientes cantidad fichas de un listado, como si se escribieran una a
+    // una, y devuelve las que deben escribirse
+    ReservaFichas reservarFichas(size_t cantidad) {
+        ReservaFichas reserva;
+        reserva.fichaBase = fichasVistas;
+        reserva.primera = fichasEscritas == 0;
+        reserva.inicio = std::min(cantidad, static_cast<size_t>(std::max(0L, desde - fichasVistas)));
+        reserva.fin = cantidad;
+        if (limite > 0) {
+            size_t restantes = static_cast<size_t>(std::max(0L, limite - fichasEscritas));
+            if (reserva.fin - reserva.inicio > restantes) {
+                reserva.fin = reserva.inicio + restantes;
+                truncado = true;
+            }
+        }
+        fichasVistas += static_cast<long>(reserva.fin);
+        fichasEscritas += static_cast<long>(reserva.fin - reserva.inicio);
+        if (reserva.fin > reserva.inicio) {
+            primerElemento[0] = false;
+        }
+        return reserva;
+    }
+
+    void agregarFragmento(const std::string& fragmento) {
+        volcar();
+        std::fwrite(fragmento.data(), 1, fragmento.size(), destino);
+    }
+
+    // Comienza una ficha; devuelve false si la paginación la omite (en ese caso no se llama a terminarFicha)
+    bool iniciarFicha(const char* tipo) {
+        if (limiteAlcanzado()) {
+            truncado = true;
+            return false;
+        }
+        if (fichasVistas++ < desde) {
+            return false;
+        }
+        fichasEscritas++;
+        tipoFicha = tipo;
+        seccion = "";
+        if (formato == FormatoReporte::JSON) {
+            separarElementoJSON();
+            bufer += "\n{";
+            profundidad = 1;
+            primerElemento[profundidad] = true;
+            campo("Tipo", "tipo", tipo);
+        }
+        return true;
+    }
+
+    void terminarFicha() {
+        if (formato == FormatoReporte::JSON) {
+            bufer += '}';
+            profundidad = 0;
+        }
+        if (bufer.size() >= TAMANO_VOLCADO) {
+            volcar();
+        }
+    }
+
+    void abrirSeccion(const char* titulo, const char* clave) {
+        if (formato == FormatoReporte::Texto) {
+            bufer += titulo;
+            bufer += '\n';
+        } else if (formato == FormatoReporte::CSV) {
+            seccion = clave;
+        } else if (profundidad + 1 < MAX_PROFUNDIDAD) {
+            separarElementoJSON();
+            agregarJSON(clave);
+            bufer += ":{";
+            primerElemento[++profundidad] = true;
+        }
+    }
+
+    void cerrarSeccion() {
+        if (formato == FormatoReporte::CSV) {
+            seccion = "";
+        } else if (formato == FormatoReporte::JSON && profundidad > 1) {
+            bufer += '}';
+            profundidad--;
+        }
+    }
+
+    void campo(const char* etiqueta, const char* clave, std::string_view valor, const char* unidad = "") {
+        escribirCampo(etiqueta, clave, unidad, [&] {
+            if (formato == FormatoReporte::Texto) {
+                bufer.append(valor);
+            } else if (formato == FormatoReporte::CSV) {
+                agregarCSV(valor);
+            } else {
+                agregarJSON(valor);
+            }
+        });
+    }
+
+    void campo(const char* etiqueta, const char* clave, const char* valor, const char* unidad = "") {
+        campo(etiqueta, clave, std::string_view(valor), unidad);
+    }
+
+    void campo(const char* etiqueta, const char* clave, double valor, const char* unidad = "") {
+        escribirCampo(etiqueta, clave, unidad, [&] {
+            if (formato == FormatoReporte::JSON && !std::isfinite(valor)) {
+                bufer += "null";
+            } else {
+                agregarNumero(valor);
+            }
+        });
+    }
+
+    void campo(const char* etiqueta, const char* clave, int valor, const char* unidad = "") {
+        escribirCampo(etiqueta, clave, unidad, [&] { agregarEntero(valor); });
+    }
+
+    void campo(const char* etiqueta, const char* clave, bool valor, const char* unidad = "") {
+        escribirCampo(etiqueta, clave, unidad, [&] {
+            if (formato == FormatoReporte::Texto) {
+                bufer += valor ? "Sí" : "No";
+            } else {
+                bufer += valor ? "true" : "false";
+            }
+        });
+    }
+
+    // Línea libre (títulos y separadores); solo aparece en el formato de texto
+    void texto(std::string_view linea) {
+        if (formato == FormatoReporte::Texto) {
+            bufer.append(linea);
+            bufer += '\n';
+        }
+    }
+
+    void separador() {
+        texto("---------------------------");
+    }
+
+    void volcar() {
+        if (destino && !bufer.empty()) {
+            std::fwrite(bufer.data(), 1, bufer.size(), destino);
+            bufer.clear();
+        }
+    }
+
+    void terminar() {
+        if (!destino) {
+            return;
+        }
+        if (formato == FormatoReporte::JSON) {
+            bufer += "\n]\n";
+        } else if (truncado) {
+            texto("(Se alcanzó el límite de fichas del reporte)");
+        }
+        volcar();
+        if (cerrarDestino) {
+            std::fclose(destino);
+        } else {
+            std::fflush(destino);
+        }
+        destino = nullptr;
+    }
+};
+
+extern ConfiguracionReporte configuracionReporte;
+
+
+// Códigos de motor y fechas
+// El código de un motor tiene siempre 12 caracteres y se guarda dentro del propio motor, sin memoria
+// dinámica; se compara y se resume con dos lecturas de 8 y 4 bytes. Las fechas "DD/MM/AAAA" se
+// convierten una sola vez a un número de día (días desde el 01/01/1970), que ocupa 4 bytes y se compara
+// directamente. Ambos vuelven a texto solo al mostrarse o guardarse.
+
+const size_t LONGITUD_CODIGO_MOTOR = 12;
+const size_t LONGITUD_FECHA = 10;    // DD/MM/AAAA
+
+class CodigoMotor {
+private:
+    char caracteres[LONGITUD_CODIGO_MOTOR] = {};
+
+    uint64_t parteAlta() const {
+        uint64_t parte;
+        std::memcpy(&parte, caracteres, sizeof(parte));
+        return parte;
+    }
+
+    uint32_t parteBaja() const {
+        uint32_t parte;
+        std::memcpy(&parte, caracteres + sizeof(uint64_t), sizeof(parte));
+        return parte;
+    }
+
+public:
+    // Devuelve false si el texto no tiene exactamente 12 caracteres
+    static bool desdeTexto(std::string_view texto, CodigoMotor& codigo) {
+        if (texto.size() != LONGITUD_CODIGO_MOTOR) {
+            return false;
+        }
+        std::memcpy(codigo.caracteres, texto.data(), LONGITUD_CODIGO_MOTOR);
+        return true;
+    }
+
+    std::string_view vista() const { return std::string_view(caracteres, LONGITUD_CODIGO_MOTOR); }
+    std::string texto() const { return std::string(vista()); }
+
+    size_t resumen() const {
+        uint64_t h = parteAlta() * 0x9E3779B97F4A7C15ULL ^ parteBaja();
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    bool operator==(const CodigoMotor& otro) const {
+        return parteAlta() == otro.parteAlta() && parteBaja() == otro.parteBaja();
+    }
+    bool operator!=(const CodigoMotor& otro) const { return !(*this == otro); }
+    bool operator<(const CodigoMotor& otro) const {
+        return std::memcmp(caracteres, otro.caracteres, LONGITUD_CODIGO_MOTOR) < 0;
+    }
+};
+
+struct ResumenCodigoMotor {
+    size_t operator()(const CodigoMotor& codigo) const { return codigo.resumen(); }
+};
+
+class Fecha {
+private:
+    int32_t dia = 0;    // Días desde el 01/01/1970
+
+    static bool bisiesto(int anio) { return (anio % 4 == 0 && anio % 100 != 0) || anio % 400 == 0; }
+
+    static int diasDelMes(int mes, int anio) {
+        static const int dias[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        return mes == 2 && bisiesto(anio) ? 29 : dias[mes - 1];
+    }
+
+public:
+    // Conversión entre fecha civil y número de día (algoritmo de H. Hinnant)
+    static Fecha desdeCivil(int diaMes, int mes, int anio) {
+        anio -= mes <= 2;
+        int era = (anio >= 0 ? anio : anio - 399) / 400;
+        int anioEra = anio - era * 400;
+        int diaAnio = (153 * (mes + (mes > 2 ? -3 : 9)) + 2) / 5 + diaMes - 1;
+        int diaEra = anioEra * 365 + anioEra / 4 - anioEra / 100 + diaAnio;
+        Fecha fecha;
+        fecha.dia = era * 146097 + diaEra - 719468;
+        return fecha;
+    }
+
+    void aCivil(int& diaMes, int& mes, int& anio) const {
+        int z = dia + 719468;
+        int era = (z >= 0 ? z : z - 146096) / 146097;
+        int diaEra = z - era * 146097;
+        int anioEra = (diaEra - diaEra / 1460 + diaEra / 36524 - diaEra / 146096) / 365;
+        int diaAnio = diaEra - (365 * anioEra + anioEra / 4 - anioEra / 100);
+        int mesDesplazado = (5 * diaAnio + 2) / 153;
+        diaMes = diaAnio - (153 * mesDesplazado + 2) / 5 + 1;
+        mes = mesDesplazado < 10 ? mesDesplazado + 3 : mesDesplazado - 9;
+        anio = anioEra + era * 400 + (mes <= 2);
+    }
+
+    // Devuelve false si el texto no es una fecha válida con el formato DD/MM/AAAA
+    static bool desdeTexto(std::string_view texto, Fecha& fecha) {
+        if (texto.size() != LONGITUD_FECHA || texto[2] != '/' || texto[5] != '/') {
+            return false;
+        }
+        int valores[3] = {};
+        const int inicios[3] = {0, 3, 6};
+        const int longitudes[3] = {2, 2, 4};
+        for (int campo = 0; campo < 3; ++campo) {
+            for (int i = 0; i < longitudes[campo]; ++i) {
+                char c = texto[inicios[campo] + i];
+                if (c < '0' || c > '9') {
+                    return false;
+                }
+                valores[campo] = valores[campo] * 10 + (c - '0');
+            }
+        }
+        int diaMes = valores[0], mes = valores[1], anio = valores[2];
+        if (mes < 1 || mes > 12 || diaMes < 1 || diaMes > diasDelMes(mes, anio)) {
+            return false;
+        }
+        fecha = desdeCivil(diaMes, mes, anio);
+        return true;
+    }
+
+    static Fecha desdeDia(int32_t dia) {
+        Fecha fecha;
+        fecha.dia = dia;
+        return fecha;
+    }
+
+    int32_t getDia() const { return dia; }
+
+    // Escribe "DD/MM/AAAA" en destino (al menos LONGITUD_FECHA caracteres) y devuelve la vista del texto
+    std::string_view escribir(char* destino) const {
+        int diaMes, mes, anio;
+        aCivil(diaMes, mes, anio);
+        const int valores[3] = {diaMes, mes, anio};
+        const int longitudes[3] = {2, 2, 4};
+        char* cursor = destino;
+        for (int campo = 0; campo < 3; ++campo) {
+            if (campo > 0) {
+                *cursor++ = '/';
+            }
+            int valor = valores[campo];
+            for (int i = longitudes[campo] - 1; i >= 0; --i) {
+                cursor[i] = static_cast<char>('0' + valor % 10);
+                valor /= 10;
+            }
+            cursor += longitudes[campo];
+        }
+        return std::string_view(destino, LONGITUD_FECHA);
+    }
+
+    std::string texto() const {
+        char destino[LONGITUD_FECHA];
+        return std::string(escribir(destino));
+    }
+
+    bool operator==(Fecha otra) const { return dia == otra.dia; }
+    bool operator!=(Fecha otra) const { return dia != otra.dia; }
+    bool operator<(Fecha otra) const { return dia < otra.dia; }
+    bool operator<=(Fecha otra) const { return dia <= otra.dia; }
+    bool operator>(Fecha otra) const { return dia > otra.dia; }
+    bool operator>=(Fecha otra) const { return dia >= otra.dia; }
+};
+
+// Especialistas
+// Unas pocas decenas de especialistas certifican todos los motores, así que cada nombre se guarda una
+// sola vez en la tabla y el motor lleva un puntero a su entrada, cuya dirección no cambia. La tabla
+// mantiene además, de forma incremental, las estadísticas de calidad de cada especialista.
+
+struct CalidadEspecialista {
+    long motores = 0;            // Motores certificados en el inventario
+    long reensamblados = 0;      // Suma de vecesReensamblado de esos motores
+    long carrosRetirados = 0;    // Carros dados de baja que llevaban uno de sus motores
+};
+
+struct Especialista {
+    std::string nombre;
+    uint32_t numero;             // Posición en la tabla, en orden de registro
+    CalidadEspecialista calidad;
+};
+
+class TablaEspecialistas {
+private:
+    std::deque<Especialista> especialistas;                          // Direcciones estables
+    std::unordered_map<std::string_view, Especialista*> porNombre;   // Vistas de los nombres de especialistas
+
+public:
+    // Devuelve la entrada del especialista, registrándolo si es nuevo. Los lectores del servicio (ver
+    // ejecutarServidor) leen los nombres a través de los motores mientras se registran otros: agregar al
+    // final de la deque no mueve las entradas existentes.
+    const Especialista* registrar(std::string_view nombre) {
+        auto existente = porNombre.find(nombre);
+        if (existente != porNombre.end()) {
+            return existente->second;
+        }
+        especialistas.push_back({std::string(nombre), static_cast<uint32_t>(especialistas.size()), CalidadEspecialista()});
+        Especialista* especialista = &especialistas.back();
+        porNombre.emplace(especialista->nombre, especialista);
+        return especialista;
+    }
+
+    const std::string& nombre(uint32_t numero) const { return especialistas[numero].nombre; }
+    CalidadEspecialista& calidad(const Especialista* especialista) { return especialistas[especialista->numero].calidad; }
+    const CalidadEspecialista& calidad(uint32_t numero) const { return especialistas[numero].calidad; }
+    size_t size() const { return especialistas.size(); }
+
+    void clear() {
+        porNombre.clear();
+        especialistas.clear();
+    }
+};
+
+// Clases de motores
+
+class Motor {
+private:
+    TipoMotor tipo;                 // Tipo concreto del motor
+
+protected:
+    CodigoMotor codigo;             // Código único de 12 caracteres
+    Fecha fechaSalida;              // Fecha de salida del área de ensamblaje
+    int vecesReensamblado;          // Veces que ha regresado al área de ensamblaje por defectos
+    const Especialista* especialista;    // Especialista que realizó la certificación (entrada en la tabla)
+
+public:
+    // Constructor
+    Motor(TipoMotor tipo, const CodigoMotor& codigo, Fecha fechaSalida, const Especialista* especialista,
+          int vecesReensamblado)
+        : tipo(tipo), codigo(codigo), fechaSalida(fechaSalida), vecesReensamblado(vecesReensamblado),
+          especialista(especialista) {}
+
+    // Destructor virtual (los motores se liberan a través de punteros a Motor)
+    virtual ~Motor() = default;
+
+    // Métodos getters y setters
+    TipoMotor getTipo() const { return tipo; }
+
+    const CodigoMotor& getCodigo() const { return codigo; }
+    void setCodigo(const CodigoMotor& codigo) { this->codigo = codigo; }
+
+    Fecha getFechaSalida() const { return fechaSalida; }
+    void setFechaSalida(Fecha fechaSalida) { this->fechaSalida = fechaSalida; }
+
+    const std::string& getEspecialista() const { return especialista->nombre; }
+    const Especialista* getEntradaEspecialista() const { return especialista; }
+    uint32_t getNumeroEspecialista() const { return especialista->numero; }
+
+    int getVecesReensamblado() const { return vecesReensamblado; }
+    void setVecesReensamblado(int veces) { vecesReensamblado = veces; }
+
+    // Método virtual para calcular el costo (será sobreescrito en las clases derivadas)
+    virtual double calcularCosto() const = 0;
+
+    // Método virtual que describe los campos de la ficha técnica del motor
+    virtual void escribirFicha(EscritorReporte& escritor) const;
+
+    // Muestra la ficha técnica por pantalla
+    void mostrarFichaTecnica() const;
+};
+
+// Clases derivadas de Motor
+
+class MotorAlta final : public Motor {
+private:
+    double maxRPM;    // Máximas revoluciones por minuto
+    double consumo;   // Consumo en km por litro
+
+public:
+    // Constructor
+    MotorAlta(const CodigoMotor& codigo, Fecha fechaSalida, const Especialista* especialista, int vecesReensamblado,
+              double maxRPM, double consumo)
+        : Motor(TipoMotor::Alta, codigo, fechaSalida, especialista, vecesReensamblado), maxRPM(maxRPM), consumo(consumo) {}
+
+    // Métodos getters y setters
+    double getMaxRPM() const { return maxRPM; }
+    void setMaxRPM(double rpm) { maxRPM = rpm; }
+
+    double getConsumo() const { return consumo; }
+    void setConsumo(double consumo) { this->consumo = consumo; }
+
+    // Sobrescribir el método para calcular el costo
+    double calcularCosto() const override {
+        return (maxRPM * 1.5 + consumo) - 100 * vecesReensamblado;
+    }
+
+    // Cambio del costo por cada reensamblaje adicional (calcularCosto es lineal en vecesReensamblado)
+    double variacionCostoPorReensamblaje() const { return -100; }
+
+    // Sobrescribir el método para describir la ficha técnica
+    void escribirFicha(EscritorReporte& escritor) const override;
+};
+
+class MotorFuerza final : public Motor {
+private:
+    int caballosFuerza;    // Caballos de fuerza (entre 80 y 4000)
+
+public:
+    // Constructor
+    MotorFuerza(const CodigoMotor& codigo, Fecha fechaSalida, const Especialista* especialista, int vecesReensamblado,
+                int caballosFuerza)
+        : Motor(TipoMotor::Fuerza, codigo, fechaSalida, especialista, vecesReensamblado), caballosFuerza(caballosFuerza) {}
+
+    // Métodos getters y setters
+    int getCaballosFuerza() const { return caballosFuerza; }
+    void setCaballosFuerza(int caballos) { caballosFuerza = caballos; }
+
+    // Sobrescribir el método para calcular el costo
+    double calcularCosto() const override {
+        return (caballosFuerza) * (5 - 100 * vecesReensamblado);
+    }
+
+    // Cambio del costo por cada reensamblaje adicional (calcularCosto es lineal en vecesReensamblado)
+    double variacionCostoPorReensamblaje() const { return -100.0 * caballosFuerza; }
+
+    // Sobrescribir el método para describir la ficha técnica
+    void escribirFicha(EscritorReporte& escritor) const override;
+};
+
+class MotorTrabajo final : public Motor {
+private:
+    bool artesanal;    // Indica si es artesanal (true) o no (false)
+
+    // Solo el inventario cambia la condición, para mantener sus sub-pools al día
+    friend class InventarioMotoresTrabajo;
+    void setArtesanal(bool artesanal) { this->artesanal = artesanal; }
+
+public:
+    // Constructor
+    MotorTrabajo(const CodigoMotor& codigo, Fecha fechaSalida, const Especialista* especialista, int vecesReensamblado,
+                 bool artesanal)
+        : Motor(TipoMotor::Trabajo, codigo, fechaSalida, especialista, vecesReensamblado), artesanal(artesanal) {}
+
+    // Métodos getters
+    bool esArtesanal() const { return artesanal; }
+
+    // Sobrescribir el método para calcular el costo
+    double calcularCosto() const override {
+        double costo = 1000 - (100 * vecesReensamblado);
+        if (artesanal) {
+            costo *= 10;    // Aumenta su costo 10 veces si es artesanal
+        }
+        return costo;
+    }
+
+    // Cambio del costo por cada reensamblaje adicional (calcularCosto es lineal en vecesReensamblado)
+    double variacionCostoPorReensamblaje() const { return artesanal ? -1000 : -100; }
+
+    // Sobrescribir el método para describir la ficha técnica
+    void escribirFicha(EscritorReporte& escritor) const override;
+};
+
+// Clases de carros
+
+class Carro {
+private:
+    TipoCarro tipo;                // Tipo concreto del carro
+
+protected:
+    Motor* motor;                  // Motor incorporado
+    int cantidadPlazas;            // Cantidad de plazas
+    double velocidad;              // Velocidad del vehículo en km/h
+    Fecha fechaSalida;             // Fecha de salida de la planta
+
+public:
+    // Constructor
+    Carro(TipoCarro tipo, Motor* motor, int cantidadPlazas, double velocidad, Fecha fechaSalida)
+        : tipo(tipo), motor(motor), cantidadPlazas(cantidadPlazas), velocidad(velocidad), fechaSalida(fechaSalida) {}
+
+    // Destructor virtual (los carros se liberan a través de punteros a Carro)
+    virtual ~Carro() = default;
+
+    // Métodos getters y setters
+    TipoCarro getTipo() const { return tipo; }
+
+    Motor* getMotor() const { return motor; }
+    void setMotor(Motor* motor) { this->motor = motor; }
+
+    int getCantidadPlazas() const { return cantidadPlazas; }
+    void setCantidadPlazas(int plazas) { cantidadPlazas = plazas; }
+
+    double getVelocidad() const { return velocidad; }
+    void setVelocidad(double velocidad) { this->velocidad = velocidad; }
+
+    Fecha getFechaSalida() const { return fechaSalida; }
+    void setFechaSalida(Fecha fecha) { fechaSalida = fecha; }
+
+    // Método virtual para calcular el precio de venta
+    virtual double calcularPrecioVenta() const = 0;
+
+    // Método virtual que describe los campos de la ficha técnica del carro
+    virtual void escribirFicha(EscritorReporte& escritor) const;
+
+    // Muestra la ficha técnica por pantalla
+    void mostrarFichaTecnica() const;
+};
+
+class Formula1 final : public Carro {
+private:
+    double pesoCarroceria;    // Peso de la carrocería
+
+public:
+    // Constructor
+    Formula1(MotorAlta* motor, double velocidad, Fecha fechaSalida, double pesoCarroceria)
+        : Carro(TipoCarro::Formula1, motor, 1, velocidad, fechaSalida), pesoCarroceria(pesoCarroceria) {}
+
+    // Motor con su tipo concreto (un Formula1 siempre lleva motor de alta)
+    MotorAlta* getMotorConcreto() const { return static_cast<MotorAlta*>(motor); }
+
+    // Métodos getters y setters
+    double getPesoCarroceria() const { return pesoCarroceria; }
+    void setPesoCarroceria(double peso) { pesoCarroceria = peso; }
+
+    // Sobrescribir el método para calcular el precio de venta
+    double calcularPrecioVenta() const override {
+        return velocidad * 5 + 1 / pesoCarroceria + getMotorConcreto()->calcularCosto();
+    }
+
+    // Cambio del precio de venta por cada reensamblaje adicional del motor
+    double variacionPrecioPorReensamblaje() const { return getMotorConcreto()->variacionCostoPorReensamblaje(); }
+
+    // Sobrescribir el método para describir la ficha técnica
+    void escribirFicha(EscritorReporte& escritor) const override;
+};
+
+class Omnibus final : public Carro {
+private:
+    int cantidadPuertas;    // Cantidad de puertas
+
+public:
+    // Constructor
+    Omnibus(MotorFuerza* motor, double velocidad, Fecha fechaSalida, int cantidadPuertas)
+        : Carro(TipoCarro::Omnibus, motor, 0, velocidad, fechaSalida), cantidadPuertas(cantidadPuertas) {
+        calcularCapacidad();
+    }
+
+    // Motor con su tipo concreto (un ómnibus siempre lleva motor de fuerza)
+    MotorFuerza* getMotorConcreto() const { return static_cast<MotorFuerza*>(motor); }
+
+    // Métodos getters y setters
+    int getCantidadPuertas() const { return cantidadPuertas; }
+    void setCantidadPuertas(int puertas) { cantidadPuertas = puertas; }
+
+    // Método para calcular la capacidad en función de los caballos de fuerza del motor
+    void calcularCapacidad() {
+        int caballos = getMotorConcreto()->getCaballosFuerza();
+        cantidadPlazas = caballos / 10;    // Por cada 10 caballos de fuerza, 1 persona
+    }
+
+    // Sobrescribir el método para calcular el precio de venta
+    double calcularPrecioVenta() const override {
+        return (cantidadPuertas * 1.5 + getMotorConcreto()->calcularCosto()) * 3;
+    }
+
+    // Cambio del precio de venta por cada reensamblaje adicional del motor
+    double variacionPrecioPorReensamblaje() const { return getMotorConcreto()->variacionCostoPorReensamblaje() * 3; }
+
+    // Sobrescribir el método para describir la ficha técnica
+    void escribirFicha(EscritorReporte& escritor) const override;
+};
+
+class Sport final : public Carro {
+private:
+    int cantidadVelocidades;    // Cantidad de velocidades de la caja
+    bool cambioUniversal;       // Indicador de si es de cambio universal
+
+public:
+    // Constructor
+    Sport(MotorTrabajo* motor, int cantidadPlazas, double velocidad, Fecha fechaSalida,
+          int cantidadVelocidades, bool cambioUniversal)
+        : Carro(TipoCarro::Sport, motor, cantidadPlazas, velocidad, fechaSalida),
+          cantidadVelocidades(cantidadVelocidades), cambioUniversal(cambioUniversal) {}
+
+    // Motor con su tipo concreto (un Sport siempre lleva motor de trabajo)
+    MotorTrabajo* getMotorConcreto() const { return static_cast<MotorTrabajo*>(motor); }
+
+    // Métodos getters y setters
+    int getCantidadVelocidades() const { return cantidadVelocidades; }
+    void setCantidadVelocidades(int velocidades) { cantidadVelocidades = velocidades; }
+
+    bool esCambioUniversal() const { return cambioUniversal; }
+    void setCambioUniversal(bool cambio) { cambioUniversal = cambio; }
+
+    // Sobrescribir el método para calcular el precio de venta
+    double calcularPrecioVenta() const override {
+        double precio = cantidadVelocidades * 2 + getMotorConcreto()->calcularCosto();
+        if (cambioUniversal) {
+            precio += 1000;
+        }
+        return precio;
+    }
+
+    // Cambio del precio de venta por cada reensamblaje adicional del motor
+    double variacionPrecioPorReensamblaje() const { return getMotorConcreto()->variacionCostoPorReensamblaje(); }
+
+    // Sobrescribir el método para describir la ficha técnica
+    void escribirFicha(EscritorReporte& escritor) const override;
+};
+
+class DeLujo final : public Carro {
+private:
+    double costoTapiceria;    // Costo de la tapicería
+
+public:
+    // Constructor
+    DeLujo(MotorTrabajo* motor, int cantidadPlazas, double velocidad, Fecha fechaSalida,
+           double costoTapiceria)
+        : Carro(TipoCarro::DeLujo, motor, cantidadPlazas, velocidad, fechaSalida), costoTapiceria(costoTapiceria) {}
+
+    // Motor con su tipo concreto (un carro de lujo siempre lleva motor de trabajo artesanal)
+    MotorTrabajo* getMotorConcreto() const { return static_cast<MotorTrabajo*>(motor); }
+
+    // Métodos getters y setters
+    double getCostoTapiceria() const { return costoTapiceria; }
+    void setCostoTapiceria(double costo) { costoTapiceria = costo; }
+
+    // Sobrescribir el método para calcular el precio de venta
+    double calcularPrecioVenta() const override {
+        return (costoTapiceria + getMotorConcreto()->calcularCosto()) * 10;
+    }
+
+    // Cambio del precio de venta por cada reensamblaje adicional del motor
+    double variacionPrecioPorReensamblaje() const { return getMotorConcreto()->variacionCostoPorReensamblaje() * 10; }
+
+    // Sobrescribir el método para describir la ficha técnica
+    void escribirFicha(EscritorReporte& escritor) const override;
+};
+
+// Despacho por tipo concreto
+// El visitante recibe una referencia al tipo final, así que las llamadas que haga se resuelven en compilación.
+
+template <typename Visitante>
+decltype(auto) visitarMotor(Motor& motor, Visitante&& visitante) {
+    switch (motor.getTipo()) {
+        case TipoMotor::Alta:   return visitante(static_cast<MotorAlta&>(motor));
+        case TipoMotor::Fuerza: return visitante(static_cast<MotorFuerza&>(motor));
+        default:                return visitante(static_cast<MotorTrabajo&>(motor));
+    }
+}
+
+template <typename Visitante>
+decltype(auto) visitarMotor(const Motor& motor, Visitante&& visitante) {
+    switch (motor.getTipo()) {
+        case TipoMotor::Alta:   return visitante(static_cast<const MotorAlta&>(motor));
+        case TipoMotor::Fuerza: return visitante(static_cast<const MotorFuerza&>(motor));
+        default:                return visitante(static_cast<const MotorTrabajo&>(motor));
+    }
+}
+
+template <typename Visitante>
+decltype(auto) visitarCarro(Carro& carro, Visitante&& visitante) {
+    switch (carro.getTipo()) {
+        case TipoCarro::Formula1: return visitante(static_cast<Formula1&>(carro));
+        case TipoCarro::Omnibus:  return visitante(static_cast<Omnibus&>(carro));
+        case TipoCarro::Sport:    return visitante(static_cast<Sport&>(carro));
+        default:                  return visitante(static_cast<DeLujo&>(carro));
+    }
+}
+
+template <typename Visitante>
+decltype(auto) visitarCarro(const Carro& carro, Visitante&& visitante) {
+    switch (carro.getTipo()) {
+        case TipoCarro::Formula1: return visitante(static_cast<const Formula1&>(carro));
+        case TipoCarro::Omnibus:  return visitante(static_cast<const Omnibus&>(carro));
+        case TipoCarro::Sport:    return visitante(static_cast<const Sport&>(carro));
+        default:                  return visitante(static_cast<const DeLujo&>(carro));
+    }
+}
+
+// Precio de venta y su sensibilidad a los reensamblajes del motor
+// El costo de cada motor y el precio de cada carro son lineales en vecesReensamblado, así que el precio
+// con un reensamblaje más o uno menos se obtiene en forma cerrada, sin modificar el motor.
+
+struct SensibilidadPrecio {
+    double precio;                      // Precio de venta actual
+    double variacionPorReensamblaje;    // Cambio del precio por cada reensamblaje adicional
+
+    double precioConUnReensamblajeMas() const { return precio + variacionPorReensamblaje; }
+    double precioConUnReensamblajeMenos() const { return precio - variacionPorReensamblaje; }
+};
+
+SensibilidadPrecio calcularSensibilidadPrecio(const Carro& carro);
+
+
+// Pool de objetos de un tipo concreto
+// Reserva las ranuras en bloques contiguos; las ranuras liberadas se reutilizan a través de una lista
+// libre y al terminar se liberan todos los bloques de una sola vez.
+
+template <typename T>
+class PoolObjetos {
+private:
+    struct Ranura {
+        union {
+            Ranura* siguienteLibre;                      // Enlace de la lista libre cuando está vacía
+            alignas(T) unsigned char objeto[sizeof(T)];  // Almacenamiento del objeto cuando está ocupada
+        };
+        bool ocupada;
+    };
+
+    static const size_t RANURAS_POR_BLOQUE = 1024;
+
+    std::vector<std::unique_ptr<Ranura[]>> bloques;
+    size_t usadasUltimoBloque = RANURAS_POR_BLOQUE;    // Ranuras nunca usadas del último bloque
+    Ranura* libres = nullptr;
+
+    // Estadísticas
+    size_t vivos = 0;
+    size_t asignaciones = 0;
+    size_t reutilizaciones = 0;
+
+public:
+    PoolObjetos() = default;
+    PoolObjetos(const PoolObjetos&) = delete;
+    PoolObjetos& operator=(const PoolObjetos&) = delete;
+    ~PoolObjetos() { liberarTodo(); }
+
+    template <typename... Argumentos>
+    T* crear(Argumentos&&... argumentos) {
+        Ranura* ranura;
+        if (libres) {
+            ranura = libres;
+            libres = libres->siguienteLibre;
+            reutilizaciones++;
+        } else {
+            if (usadasUltimoBloque == RANURAS_POR_BLOQUE) {
+                bloques.emplace_back(new Ranura[RANURAS_POR_BLOQUE]);
+                usadasUltimoBloque = 0;
+            }
+            ranura = &bloques.back()[usadasUltimoBloque++];
+        }
+        T* objeto = new (ranura->objeto) T(std::forward<Argumentos>(argumentos)...);
+        ranura->ocupada = true;
+        vivos++;
+        asignaciones++;
+        return objeto;
+    }
+
+    void destruir(T* objeto) {
+        Ranura* ranura = reinterpret_cast<Ranura*>(reinterpret_cast<unsigned char*>(objeto) - offsetof(Ranura, objeto));
+        objeto->~T();
+        ranura->ocupada = false;
+        ranura->siguienteLibre = libres;
+        libres = ranura;
+        vivos--;
+    }
+
+    // Destruye los objetos que siguen vivos y devuelve todos los bloques
+    void liberarTodo() {
+        for (size_t b = 0; b < bloques.size(); ++b) {
+            size_t usadas = b + 1 == bloques.size() ? usadasUltimoBloque : RANURAS_POR_BLOQUE;
+            for (size_t i = 0; i < usadas; ++i) {
+                if (bloques[b][i].ocupada) {
+                    reinterpret_cast<T*>(bloques[b][i].objeto)->~T();
+                }
+            }
+        }
+        bloques.clear();
+        usadasUltimoBloque = RANURAS_POR_BLOQUE;
+        libres = nullptr;
+        vivos = 0;
+    }
+
+    size_t getVivos() const { return vivos; }
+    size_t getCapacidad() const { return bloques.size() * RANURAS_POR_BLOQUE; }
+    size_t getBloques() const { return bloques.size(); }
+    size_t getAsignaciones() const { return asignaciones; }
+    size_t getReutilizaciones() const { return reutilizaciones; }
+};
+
+// Inventario de motores de trabajo
+// Se divide en artesanales y estándar para que un carro de lujo obtenga su motor artesanal en O(1).
+// Cada motor recibe un número de llegada: ambos sub-pools quedan ordenados por llegada, el Sport sigue
+// tomando el último motor que entró (de cualquiera de los dos) y el carro de lujo el artesanal más antiguo.
+// La condición de un motor solo cambia a través del inventario (al agregarlo o con cambiarArtesanal),
+// así que cada sub-pool contiene exactamente los motores de su condición.
+
+// Cola circular sobre un vector: agrega y quita por ambos extremos sin pedir memoria mientras no se
+// supere la capacidad ya alcanzada (std::deque libera y vuelve a pedir sus bloques al avanzar).
+template <typename T>
+class ColaCircular {
+private:
+    std::vector<T> elementos;    // Capacidad siempre potencia de dos
+    size_t inicio = 0;
+    size_t cantidad = 0;
+
+    size_t posicion(size_t i) const { return (inicio + i) & (elementos.size() - 1); }
+
+    void crecer() {
+        std::vector<T> nuevos(std::max<size_t>(16, elementos.size() * 2));
+        for (size_t i = 0; i < cantidad; ++i) {
+            nuevos[i] = elementos[posicion(i)];
+        }
+        elementos.swap(nuevos);
+        inicio = 0;
+    }
+
+public:
+    size_t size() const { return cantidad; }
+    bool empty() const { return cantidad == 0; }
+
+    T& operator[](size_t i) { return elementos[posicion(i)]; }
+    const T& operator[](size_t i) const { return elementos[posicion(i)]; }
+    T& front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T& back() { return (*this)[cantidad - 1]; }
+    const T& back() const { return (*this)[cantidad - 1]; }
+
+    void push_back(const T& valor) {
+        if (cantidad == elementos.size()) {
+            crecer();
+        }
+        elementos[posicion(cantidad++)] = valor;
+    }
+
+    void pop_back() { cantidad--; }
+
+    void pop_front() {
+        inicio = posicion(1);
+        cantidad--;
+    }
+
+    // Inserta en la posición i; los elementos siguientes se desplazan un lugar
+    void insert(size_t i, const T& valor) {
+        push_back(valor);
+        for (size_t j = cantidad - 1; j > i; --j) {
+            (*this)[j] = (*this)[j - 1];
+        }
+        (*this)[i] = valor;
+    }
+
+    void erase(size_t i) {
+        for (size_t j = i; j + 1 < cantidad; ++j) {
+            (*this)[j] = (*this)[j + 1];
+        }
+        cantidad--;
+    }
+
+    // Conserva la capacidad
+    void clear() {
+        inicio = 0;
+        cantidad = 0;
+    }
+};
+
+class InventarioMotoresTrabajo {
+private:
+    struct Entrada {
+        MotorTrabajo* motor;
+        unsigned long llegada;
+    };
+
+    ColaCircular<Entrada> artesanales;
+    ColaCircular<Entrada> estandar;
+    unsigned long siguienteLlegada = 0;
+
+    static void insertarOrdenado(ColaCircular<Entrada>& subPool, const Entrada& entrada) {
+        size_t desde = 0, hasta = subPool.size();
+        while (desde < hasta) {
+            size_t medio = desde + (hasta - desde) / 2;
+            if (entrada.llegada < subPool[medio].llegada) {
+                hasta = medio;
+            } else {
+                desde = medio + 1;
+            }
+        }
+        subPool.insert(desde, entrada);
+    }
+
+public:
+    size_t size() const { return artesanales.size() + estandar.size(); }
+    bool empty() const { return artesanales.empty() && estandar.empty(); }
+    size_t cantidadArtesanales() const { return artesanales.size(); }
+
+    void agregar(MotorTrabajo* motor) {
+        Entrada entrada{motor, siguienteLlegada++};
+        (motor->esArtesanal() ? artesanales : estandar).push_back(entrada);
+    }
+
+    // Agrega un motor que vuelve al inventario con otra condición
+    void agregar(MotorTrabajo* motor, bool artesanal) {
+        motor->setArtesanal(artesanal);
+        agregar(motor);
+    }
+
+    // Último motor en llegar (para el Sport)
+    MotorTrabajo* tomarUltimo() {
+        if (empty()) {
+            return nullptr;
+        }
+        bool deArtesanales = estandar.empty() ||
+                             (!artesanales.empty() && artesanales.back().llegada > estandar.back().llegada);
+        ColaCircular<Entrada>& subPool = deArtesanales ? artesanales : estandar;
+        MotorTrabajo* motor = subPool.back().motor;
+        subPool.pop_back();
+        return motor;
+    }
+
+    bool hayArtesanal() const { return !artesanales.empty(); }
+
+    // Motor artesanal más antiguo (para el carro de lujo)
+    MotorTrabajo* tomarArtesanal() {
+        if (artesanales.empty()) {
+            return nullptr;
+        }
+        MotorTrabajo* motor = artesanales.front().motor;
+        artesanales.pop_front();
+        return motor;
+    }
+
+    // Quita un motor cualquiera del inventario; en O(1) si es el que tomarían tomarUltimo o tomarArtesanal
+    bool quitar(const MotorTrabajo* motor) {
+        for (ColaCircular<Entrada>* subPool : {&artesanales, &estandar}) {
+            if (subPool->empty()) {
+                continue;
+            }
+            if (subPool->back().motor == motor) {
+                subPool->pop_back();
+                return true;
+            }
+            if (subPool->front().motor == motor) {
+                subPool->pop_front();
+                return true;
+            }
+        }
+        for (ColaCircular<Entrada>* subPool : {&artesanales, &estandar}) {
+            for (size_t i = 0; i < subPool->size(); ++i) {
+                if ((*subPool)[i].motor == motor) {
+                    subPool->erase(i);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Quita de una vez los motores para los que quitar(motor) es verdadero, en O(n)
+    template <typename Predicado>
+    void quitarSi(Predicado quitar) {
+        for (ColaCircular<Entrada>* subPool : {&artesanales, &estandar}) {
+            size_t conservados = 0;
+            for (size_t i = 0; i < subPool->size(); ++i) {
+                if (!quitar((*subPool)[i].motor)) {
+                    (*subPool)[conservados++] = (*subPool)[i];
+                }
+            }
+            while (subPool->size() > conservados) {
+                subPool->pop_back();
+            }
+        }
+    }
+
+    // Cambia la condición de un motor que está en el inventario y lo pasa al sub-pool que corresponde
+    void cambiarArtesanal(MotorTrabajo* motor, bool artesanal) {
+        ColaCircular<Entrada>& origen = motor->esArtesanal() ? artesanales : estandar;
+        motor->setArtesanal(artesanal);
+        for (size_t i = 0; i < origen.size(); ++i) {
+            if (origen[i].motor == motor) {
+                Entrada entrada = origen[i];
+                origen.erase(i);
+                insertarOrdenado(artesanal ? artesanales : estandar, entrada);
+                return;
+            }
+        }
+    }
+
+    // Recorre los motores en orden de llegada
+    template <typename Funcion>
+    void recorrer(Funcion funcion) const {
+        size_t a = 0, e = 0;
+        while (a < artesanales.size() || e < estandar.size()) {
+            if (e == estandar.size() || (a < artesanales.size() && artesanales[a].llegada < estandar[e].llegada)) {
+                funcion(artesanales[a++].motor);
+            } else {
+                funcion(estandar[e++].motor);
+            }
+        }
+    }
+
+    void clear() {
+        artesanales.clear();
+        estandar.clear();
+    }
+};
+
+// Contador de asignaciones de memoria
+// Los operadores new y delete globales se reemplazan para contar las asignaciones de todo el proceso,
+// incluidas las de la biblioteca estándar. Solo se cuenta mientras contarAsignaciones está activo
+// (--contar-asignaciones, o durante el banco de pruebas); apagado cuesta una lectura atómica por
+// asignación, así que está disponible en cualquier compilación.
+
+extern std::atomic<bool> contarAsignaciones;
+extern std::atomic<uint64_t> asignacionesContadas;
+extern std::atomic<uint64_t> bytesAsignadosContados;
+
+struct ConteoAsignaciones {
+    uint64_t asignaciones = 0;
+    uint64_t bytes = 0;
+};
+
+ConteoAsignaciones leerAsignaciones();
+
+// Asignaciones desde la lectura inicio
+ConteoAsignaciones asignacionesDesde(const ConteoAsignaciones& inicio);
+
+// Contador de producción sin contención
+// Cada hilo suma en su propia ranura, alineada a una línea de caché, y la lectura suma todas las
+// ranuras. El hilo principal usa la ranura 0; los hilos de la línea concurrente fijan la suya con
+// ranuraContadorHilo.
+
+const size_t RANURAS_CONTADOR = 64;
+
+extern thread_local size_t ranuraContadorHilo;
+
+class ContadorProduccion {
+private:
+    struct alignas(64) Ranura {
+        std::atomic<long> valor{0};
+    };
+    Ranura ranuras[RANURAS_CONTADOR];
+
+public:
+    void sumar(long cantidad) {
+        ranuras[ranuraContadorHilo % RANURAS_CONTADOR].valor.fetch_add(cantidad, std::memory_order_relaxed);
+    }
+
+    void operator++(int) { sumar(1); }
+
+    long valor() const {
+        long total = 0;
+        for (const auto& ranura : ranuras) {
+            total += ranura.valor.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    operator long() const { return valor(); }
+
+    // Solo debe llamarse sin otros hilos sumando
+    void reiniciar(long valor) {
+        for (auto& ranura : ranuras) {
+            ranura.valor.store(0, std::memory_order_relaxed);
+        }
+        ranuras[0].valor.store(valor, std::memory_order_relaxed);
+    }
+};
+
+// Métricas de operaciones
+// Cada operación de InventarioPlanta y cada acción del menú acumulan su cantidad y un histograma de
+// latencias con cubetas de potencias de 4 (de 256 ns a 17 s, más una cubeta sin límite). Solo se mide
+// mientras metricasActivas está encendido (--metricas o la opción del menú); apagado, cada operación
+// cuesta una lectura atómica. Los contadores son atómicos, así que cualquier hilo puede registrar.
+
+enum class OperacionPlanta {
+    AgregarMotor,
+    EnsamblarCarro,
+    DarDeBajaCarro,
+    Importar,
+    MotoresDisponibles,
+    CarrosAltaVelocidad,
+    OmnibusMayorCapacidad,
+    CarrosReensamblados,
+    CumplimientoPlan,
+    ProduccionEntre,
+    CumplimientoMensual,
+    ProyeccionPlan,
+    Ganancias,
+    Tablero,
+    CompararAgregados,
+    EstadisticasMemoria,
+    EstadisticasEspecialistas,
+    FichasCarros,
+    EnsamblarLote,
+    Clasificacion,
+    ArchivarCarros,
+    ConsultarHistorico
+};
+
+const int CANTIDAD_OPERACIONES_PLANTA = 21;
+const int CUBETAS_LATENCIA = 14;    // Cubetas con límite; la cubeta CUBETAS_LATENCIA no tiene límite
+
+const char* nombreOperacionPlanta(OperacionPlanta operacion);
+
+extern std::atomic<bool> metricasActivas;
+
+class HistogramaLatencia {
+private:
+    std::atomic<uint64_t> cubetas[CUBETAS_LATENCIA + 1] = {};
+    std::atomic<uint64_t> cantidad{0};
+    std::atomic<uint64_t> sumaNs{0};
+
+public:
+    // Límite superior (incluido) de una cubeta, en nanosegundos
+    static uint64_t limiteNs(int cubeta) { return uint64_t(256) << (2 * cubeta); }
+
+    void registrar(uint64_t ns) {
+        // Bits de ns redondeado hacia arriba a potencia de 2; cada cubeta cubre dos bits más
+        int bits = ns > 1 ? 64 - __builtin_clzll(ns - 1) : 0;
+        int cubeta = bits <= 8 ? 0 : std::min((bits - 7) / 2, CUBETAS_LATENCIA);
+        cubetas[cubeta].fetch_add(1, std::memory_order_relaxed);
+        cantidad.fetch_add(1, std::memory_order_relaxed);
+        sumaNs.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    uint64_t getCubeta(int cubeta) const { return cubetas[cubeta].load(std::memory_order_relaxed); }
+    uint64_t getCantidad() const { return cantidad.load(std::memory_order_relaxed); }
+    uint64_t getSumaNs() const { return sumaNs.load(std::memory_order_relaxed); }
+};
+
+extern HistogramaLatencia latenciaOperaciones[CANTIDAD_OPERACIONES_PLANTA];
+
+// Mide la duración de su alcance y la registra en el histograma al terminar (si las métricas están activas)
+class MedicionLatencia {
+private:
+    HistogramaLatencia* histograma;
+    std::chrono::steady_clock::time_point inicio;
+
+public:
+    explicit MedicionLatencia(HistogramaLatencia& destino)
+        : histograma(metricasActivas.load(std::memory_order_relaxed) ? &destino : nullptr) {
+        if (histograma) {
+            inicio = std::chrono::steady_clock::now();
+        }
+    }
+
+    explicit MedicionLatencia(OperacionPlanta operacion)
+        : MedicionLatencia(latenciaOperaciones[static_cast<int>(operacion)]) {}
+
+    MedicionLatencia(const MedicionLatencia&) = delete;
+    MedicionLatencia& operator=(const MedicionLatencia&) = delete;
+
+    ~MedicionLatencia() {
+        if (histograma) {
+            auto duracion = std::chrono::steady_clock::now() - inicio;
+            histograma->registrar(std::chrono::duration_cast<std::chrono::nanoseconds>(duracion).count());
+        }
+    }
+};
+
+// Grabación de la carga de trabajo (--grabar)
+// Cada operación de InventarioPlanta que no fue llamada desde otra operación se anota en la traza con sus
+// datos de entrada; grabarEnTraza se define al final de este archivo, junto con el formato de la traza.
+extern std::atomic<bool> grabandoTraza;
+extern thread_local int profundidadOperacion;
+extern std::string archivoTraza;    // Destino de la grabación (--grabar)
+
+// Qué clasificación pidió una operación Clasificacion
+enum class ClasificacionTrazada : uint8_t { Rentables, Rapidos, Omnibus, MotoresBaratos };
+
+template <typename... Datos>
+void grabarEnTraza(OperacionPlanta operacion, const Datos&... datos);
+
+class OperacionTrazada {
+public:
+    template <typename... Datos>
+    explicit OperacionTrazada(OperacionPlanta operacion, const Datos&... datos) {
+        if (profundidadOperacion++ == 0 && grabandoTraza.load(std::memory_order_relaxed)) {
+            grabarEnTraza(operacion, datos...);
+        }
+    }
+
+    OperacionTrazada(const OperacionTrazada&) = delete;
+    OperacionTrazada& operator=(const OperacionTrazada&) = delete;
+
+    ~OperacionTrazada() { profundidadOperacion--; }
+};
+
+
+// Índice de motores por código (12 caracteres)
+// Permite localizar en O(1) un motor y, si está montado, el carro que lo lleva
+const size_t SIN_CARRO = static_cast<size_t>(-1);
+
+struct EntradaIndiceMotor {
+    Motor* motor;            // Motor registrado con ese código
+    size_t posicionCarro;    // Posición del carro en carrosEnsamblados (SIN_CARRO si el motor está disponible)
+};
+
+// Almacén columnar (opcional) de los carros ensamblados
+// Guarda en arreglos contiguos los datos que usan los reportes agregados, para recorrerlos sin
+// seguir punteros a cada carro y a su motor. La fila i corresponde siempre a carrosEnsamblados[i].
+
+const double VELOCIDAD_ALTA = 150;    // Umbral del reporte de carros de mayor velocidad (km/h)
+
+struct AlmacenColumnarCarros {
+    std::vector<TipoCarro> tipo;
+    std::vector<double> velocidad;
+    std::vector<int> cantidadPlazas;
+    std::vector<double> costoMotor;             // Costo del motor al momento de ensamblar
+    // Campos propios de cada tipo (0 en las filas de otros tipos)
+    std::vector<double> pesoCarroceria;         // Formula1
+    std::vector<int> cantidadPuertas;           // Ómnibus
+    std::vector<int> cantidadVelocidades;       // Sport
+    std::vector<unsigned char> cambioUniversal; // Sport
+    std::vector<double> costoTapiceria;         // De Lujo
+
+    size_t size() const { return tipo.size(); }
+
+    void reservar(size_t cantidad);
+    void agregar(const Carro* carro);
+    void quitar(size_t posicion);    // El último carro ocupa la posición, igual que en carrosEnsamblados
+    void limpiar();
+};
+
+// Ejecución de los reportes por bloques
+// Los recorridos de carrosEnsamblados se dividen en bloques fijos de BLOQUE_REPORTE carros que se
+// reparten entre hilosReportes hilos; los resultados de cada bloque se combinan en el orden de los
+// bloques. Como los bloques no dependen de la cantidad de hilos, el resultado (incluidas las sumas en
+// punto flotante) es el mismo con cualquier cantidad de hilos.
+
+const size_t BLOQUE_REPORTE = 16384;
+extern int hilosReportes;    // Se cambia con --hilos-reportes o desde el menú
+
+size_t contarBloques(size_t cantidad, size_t tamanoBloque = BLOQUE_REPORTE);
+
+// Llama a trabajo(bloque) para cada bloque de [0, cantidadBloques); los hilos toman el siguiente
+// bloque libre y el hilo que llama también trabaja
+template <typename Trabajo>
+void ejecutarPorBloques(size_t cantidadBloques, Trabajo trabajo) {
+    size_t hilos = std::min(static_cast<size_t>(std::max(hilosReportes, 1)), cantidadBloques);
+    if (hilos <= 1) {
+        for (size_t bloque = 0; bloque < cantidadBloques; ++bloque) {
+            trabajo(bloque);
+        }
+        return;
+    }
+
+    std::atomic<size_t> siguiente{0};
+    auto trabajar = [&] {
+        size_t bloque;
+        while ((bloque = siguiente.fetch_add(1, std::memory_order_relaxed)) < cantidadBloques) {
+            trabajo(bloque);
+        }
+    };
+    std::vector<std::thread> auxiliares;
+    for (size_t i = 1; i < hilos; ++i) {
+        auxiliares.emplace_back(trabajar);
+    }
+    trabajar();
+    for (auto& hilo : auxiliares) {
+        hilo.join();
+    }
+}
+
+// Suma por tipo de carro: sumarBloque(inicio, fin, parcial) acumula las filas [inicio, fin) en parcial
+template <typename SumarBloque>
+void sumarPorTipoEnBloques(size_t cantidad, double resultado[CANTIDAD_TIPOS_CARRO], SumarBloque sumarBloque) {
+    size_t bloques = contarBloques(cantidad);
+    std::vector<double> parciales(bloques * CANTIDAD_TIPOS_CARRO, 0.0);
+    ejecutarPorBloques(bloques, [&](size_t bloque) {
+        size_t inicio = bloque * BLOQUE_REPORTE;
+        sumarBloque(inicio, std::min(inicio + BLOQUE_REPORTE, cantidad), &parciales[bloque * CANTIDAD_TIPOS_CARRO]);
+    });
+
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        resultado[i] = 0;
+    }
+    for (size_t bloque = 0; bloque < bloques; ++bloque) {
+        for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+            resultado[i] += parciales[bloque * CANTIDAD_TIPOS_CARRO + i];
+        }
+    }
+}
+
+// Filtro en orden: filtrarBloque(inicio, fin, posiciones) agrega las filas de [inicio, fin) que cumplen
+template <typename FiltrarBloque>
+void filtrarEnBloques(size_t cantidad, std::vector<size_t>& posiciones, FiltrarBloque filtrarBloque) {
+    size_t bloques = contarBloques(cantidad);
+    std::vector<std::vector<size_t>> parciales(bloques);
+    ejecutarPorBloques(bloques, [&](size_t bloque) {
+        size_t inicio = bloque * BLOQUE_REPORTE;
+        filtrarBloque(inicio, std::min(inicio + BLOQUE_REPORTE, cantidad), parciales[bloque]);
+    });
+
+    size_t total = 0;
+    for (const auto& parcial : parciales) {
+        total += parcial.size();
+    }
+    posiciones.clear();
+    posiciones.reserve(total);
+    for (const auto& parcial : parciales) {
+        posiciones.insert(posiciones.end(), parcial.begin(), parcial.end());
+    }
+}
+
+// Cálculos de los reportes agregados, sobre los punteros o sobre el almacén columnar
+
+void calcularGananciasPorTipo(const std::vector<Carro*>& carros, double ganancias[CANTIDAD_TIPOS_CARRO]);
+void calcularGananciasPorTipo(const AlmacenColumnarCarros& almacen, double ganancias[CANTIDAD_TIPOS_CARRO]);
+void filtrarAltaVelocidad(const std::vector<Carro*>& carros, std::vector<size_t>& posiciones);
+void filtrarAltaVelocidad(const AlmacenColumnarCarros& almacen, std::vector<size_t>& posiciones);
+
+// Devuelve la posición del ómnibus de mayor capacidad, o SIN_CARRO si no hay ómnibus
+size_t buscarOmnibusMayorCapacidad(const std::vector<Carro*>& carros);
+size_t buscarOmnibusMayorCapacidad(const AlmacenColumnarCarros& almacen);
+
+// Espejo de los carros para lecturas concurrentes (modo servicio)
+// Los reportes de listado del servicio no recorren carrosEnsamblados, que cambia con cada ensamblaje y
+// baja, sino una versión inmutable del inventario. El espejo guarda una copia de cada carro junto con su
+// motor, en bloques de BLOQUE_ESPEJO carros compartidos entre versiones: publicar una versión copia solo
+// los punteros a los bloques, y un escritor que va a modificar un bloque ya publicado lo copia antes
+// (copia al escribir). Cada bloque recuerda la generación en que se creó; si es la generación actual,
+// ninguna versión publicada lo ve y se modifica en el lugar. Una versión vive mientras algún lector la
+// use. La fila i corresponde siempre a carrosEnsamblados[i], como en el almacén columnar.
+
+const size_t BLOQUE_ESPEJO = 256;
+
+// Carro y motor copiados por valor; el carro copiado apunta al motor copiado
+class CopiaCarro {
+private:
+    std::variant<MotorAlta, MotorFuerza, MotorTrabajo> motor;
+    std::variant<Formula1, Omnibus, Sport, DeLujo> carro;
+
+    static std::variant<MotorAlta, MotorFuerza, MotorTrabajo> copiarMotor(const Motor& original) {
+        return visitarMotor(original, [](const auto& concreto) {
+            return std::variant<MotorAlta, MotorFuerza, MotorTrabajo>(concreto);
+        });
+    }
+
+    static std::variant<Formula1, Omnibus, Sport, DeLujo> copiarCarro(const Carro& original) {
+        return visitarCarro(original, [](const auto& concreto) {
+            return std::variant<Formula1, Omnibus, Sport, DeLujo>(concreto);
+        });
+    }
+
+    void enlazar() {
+        Motor* copiaMotor = std::visit([](Motor& concreto) { return &concreto; }, motor);
+        std::visit([copiaMotor](Carro& concreto) { concreto.setMotor(copiaMotor); }, carro);
+    }
+
+public:
+    explicit CopiaCarro(const Carro& original) : motor(copiarMotor(*original.getMotor())), carro(copiarCarro(original)) {
+        enlazar();
+    }
+
+    CopiaCarro(const CopiaCarro& otra) : motor(otra.motor), carro(otra.carro) {
+        enlazar();
+    }
+
+    CopiaCarro& operator=(const CopiaCarro& otra) {
+        motor = otra.motor;
+        carro = otra.carro;
+        enlazar();
+        return *this;
+    }
+
+    const Carro& getCarro() const {
+        return std::visit([](const Carro& concreto) -> const Carro& { return concreto; }, carro);
+    }
+};
+
+struct BloqueEspejo {
+    uint64_t generacion;
+    std::vector<CopiaCarro> carros;
+};
+
+// Versión publicada del espejo: no cambia mientras se la lee
+struct VersionCarros {
+    std::vector<std::shared_ptr<const BloqueEspejo>> bloques;
+    size_t cantidad = 0;
+
+    size_t size() const { return cantidad; }
+    const Carro& operator[](size_t i) const {
+        return bloques[i / BLOQUE_ESPEJO]->carros[i % BLOQUE_ESPEJO].getCarro();
+    }
+};
+
+// Las modificaciones y publicar deben ejecutarse de a una (el servicio las hace con mutexPlanta tomado);
+// las versiones publicadas se pueden leer desde cualquier hilo
+class EspejoCarros {
+private:
+    std::vector<std::shared_ptr<BloqueEspejo>> bloques;
+    size_t cantidad = 0;
+    uint64_t generacion = 0;                      // Bloques creados desde la última publicación
+    std::shared_ptr<const VersionCarros> publicada;    // Vacía si hubo cambios desde entonces
+
+    BloqueEspejo& bloqueModificable(size_t numero) {
+        std::shared_ptr<BloqueEspejo>& bloque = bloques[numero];
+        if (bloque->generacion != generacion) {
+            auto copia = std::make_shared<BloqueEspejo>();
+            copia->generacion = generacion;
+            copia->carros.reserve(BLOQUE_ESPEJO);
+            copia->carros.assign(bloque->carros.begin(), bloque->carros.end());
+            bloque = std::move(copia);
+        }
+        return *bloque;
+    }
+
+public:
+    void agregar(const Carro* carro) {
+        if (cantidad % BLOQUE_ESPEJO == 0) {
+            auto bloque = std::make_shared<BloqueEspejo>();
+            bloque->generacion = generacion;
+            bloque->carros.reserve(BLOQUE_ESPEJO);
+            bloques.push_back(std::move(bloque));
+        }
+        bloqueModificable(cantidad / BLOQUE_ESPEJO).carros.emplace_back(*carro);
+        cantidad++;
+        publicada.reset();
+    }
+
+    // Igual que en carrosEnsamblados: el último carro ocupa el lugar del que se quita
+    void quitar(size_t posicion) {
+        size_t ultima = cantidad - 1;
+        BloqueEspejo& bloqueUltimo = bloqueModificable(ultima / BLOQUE_ESPEJO);
+        if (posicion != ultima) {
+            bloqueModificable(posicion / BLOQUE_ESPEJO).carros[posicion % BLOQUE_ESPEJO] = bloqueUltimo.carros.back();
+        }
+        bloqueUltimo.carros.pop_back();
+        if (bloqueUltimo.carros.empty()) {
+            bloques.pop_back();
+        }
+        cantidad--;
+        publicada.reset();
+    }
+
+    // Devuelve la versión actual; los bloques que ve quedan inmutables a partir de aquí
+    std::shared_ptr<const VersionCarros> publicar() {
+        if (!publicada) {
+            auto version = std::make_shared<VersionCarros>();
+            version->bloques.assign(bloques.begin(), bloques.end());
+            version->cantidad = cantidad;
+            publicada = std::move(version);
+            generacion++;
+        }
+        return publicada;
+    }
+
+    void limpiar() {
+        bloques.clear();
+        cantidad = 0;
+        publicada.reset();
+        generacion++;
+    }
+};
+
+void filtrarAltaVelocidad(const VersionCarros& carros, std::vector<size_t>& posiciones);
+
+// Agregados de producción mantenidos de forma incremental
+// Se actualizan al ensamblar y al dar de baja cada carro, de modo que el tablero y los reportes de
+// ganancia y de ómnibus de mayor capacidad no recorren el inventario.
+
+double calcularGanancia(const Carro& carro);
+
+// Clave de un ómnibus en los agregados: a igual cantidad de plazas, el que llegó antes queda más adelante
+struct ClaveOmnibus {
+    int plazas;
+    unsigned long llegada;    // Orden en que el ómnibus se agregó
+
+    bool operator<(const ClaveOmnibus& otra) const {
+        return plazas != otra.plazas ? plazas < otra.plazas : llegada > otra.llegada;
+    }
+};
+
+struct AgregadosProduccion {
+    double ganancia[CANTIDAD_TIPOS_CARRO] = {};
+    long carrosPorTipo[CANTIDAD_TIPOS_CARRO] = {};
+    long carrosAltaVelocidad = 0;
+    using CapacidadesOmnibus = std::map<ClaveOmnibus, const Carro*>;
+    using PosicionesOmnibus = std::unordered_map<const Carro*, CapacidadesOmnibus::iterator>;
+    CapacidadesOmnibus capacidadesOmnibus;    // Ordenados por cantidad de plazas y, a igual cantidad, por llegada
+    PosicionesOmnibus posicionesOmnibus;      // Entrada de cada ómnibus en capacidadesOmnibus
+    unsigned long siguienteLlegada = 0;
+    // Nodos de ómnibus retirados, para reutilizar
+    std::vector<CapacidadesOmnibus::node_type> nodosLibres;
+    std::vector<PosicionesOmnibus::node_type> nodosPosicionesLibres;
+
+    void agregar(const Carro* carro);
+    void quitar(const Carro* carro);    // Debe llamarse antes de modificar el carro o su motor
+    const Carro* omnibusMayorCapacidad() const;
+};
+
+// Índice de producción por fecha de salida
+// Cuenta los motores y los carros de cada día en un árbol de Fenwick, de modo que la producción de un
+// rango de fechas cualquiera (un día, un mes, un año) se obtiene en tiempo logarítmico. El árbol cubre
+// una ventana de días que se amplía al menos al doble cuando llega una fecha fuera de ella. Los carros
+// dados de baja se descuentan: no cuentan como producidos en su período.
+
+class IndiceProduccion {
+private:
+    int32_t primerDia = 0;
+    std::vector<long> porDia;    // Cantidad de cada día de la ventana
+    std::vector<long> arbol;     // Árbol de Fenwick sobre porDia (base 1)
+    long total = 0;
+
+    void reconstruir(int32_t nuevoPrimerDia, size_t nuevaCapacidad) {
+        std::vector<long> nuevos(nuevaCapacidad, 0);
+        for (size_t i = 0; i < porDia.size(); ++i) {
+            nuevos[primerDia - nuevoPrimerDia + i] = porDia[i];
+        }
+        porDia.swap(nuevos);
+        primerDia = nuevoPrimerDia;
+
+        // Construcción en O(n): cada nodo suma su valor a su padre inmediato
+        arbol.assign(nuevaCapacidad + 1, 0);
+        for (size_t i = 1; i <= nuevaCapacidad; ++i) {
+            arbol[i] += porDia[i - 1];
+            size_t padre = i + (i & (~i + 1));
+            if (padre <= nuevaCapacidad) {
+                arbol[padre] += arbol[i];
+            }
+        }
+    }
+
+    void cubrir(int32_t dia) {
+        int32_t ultimoDia = primerDia + static_cast<int32_t>(porDia.size()) - 1;
+        if (!porDia.empty() && dia >= primerDia && dia <= ultimoDia) {
+            return;
+        }
+        int32_t desde = porDia.empty() ? dia : std::min(primerDia, dia);
+        int32_t hasta = porDia.empty() ? dia : std::max(ultimoDia, dia);
+        size_t capacidad = std::max<size_t>({static_cast<size_t>(hasta - desde) + 1, porDia.size() * 2, 366});
+        // El espacio extra queda del lado hacia el que creció la ventana
+        int32_t nuevoPrimerDia = !porDia.empty() && dia < primerDia ? hasta - static_cast<int32_t>(capacidad) + 1 : desde;
+        reconstruir(nuevoPrimerDia, capacidad);
+    }
+
+    // Cantidad de los días de la ventana hasta la posición indicada (base 1, incluida)
+    long prefijo(size_t posicion) const {
+        long suma = 0;
+        for (; posicion > 0; posicion &= posicion - 1) {
+            suma += arbol[posicion];
+        }
+        return suma;
+    }
+
+    // Cantidad de los días anteriores o iguales a dia
+    long hasta(int32_t dia) const {
+        if (porDia.empty() || dia < primerDia) {
+            return 0;
+        }
+        if (dia >= primerDia + static_cast<int32_t>(porDia.size())) {
+            return total;
+        }
+        return prefijo(static_cast<size_t>(dia - primerDia) + 1);
+    }
+
+public:
+    void agregar(Fecha fecha, long cantidad) {
+        cubrir(fecha.getDia());
+        size_t posicion = static_cast<size_t>(fecha.getDia() - primerDia);
+        porDia[posicion] += cantidad;
+        for (++posicion; posicion < arbol.size(); posicion += posicion & (~posicion + 1)) {
+            arbol[posicion] += cantidad;
+        }
+        total += cantidad;
+    }
+
+    // Cantidad con fecha en [desde, hasta]
+    long entre(Fecha desde, Fecha hasta) const {
+        if (hasta < desde) {
+            return 0;
+        }
+        return this->hasta(hasta.getDia()) - this->hasta(desde.getDia() - 1);
+    }
+
+    long enDia(Fecha fecha) const {
+        int32_t posicion = fecha.getDia() - primerDia;
+        return posicion >= 0 && posicion < static_cast<int32_t>(porDia.size()) ? porDia[posicion] : 0;
+    }
+
+    long getTotal() const { return total; }
+
+    void limpiar() {
+        porDia.clear();
+        arbol.clear();
+        total = 0;
+    }
+};
+
+// Operaciones de alta y ensamblaje sin interacción (usadas por el menú y por la importación masiva)
+
+enum class Resultado {
+    Exito,
+    CodigoDuplicado,
+    CaballosFueraDeRango,
+    PlazasInvalidas,
+    SinMotoresDisponibles,
+    SinMotoresArtesanales,
+    CarroNoEncontrado,
+    CodigoInvalido,
+    FechaInvalida,
+    SinArchivoHistorico
+};
+
+const char* mensajeResultado(Resultado resultado);
+
+struct ResumenImportacion {
+    bool abierto = false;    // false si no se pudo abrir el archivo
+    long motoresCargados = 0;
+    long carrosCargados = 0;
+    long rechazados = 0;
+    double segundos = 0;
+    std::vector<std::string> primerosRechazos;    // Hasta MAX_RECHAZOS_MOSTRADOS, con su número de línea
+};
+
+// Lectura de números (campos de importación y opciones de la línea de comandos)
+bool leerEntero(std::string_view campo, int& valor);
+bool leerEntero(std::string_view campo, uint64_t& valor);
+bool leerDecimal(std::string_view campo, double& valor);
+
+// Motor de la planta sin interfaz
+// InventarioPlanta ofrece con tipos propios las operaciones y consultas detrás de cada opción del menú,
+// sin leer ni escribir en la consola. El menú es una interfaz delgada sobre ella, y la importación,
+// el diario y el banco de pruebas la usan directamente. Cada instancia guarda su propio estado
+// (inventarios, pools, índices, agregados, diario y archivo histórico), así que dos plantas del mismo
+// proceso no comparten nada salvo la configuración de reportes, las métricas y la grabación de la traza.
+
+struct DatosMotor {
+    TipoMotor tipo = TipoMotor::Alta;
+    std::string codigo;
+    std::string fechaSalida;
+    std::string especialista;
+    int vecesReensamblado = 0;
+    double maxRPM = 0;          // Motor de Alta
+    double consumo = 0;         // Motor de Alta
+    int caballosFuerza = 0;     // Motor de Fuerza
+    bool artesanal = false;     // Motor de Trabajo
+};
+
+struct PedidoCarro {
+    TipoCarro tipo = TipoCarro::Formula1;
+    std::string fechaSalida;
+    double velocidad = 0;
+    double pesoCarroceria = 0;      // Formula1
+    int cantidadPuertas = 0;        // Ómnibus
+    int cantidadPlazas = 0;         // Sport y De Lujo
+    int cantidadVelocidades = 0;    // Sport
+    bool cambioUniversal = false;   // Sport
+    double costoTapiceria = 0;      // De Lujo
+};
+
+struct MotoresDisponibles {
+    std::vector<const MotorAlta*> alta;
+    std::vector<const MotorFuerza*> fuerza;
+    std::vector<const MotorTrabajo*> trabajo;    // En orden de llegada
+};
+
+struct CarroReensamblado {
+    const Carro* carro;
+    double disminucionPrecio;
+};
+
+struct CumplimientoPlan {
+    long motoresProducidos;
+    int planMotores;
+    double porcentajeMotores;
+    long carrosProducidos;
+    int planCarros;
+    double porcentajeCarros;
+};
+
+// Producción con fecha de salida en [desde, hasta]
+struct ProduccionPeriodo {
+    Fecha desde;
+    Fecha hasta;
+    long motores;
+    long carros;
+};
+
+// Producción de un mes frente a la doceava parte del plan anual
+struct CumplimientoMensual {
+    int mes;
+    long motores;
+    long carros;
+    double porcentajeMotores;
+    double porcentajeCarros;
+};
+
+// Producción del año hasta la fecha de corte, extrapolada al año completo al ritmo actual
+struct ProyeccionPlan {
+    Fecha corte;
+    int diasTranscurridos;
+    int diasAnio;
+    long motoresAcumulados;
+    long carrosAcumulados;
+    double motoresProyectados;
+    double carrosProyectados;
+    double porcentajeMotores;    // Proyección respecto del plan anual
+    double porcentajeCarros;
+};
+
+struct GananciasPorTipo {
+    double porTipo[CANTIDAD_TIPOS_CARRO];
+    double total;
+};
+
+// Contenido del archivo histórico
+struct ResumenHistorico {
+    bool abierto;
+    long archivadosPorTipo[CANTIDAD_TIPOS_CARRO];
+    double gananciaArchivada[CANTIDAD_TIPOS_CARRO];    // Ganancia de los carros archivados, por tipo
+    long retirados;
+    uint64_t registros;
+    uint64_t bytes;                                    // Tamaño del archivo en disco
+};
+
+struct TableroProduccion {
+    size_t motoresAlta;
+    size_t motoresFuerza;
+    size_t motoresTrabajo;
+    size_t motoresArtesanales;
+    size_t carrosEnsamblados;
+    long carrosPorTipo[CANTIDAD_TIPOS_CARRO];
+    GananciasPorTipo ganancias;
+    long carrosAltaVelocidad;
+    int mayorCapacidadOmnibus;    // 0 si no hay ómnibus
+    CumplimientoPlan cumplimiento;
+    ResumenHistorico historico;
+};
+
+// Agregados incrementales frente a un recálculo completo del inventario
+struct ComparacionAgregados {
+    double gananciaIncremental[CANTIDAD_TIPOS_CARRO];
+    double gananciaRecalculada[CANTIDAD_TIPOS_CARRO];
+    long altaVelocidadIncremental;
+    long altaVelocidadRecalculada;
+    int capacidadIncremental;
+    int capacidadRecalculada;
+    bool coinciden;
+};
+
+struct EstadisticasPool {
+    const char* nombre;
+    size_t vivos;
+    size_t capacidad;
+    size_t bloques;
+    size_t asignaciones;
+    size_t reutilizaciones;
+};
+
+struct EstadisticasEspecialista {
+    const std::string* nombre;
+    CalidadEspecialista calidad;
+};
+
+// Elemento de una clasificación con el valor por el que se ordenó
+struct CarroClasificado {
+    const Carro* carro;
+    double valor;
+};
+
+struct MotorClasificado {
+    const Motor* motor;
+    double costo;
+};
+
+// Los carros archivados salieron de la planta por antigüedad; los retirados no pasaron la prueba
+enum class ClaseHistorico : uint8_t { Archivado, Retirado };
+
+struct CarrosArchivados {
+    Resultado resultado = Resultado::Exito;
+    long carros = 0;
+    double ganancia = 0;
+};
+
+struct AsignacionLote {
+    std::vector<Resultado> resultados;    // Resultado de cada pedido, en el orden del lote
+    long ensamblados = 0;
+    double ganancia = 0;                  // Ganancia de los carros ensamblados
+    double gananciaHabitual = 0;          // La que darían los mismos pedidos con ensamblarCarro, uno por uno
+    double milisegundosPlan = 0;
+};
+
+// FNV-1a sobre palabras de 8 bytes (los bytes finales, de a uno)
+uint64_t sumaFNV1a(const char* datos, size_t longitud);
+
+// Escribe todo el contenido en ruta de forma atómica (archivo temporal, fsync y rename)
+bool escribirArchivoAtomico(const std::string& ruta, const std::string& contenido);
+
+class EscritorBinario {
+private:
+    std::string datos;
+    bool correcto = true;
+
+public:
+    template <typename T>
+    void valor(T v) {
+        datos.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    void cadena(std::string_view texto) {
+        if (texto.size() > UINT16_MAX) {
+            correcto = false;
+            return;
+        }
+        valor<uint16_t>(static_cast<uint16_t>(texto.size()));
+        datos += texto;
+    }
+
+    // Entero sin signo en base 128: siete bits por byte, el bit alto indica que sigue otro byte
+    void varint(uint64_t v) {
+        while (v >= 0x80) {
+            datos += static_cast<char>(v | 0x80);
+            v >>= 7;
+        }
+        datos += static_cast<char>(v);
+    }
+
+    // Descarta lo escrito a partir de longitud
+    void recortar(size_t longitud) {
+        datos.resize(longitud);
+        correcto = true;
+    }
+
+    std::string& contenido() { return datos; }
+    size_t tamano() const { return datos.size(); }
+    bool esCorrecto() const { return correcto; }
+};
+
+class LectorBinario {
+private:
+    const char* cursor;
+    const char* fin;
+    bool correcto = true;
+
+public:
+    LectorBinario(const char* inicio, size_t longitud) : cursor(inicio), fin(inicio + longitud) {}
+
+    template <typename T>
+    T valor() {
+        T v{};
+        if (static_cast<size_t>(fin - cursor) < sizeof(T)) {
+            correcto = false;
+            return v;
+        }
+        std::memcpy(&v, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return v;
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int desplazamiento = 0; desplazamiento < 64; desplazamiento += 7) {
+            if (cursor == fin) {
+                break;
+            }
+            uint8_t byte = static_cast<uint8_t>(*cursor++);
+            v |= static_cast<uint64_t>(byte & 0x7F) << desplazamiento;
+            if (byte < 0x80) {
+                return v;
+            }
+        }
+        correcto = false;
+        return 0;
+    }
+
+    // Las vistas apuntan a los datos leídos, sin copiarlos
+    std::string_view vistaBytes(size_t longitud) {
+        if (static_cast<size_t>(fin - cursor) < longitud) {
+            correcto = false;
+            return std::string_view();
+        }
+        std::string_view bytes(cursor, longitud);
+        cursor += longitud;
+        return bytes;
+    }
+
+    std::string_view vistaCadena() {
+        return vistaBytes(valor<uint16_t>());
+    }
+
+    std::string cadena() { return std::string(vistaCadena()); }
+
+    bool esCorrecto() const { return correcto; }
+    bool terminado() const { return cursor == fin; }
+    size_t restantes() const { return static_cast<size_t>(fin - cursor); }
+};
+
+const char MAGIA_HISTORICO[8] = {'P', 'L', 'N', 'T', 'H', 'I', 'S', 'T'};
+const uint32_t VERSION_HISTORICO = 1;
+const size_t TAMANO_CABECERA_HISTORICO = 8 + 4;
+const size_t TAMANO_ENCABEZADO_BLOQUE_HISTORICO = 4 + 4 + 4 + 4 + 4;
+const size_t TAMANO_BLOQUE_HISTORICO = 1 << 16;    // Se cierra el bloque al acumular 64 KiB
+
+struct RegistroHistorico {
+    ClaseHistorico clase = ClaseHistorico::Archivado;
+    TipoCarro tipo = TipoCarro::Formula1;
+    Fecha fechaSalida;
+    int cantidadPlazas = 0;
+    double velocidad = 0;
+    double valorPropio = 0;        // pesoCarroceria, cantidadPuertas, cantidadVelocidades o costoTapiceria
+    bool cambioUniversal = false;
+    CodigoMotor codigoMotor;
+    Fecha fechaMotor;
+    const Especialista* especialista = nullptr;
+    int vecesReensamblado = 0;
+    double valorMotor1 = 0;        // maxRPM o caballos de fuerza
+    double valorMotor2 = 0;        // consumo
+    bool artesanal = false;
+};
+
+// Arma en la pila el carro del registro con su motor y llama a visitante(carro)
+template <typename Visitante>
+auto visitarRegistroHistorico(const RegistroHistorico& registro, Visitante visitante) {
+    const RegistroHistorico& r = registro;
+    switch (r.tipo) {
+        case TipoCarro::Formula1: {
+            MotorAlta motor(r.codigoMotor, r.fechaMotor, r.especialista, r.vecesReensamblado, r.valorMotor1,
+                            r.valorMotor2);
+            return visitante(static_cast<const Carro&>(Formula1(&motor, r.velocidad, r.fechaSalida, r.valorPropio)));
+        }
+        case TipoCarro::Omnibus: {
+            MotorFuerza motor(r.codigoMotor, r.fechaMotor, r.especialista, r.vecesReensamblado,
+                              static_cast<int>(r.valorMotor1));
+            return visitante(static_cast<const Carro&>(
+                Omnibus(&motor, r.velocidad, r.fechaSalida, static_cast<int>(r.valorPropio))));
+        }
+        case TipoCarro::Sport: {
+            MotorTrabajo motor(r.codigoMotor, r.fechaMotor, r.especialista, r.vecesReensamblado, r.artesanal);
+            return visitante(static_cast<const Carro&>(Sport(&motor, r.cantidadPlazas, r.velocidad, r.fechaSalida,
+                                                             static_cast<int>(r.valorPropio), r.cambioUniversal)));
+        }
+        default: {
+            MotorTrabajo motor(r.codigoMotor, r.fechaMotor, r.especialista, r.vecesReensamblado, r.artesanal);
+            return visitante(static_cast<const Carro&>(
+                DeLujo(&motor, r.cantidadPlazas, r.velocidad, r.fechaSalida, r.valorPropio)));
+        }
+    }
+}
+
+inline uint64_t codificarZigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t decodificarZigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// Codificación de los registros de un bloque; cada bloque empieza con el estado inicial
+class CodificadorHistorico {
+private:
+    int32_t diaAnterior = 0;
+    CodigoMotor codigoAnterior;
+    TablaEspecialistas& especialistas;             // Donde se registran los especialistas leídos
+    std::vector<const Especialista*> diccionario;  // Especialistas en el orden en que aparecieron
+
+    static const uint8_t RETIRADO = 0x04;
+    static const uint8_t CAMBIO_UNIVERSAL = 0x08;
+    static const uint8_t ARTESANAL = 0x10;
+
+    // Un número exacto de centésimos (menor que 2^50) se guarda como ese número, multiplicado por dos;
+    // cualquier otro valor, como un 1 seguido de sus 8 bytes
+    static void escribirDecimal(EscritorBinario& destino, double v) {
+        double centesimos = std::nearbyint(v * 100);
+        if (std::fabs(centesimos) < 1125899906842624.0 && centesimos / 100 == v) {
+            destino.varint(codificarZigzag(static_cast<int64_t>(centesimos)) << 1);
+        } else {
+            destino.varint(1);
+            destino.valor<double>(v);
+        }
+    }
+
+    static double leerDecimal(LectorBinario& origen) {
+        uint64_t v = origen.varint();
+        if (v == 1) {
+            return origen.valor<double>();
+        }
+        return static_cast<double>(decodificarZigzag(v >> 1)) / 100;
+    }
+
+public:
+    explicit CodificadorHistorico(TablaEspecialistas& especialistas) : especialistas(especialistas) {}
+
+    void reiniciar() {
+        diaAnterior = 0;
+        codigoAnterior = CodigoMotor();
+        diccionario.clear();
+    }
+
+    void escribir(EscritorBinario& destino, const RegistroHistorico& registro) {
+        uint8_t banderas = static_cast<uint8_t>(registro.tipo);
+        if (registro.clase == ClaseHistorico::Retirado) {
+            banderas |= RETIRADO;
+        }
+        if (registro.cambioUniversal) {
+            banderas |= CAMBIO_UNIVERSAL;
+        }
+        if (registro.artesanal) {
+            banderas |= ARTESANAL;
+        }
+        destino.valor<uint8_t>(banderas);
+        int32_t dia = registro.fechaSalida.getDia();
+        destino.varint(codificarZigzag(static_cast<int64_t>(dia) - diaAnterior));
+        destino.varint(codificarZigzag(static_cast<int64_t>(registro.fechaMotor.getDia()) - dia));
+        diaAnterior = dia;
+
+        std::string_view codigo = registro.codigoMotor.vista();
+        std::string_view anterior = codigoAnterior.vista();
+        uint8_t comunes = 0;
+        while (comunes < LONGITUD_CODIGO_MOTOR && codigo[comunes] == anterior[comunes]) {
+            comunes++;
+        }
+        destino.valor<uint8_t>(comunes);
+        destino.contenido().append(codigo.substr(comunes));
+        codigoAnterior = registro.codigoMotor;
+
+        auto posicion = std::find(diccionario.begin(), diccionario.end(), registro.especialista);
+        destino.varint(static_cast<uint64_t>(posicion - diccionario.begin()));
+        if (posicion == diccionario.end()) {
+            destino.cadena(registro.especialista->nombre);
+            diccionario.push_back(registro.especialista);
+        }
+
+        destino.varint(codificarZigzag(registro.vecesReensamblado));
+        destino.varint(codificarZigzag(registro.cantidadPlazas));
+        escribirDecimal(destino, registro.velocidad);
+        escribirDecimal(destino, registro.valorPropio);
+        if (registro.tipo == TipoCarro::Formula1) {
+            escribirDecimal(destino, registro.valorMotor1);
+            escribirDecimal(destino, registro.valorMotor2);
+        } else if (registro.tipo == TipoCarro::Omnibus) {
+            destino.varint(codificarZigzag(static_cast<int64_t>(registro.valorMotor1)));
+        }
+    }
+
+    // Devuelve false si el registro está dañado
+    bool leer(LectorBinario& origen, RegistroHistorico& registro) {
+        uint8_t banderas = origen.valor<uint8_t>();
+        registro.tipo = static_cast<TipoCarro>(banderas & 0x03);
+        registro.clase = banderas & RETIRADO ? ClaseHistorico::Retirado : ClaseHistorico::Archivado;
+        registro.cambioUniversal = banderas & CAMBIO_UNIVERSAL;
+        registro.artesanal = banderas & ARTESANAL;
+        int32_t dia = static_cast<int32_t>(diaAnterior + decodificarZigzag(origen.varint()));
+        registro.fechaSalida = Fecha::desdeDia(dia);
+        registro.fechaMotor = Fecha::desdeDia(static_cast<int32_t>(dia + decodificarZigzag(origen.varint())));
+        diaAnterior = dia;
+
+        uint8_t comunes = origen.valor<uint8_t>();
+        if (comunes > LONGITUD_CODIGO_MOTOR) {
+            return false;
+        }
+        char codigo[LONGITUD_CODIGO_MOTOR];
+        std::memcpy(codigo, codigoAnterior.vista().data(), comunes);
+        std::string_view resto = origen.vistaBytes(LONGITUD_CODIGO_MOTOR - comunes);
+        std::memcpy(codigo + comunes, resto.data(), resto.size());
+        if (!origen.esCorrecto() || !CodigoMotor::desdeTexto(std::string_view(codigo, LONGITUD_CODIGO_MOTOR), codigoAnterior)) {
+            return false;
+        }
+        registro.codigoMotor = codigoAnterior;
+
+        uint64_t posicion = origen.varint();
+        if (posicion == diccionario.size()) {
+            std::string_view nombre = origen.vistaCadena();
+            if (!origen.esCorrecto()) {
+                return false;
+            }
+            diccionario.push_back(especialistas.registrar(nombre));
+        } else if (posicion > diccionario.size()) {
+            return false;
+        }
+        registro.especialista = diccionario[posicion];
+
+        registro.vecesReensamblado = static_cast<int>(decodificarZigzag(origen.varint()));
+        registro.cantidadPlazas = static_cast<int>(decodificarZigzag(origen.varint()));
+        registro.velocidad = leerDecimal(origen);
+        registro.valorPropio = leerDecimal(origen);
+        registro.valorMotor1 = registro.valorMotor2 = 0;
+        if (registro.tipo == TipoCarro::Formula1) {
+            registro.valorMotor1 = leerDecimal(origen);
+            registro.valorMotor2 = leerDecimal(origen);
+        } else if (registro.tipo == TipoCarro::Omnibus) {
+            registro.valorMotor1 = static_cast<double>(decodificarZigzag(origen.varint()));
+        }
+        return origen.esCorrecto();
+    }
+};
+
+struct BloqueHistorico {
+    uint64_t posicion;          // Desplazamiento del encabezado en el archivo
+    uint32_t longitud;          // Longitud del contenido
+    uint32_t registros;
+    uint64_t primerRegistro;    // Número del primer registro del bloque
+    int32_t primerDia;
+    int32_t ultimoDia;
+};
+
+class ArchivoHistorico {
+private:
+    TablaEspecialistas& especialistas;    // Los especialistas de los registros leídos se registran en ella
+    int descriptor = -1;
+    std::string ruta;
+    std::vector<BloqueHistorico> bloques;
+    uint64_t longitudArchivo = 0;
+    uint64_t registrosEnDisco = 0;
+    EscritorBinario pendiente;    // Contenido del bloque en curso
+    CodificadorHistorico codificador{especialistas};
+    uint32_t registrosPendientes = 0;
+    int32_t primerDiaPendiente = 0;
+    int32_t ultimoDiaPendiente = 0;
+
+    bool escribirEn(uint64_t posicion, const char* datos, size_t longitud) {
+        size_t escritos = 0;
+        while (escritos < longitud) {
+            ssize_t n = pwrite(descriptor, datos + escritos, longitud - escritos, posicion + escritos);
+            if (n <= 0) {
+                return false;
+            }
+            escritos += n;
+        }
+        return true;
+    }
+
+    bool leerEn(uint64_t posicion, char* datos, size_t longitud) const {
+        size_t leidos = 0;
+        while (leidos < longitud) {
+            ssize_t n = pread(descriptor, datos + leidos, longitud - leidos, posicion + leidos);
+            if (n <= 0) {
+                return false;
+            }
+            leidos += n;
+        }
+        return true;
+    }
+
+    // Lee el encabezado del bloque que empieza en posicion y su contenido; false si está incompleto o dañado
+    bool leerBloque(uint64_t posicion, uint64_t longitudTotal, BloqueHistorico& bloque, std::string& contenido) const {
+        char encabezado[TAMANO_ENCABEZADO_BLOQUE_HISTORICO];
+        if (longitudTotal - posicion < TAMANO_ENCABEZADO_BLOQUE_HISTORICO ||
+            !leerEn(posicion, encabezado, sizeof(encabezado))) {
+            return false;
+        }
+        LectorBinario lector(encabezado, sizeof(encabezado));
+        bloque.posicion = posicion;
+        bloque.longitud = lector.valor<uint32_t>();
+        bloque.registros = lector.valor<uint32_t>();
+        bloque.primerDia = lector.valor<int32_t>();
+        bloque.ultimoDia = lector.valor<int32_t>();
+        uint32_t suma = lector.valor<uint32_t>();
+        if (longitudTotal - posicion - TAMANO_ENCABEZADO_BLOQUE_HISTORICO < bloque.longitud) {
+            return false;
+        }
+        contenido.resize(bloque.longitud);
+        return leerEn(posicion + TAMANO_ENCABEZADO_BLOQUE_HISTORICO, contenido.data(), bloque.longitud) &&
+               static_cast<uint32_t>(sumaFNV1a(contenido.data(), contenido.size())) == suma;
+    }
+
+    // Recorre los registros desde el bloque primerBloque, salteando los bloques sin carros en [desdeDia,
+    // hastaDia]; visitante(registro, numero) devuelve false para terminar
+    template <typename Visitante>
+    bool recorrerDesde(size_t primerBloque, int32_t desdeDia, int32_t hastaDia, Visitante visitante) const {
+        std::string contenido;
+        CodificadorHistorico decodificador(especialistas);
+        RegistroHistorico registro;
+        for (size_t i = primerBloque; i < bloques.size(); ++i) {
+            const BloqueHistorico& bloque = bloques[i];
+            if (bloque.ultimoDia < desdeDia || bloque.primerDia > hastaDia) {
+                continue;
+            }
+            BloqueHistorico leido;
+            if (!leerBloque(bloque.posicion, longitudArchivo, leido, contenido)) {
+                return false;
+            }
+            LectorBinario lector(contenido.data(), contenido.size());
+            decodificador.reiniciar();
+            for (uint32_t j = 0; j < bloque.registros; ++j) {
+                if (!decodificador.leer(lector, registro)) {
+                    return false;
+                }
+                int32_t dia = registro.fechaSalida.getDia();
+                if (dia >= desdeDia && dia <= hastaDia && !visitante(registro, bloque.primerRegistro + j)) {
+                    return true;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    explicit ArchivoHistorico(TablaEspecialistas& especialistas) : especialistas(especialistas) {}
+
+    bool abierto() const { return descriptor >= 0; }
+    const std::string& getRuta() const { return ruta; }
+
+    // Abre o crea el archivo y descarta un bloque incompleto o dañado al final (caída a mitad de una escritura)
+    bool abrir(const std::string& rutaArchivo) {
+        ruta = rutaArchivo;
+        descriptor = open(ruta.c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat informacion;
+        if (descriptor < 0 || fstat(descriptor, &informacion) != 0) {
+            std::cout << "No se pudo abrir el archivo histórico " << ruta << "." << std::endl;
+            cerrar();
+            return false;
+        }
+        uint64_t longitud = informacion.st_size;
+
+        char cabecera[TAMANO_CABECERA_HISTORICO];
+        if (longitud < TAMANO_CABECERA_HISTORICO) {
+            // Archivo nuevo, o que quedó a medio crear sin registros
+            EscritorBinario nueva;
+            nueva.contenido().append(MAGIA_HISTORICO, sizeof(MAGIA_HISTORICO));
+            nueva.valor<uint32_t>(VERSION_HISTORICO);
+            if (ftruncate(descriptor, 0) != 0 || !escribirEn(0, nueva.contenido().data(), nueva.contenido().size()) ||
+                fdatasync(descriptor) != 0) {
+                std::cout << "No se pudo crear el archivo histórico " << ruta << "." << std::endl;
+                cerrar();
+                return false;
+            }
+            longitud = TAMANO_CABECERA_HISTORICO;
+        } else if (!leerEn(0, cabecera, sizeof(cabecera)) ||
+                   std::memcmp(cabecera, MAGIA_HISTORICO, sizeof(MAGIA_HISTORICO)) != 0 ||
+                   LectorBinario(cabecera + sizeof(MAGIA_HISTORICO), 4).valor<uint32_t>() != VERSION_HISTORICO) {
+            std::cout << "El archivo " << ruta << " no es un archivo histórico soportado." << std::endl;
+            cerrar();
+            return false;
+        }
+
+        bloques.clear();
+        registrosEnDisco = 0;
+        uint64_t posicion = TAMANO_CABECERA_HISTORICO;
+        std::string contenido;
+        BloqueHistorico bloque;
+        while (leerBloque(posicion, longitud, bloque, contenido)) {
+            bloque.primerRegistro = registrosEnDisco;
+            bloques.push_back(bloque);
+            registrosEnDisco += bloque.registros;
+            posicion += TAMANO_ENCABEZADO_BLOQUE_HISTORICO + bloque.longitud;
+        }
+        if (posicion < longitud) {
+            if (ftruncate(descriptor, posicion) != 0) {
+                std::cout << "No se pudo recortar el archivo histórico " << ruta << "." << std::endl;
+                cerrar();
+                return false;
+            }
+            std::cout << "Se descartaron " << longitud - posicion
+                      << " bytes incompletos o dañados al final del archivo histórico." << std::endl;
+        }
+        longitudArchivo = posicion;
+        return true;
+    }
+
+    void agregar(const RegistroHistorico& registro) {
+        int32_t dia = registro.fechaSalida.getDia();
+        if (registrosPendientes == 0) {
+            codificador.reiniciar();
+            primerDiaPendiente = ultimoDiaPendiente = dia;
+        }
+        codificador.escribir(pendiente, registro);
+        primerDiaPendiente = std::min(primerDiaPendiente, dia);
+        ultimoDiaPendiente = std::max(ultimoDiaPendiente, dia);
+        registrosPendientes++;
+        if (pendiente.contenido().size() >= TAMANO_BLOQUE_HISTORICO) {
+            confirmar();
+        }
+    }
+
+    // Escribe el bloque en curso al final del archivo y espera a que llegue al disco
+    bool confirmar() {
+        if (!abierto() || registrosPendientes == 0) {
+            return true;
+        }
+        const std::string& contenido = pendiente.contenido();
+        EscritorBinario encabezado;
+        encabezado.valor<uint32_t>(static_cast<uint32_t>(contenido.size()));
+        encabezado.valor<uint32_t>(registrosPendientes);
+        encabezado.valor<int32_t>(primerDiaPendiente);
+        encabezado.valor<int32_t>(ultimoDiaPendiente);
+        encabezado.valor<uint32_t>(static_cast<uint32_t>(sumaFNV1a(contenido.data(), contenido.size())));
+        const std::string& datosEncabezado = encabezado.contenido();
+        if (!escribirEn(longitudArchivo, datosEncabezado.data(), datosEncabezado.size()) ||
+            !escribirEn(longitudArchivo + datosEncabezado.size(), contenido.data(), contenido.size()) ||
+            fdatasync(descriptor) != 0) {
+            std::cout << "No se pudo escribir el archivo histórico " << ruta << "." << std::endl;
+            return false;
+        }
+        bloques.push_back({longitudArchivo, static_cast<uint32_t>(contenido.size()), registrosPendientes,
+                           registrosEnDisco, primerDiaPendiente, ultimoDiaPendiente});
+        longitudArchivo += datosEncabezado.size() + contenido.size();
+        registrosEnDisco += registrosPendientes;
+        pendiente.recortar(0);
+        registrosPendientes = 0;
+        return true;
+    }
+
+    // Deja en el archivo solo los primeros registros; si el corte cae dentro de un bloque, los registros
+    // de ese bloque que quedan se vuelven a escribir en un bloque nuevo
+    bool recortar(uint64_t registros) {
+        if (!confirmar()) {
+            return false;
+        }
+        if (registros >= registrosEnDisco) {
+            return true;
+        }
+        size_t primero = 0;
+        while (bloques[primero].primerRegistro + bloques[primero].registros <= registros) {
+            primero++;
+        }
+        std::vector<RegistroHistorico> conservados;
+        if (!recorrerDesde(primero, INT32_MIN, INT32_MAX, [&](const RegistroHistorico& registro, uint64_t numero) {
+                if (numero >= registros) {
+                    return false;
+                }
+                conservados.push_back(registro);
+                return true;
+            })) {
+            std::cout << "No se pudo leer el archivo histórico " << ruta << "." << std::endl;
+            return false;
+        }
+        const BloqueHistorico& bloque = bloques[primero];
+        if (ftruncate(descriptor, bloque.posicion) != 0 || fdatasync(descriptor) != 0) {
+            std::cout << "No se pudo recortar el archivo histórico " << ruta << "." << std::endl;
+            return false;
+        }
+        longitudArchivo = bloque.posicion;
+        registrosEnDisco = bloque.primerRegistro;
+        bloques.resize(primero);
+        for (const RegistroHistorico& registro : conservados) {
+            agregar(registro);
+        }
+        return confirmar();
+    }
+
+    // visitante(registro, numero) recibe los registros con salida en [desdeDia, hastaDia] y devuelve false
+    // para terminar; los registros pendientes se confirman antes de leer
+    template <typename Visitante>
+    bool recorrer(int32_t desdeDia, int32_t hastaDia, Visitante visitante) {
+        return confirmar() && recorrerDesde(0, desdeDia, hastaDia, visitante);
+    }
+
+    void cerrar() {
+        confirmar();
+        if (abierto()) {
+            close(descriptor);
+            descriptor = -1;
+        }
+    }
+
+    uint64_t getRegistros() const { return registrosEnDisco + registrosPendientes; }
+    uint64_t getBytes() const { return longitudArchivo + pendiente.tamano(); }
+};
+
+const char MAGIA_DIARIO[8] = {'P', 'L', 'N', 'T', 'D', 'I', 'A', 'R'};
+const uint32_t VERSION_DIARIO = 1;
+const size_t TAMANO_CABECERA_DIARIO = 8 + 4 + 4;
+const size_t TAMANO_ENCABEZADO_REGISTRO = 4 + 4;
+const size_t TAMANO_GRUPO_DIARIO = 1 << 18;    // Se confirma el grupo al acumular 256 KiB
+
+enum class OperacionDiario : uint8_t { AltaMotor = 1, Ensamblaje = 2, Baja = 3, Archivo = 4 };
+
+class DiarioOperaciones {
+private:
+    ArchivoHistorico& historico;    // Se confirma antes que cada grupo del diario
+    int descriptor = -1;
+    EscritorBinario pendiente;
+    size_t inicioRegistro = 0;
+    size_t registrosPendientes = 0;
+    long gruposConfirmados = 0;
+    long registrosConfirmados = 0;
+
+public:
+    explicit DiarioOperaciones(ArchivoHistorico& historico) : historico(historico) {}
+
+    bool abierto() const { return descriptor >= 0; }
+
+    bool abrir(const std::string& ruta) {
+        descriptor = open(ruta.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        return descriptor >= 0;
+    }
+
+    EscritorBinario& iniciarRegistro(OperacionDiario operacion) {
+        inicioRegistro = pendiente.contenido().size();
+        pendiente.valor<uint32_t>(0);
+        pendiente.valor<uint32_t>(0);
+        pendiente.valor<uint8_t>(static_cast<uint8_t>(operacion));
+        return pendiente;
+    }
+
+    void terminarRegistro() {
+        if (!pendiente.esCorrecto()) {
+            pendiente.recortar(inicioRegistro);
+            std::cout << "No se pudo registrar la operación en el diario (campo demasiado largo)." << std::endl;
+            return;
+        }
+        std::string& datos = pendiente.contenido();
+        const char* contenido = datos.data() + inicioRegistro + TAMANO_ENCABEZADO_REGISTRO;
+        uint32_t longitud = static_cast<uint32_t>(datos.size() - inicioRegistro - TAMANO_ENCABEZADO_REGISTRO);
+        uint32_t suma = static_cast<uint32_t>(sumaFNV1a(contenido, longitud));
+        std::memcpy(&datos[inicioRegistro], &longitud, sizeof(longitud));
+        std::memcpy(&datos[inicioRegistro + sizeof(longitud)], &suma, sizeof(suma));
+        registrosPendientes++;
+
+        if (datos.size() >= TAMANO_GRUPO_DIARIO) {
+            confirmar();
+        }
+    }
+
+    // Escribe el grupo pendiente y espera a que llegue al disco
+    bool confirmar() {
+        if (!abierto() || registrosPendientes == 0) {
+            return true;
+        }
+        if (!historico.confirmar()) {
+            return false;
+        }
+        const std::string& datos = pendiente.contenido();
+        size_t escritos = 0;
+        while (escritos < datos.size()) {
+            ssize_t n = write(descriptor, datos.data() + escritos, datos.size() - escritos);
+            if (n <= 0) {
+                std::cout << "No se pudo escribir el diario de operaciones." << std::endl;
+                return false;
+            }
+            escritos += n;
+        }
+        if (fdatasync(descriptor) != 0) {
+            std::cout << "No se pudo sincronizar el diario de operaciones." << std::endl;
+            return false;
+        }
+        gruposConfirmados++;
+        registrosConfirmados += registrosPendientes;
+        pendiente.recortar(0);
+        registrosPendientes = 0;
+        return true;
+    }
+
+    // Vacía el diario y escribe la cabecera de una generación nueva; lo pendiente queda descartado
+    bool reiniciar(uint32_t generacion) {
+        pendiente.recortar(0);
+        registrosPendientes = 0;
+        gruposConfirmados = 0;
+        registrosConfirmados = 0;
+        EscritorBinario cabecera;
+        cabecera.contenido().append(MAGIA_DIARIO, sizeof(MAGIA_DIARIO));
+        cabecera.valor<uint32_t>(VERSION_DIARIO);
+        cabecera.valor<uint32_t>(generacion);
+        const std::string& datos = cabecera.contenido();
+        return ftruncate(descriptor, 0) == 0 &&
+               write(descriptor, datos.data(), datos.size()) == static_cast<ssize_t>(datos.size()) &&
+               fdatasync(descriptor) == 0;
+    }
+
+    // Deja en el archivo solo los registros reproducidos, que cuentan como ya confirmados
+    bool recortarArchivo(size_t longitud, long registrosReproducidos) {
+        registrosConfirmados = registrosReproducidos;
+        return ftruncate(descriptor, longitud) == 0 && fdatasync(descriptor) == 0;
+    }
+
+    void cerrar() {
+        confirmar();
+        if (abierto()) {
+            close(descriptor);
+            descriptor = -1;
+        }
+    }
+
+    // Operaciones y grupos desde la última compactación
+    long getRegistros() const { return registrosConfirmados + static_cast<long>(registrosPendientes); }
+    long getGruposConfirmados() const { return gruposConfirmados; }
+};
+
+// Aplica solo a Formula1, Sport y Ómnibus. La disminución es la diferencia entre el precio con un
+// reensamblaje menos y el actual; se calcula en forma cerrada, sin tocar los motores.
+// carro(i) devuelve el carro i de los cantidad carros a recorrer.
+template <typename Acceso>
+std::vector<CarroReensamblado> buscarCarrosReensamblados(size_t cantidad, Acceso carro) {
+    size_t bloques = contarBloques(cantidad);
+    std::vector<std::vector<CarroReensamblado>> parciales(bloques);
+    ejecutarPorBloques(bloques, [&](size_t bloque) {
+        size_t inicio = bloque * BLOQUE_REPORTE;
+        size_t fin = std::min(inicio + BLOQUE_REPORTE, cantidad);
+        for (size_t i = inicio; i < fin; ++i) {
+            const Carro& actual = carro(i);
+            if (actual.getMotor()->getVecesReensamblado() > 0 && actual.getTipo() != TipoCarro::DeLujo) {
+                parciales[bloque].push_back({&actual, -calcularSensibilidadPrecio(actual).variacionPorReensamblaje});
+            }
+        }
+    });
+
+    std::vector<CarroReensamblado> carros;
+    for (const auto& parcial : parciales) {
+        carros.insert(carros.end(), parcial.begin(), parcial.end());
+    }
+    return carros;
+}
+
+struct ElementoClasificado;
+
+class InventarioPlanta {
+public:
+    InventarioPlanta() = default;
+    InventarioPlanta(const InventarioPlanta&) = delete;
+    InventarioPlanta& operator=(const InventarioPlanta&) = delete;
+    ~InventarioPlanta();
+
+    // Operaciones
+    Resultado agregarMotor(const DatosMotor& motor);
+    Resultado ensamblarCarro(const PedidoCarro& pedido);
+    AsignacionLote ensamblarLote(const std::vector<PedidoCarro>& pedidos);
+    Resultado darDeBajaCarro(std::string_view codigoMotor);
+    CarrosArchivados archivarCarros(Fecha corte);    // Los de fecha de salida anterior al corte
+    ResumenImportacion importar(const std::string& ruta);
+    const char* importarLinea(std::string_view linea);    // nullptr si se cargó; si no, el motivo del rechazo
+
+    // Consultas
+    bool existeMotor(std::string_view codigo) const;
+    bool hayMotorDisponible(TipoMotor tipo) const;
+    bool hayMotorArtesanalDisponible() const;
+    size_t cantidadMotoresDisponibles(TipoMotor tipo) const;
+    MotoresDisponibles motoresDisponibles() const;
+    std::vector<const Carro*> carrosAltaVelocidad() const;
+    const Carro* omnibusMayorCapacidad() const;
+    const std::vector<Carro*>& carros() const;
+
+    // Clasificaciones de los k primeros, del primero al último
+    std::vector<CarroClasificado> carrosMasRentables(size_t k, std::optional<TipoCarro> tipo = std::nullopt) const;
+    std::vector<CarroClasificado> carrosMasRapidos(size_t k) const;
+    std::vector<CarroClasificado> omnibusDeMayorCapacidad(size_t k) const;
+    std::vector<MotorClasificado> motoresMasBaratos(TipoMotor tipo, size_t k) const;
+
+    std::vector<CarroReensamblado> carrosConMotoresReensamblados() const;
+    CumplimientoPlan cumplimientoPlan() const;
+    ProduccionPeriodo produccionEntre(Fecha desde, Fecha hasta) const;
+    std::vector<CumplimientoMensual> cumplimientoMensual(int anio, int hastaMes = 12) const;
+    ProyeccionPlan proyeccionPlan(Fecha corte) const;
+    GananciasPorTipo ganancias() const;
+    TableroProduccion tablero() const;
+    ComparacionAgregados compararAgregados() const;
+    std::vector<EstadisticasPool> estadisticasMemoria() const;
+    std::vector<EstadisticasEspecialista> estadisticasEspecialistas() const;
+
+    int getPlanMotoresAnual() const { return planMotoresAnual; }
+    int getPlanCarrosAnual() const { return planCarrosAnual; }
+    long getMotoresProducidos() const { return motoresProducidos; }
+    long getCarrosProducidos() const { return carrosProducidos; }
+
+    // Archivo histórico: visitante(carro) recibe cada carro de la clase con salida en [desde, hasta], leído
+    // del disco, y devuelve false para terminar; la consulta devuelve false si no se pudo leer el archivo
+    ResumenHistorico resumenHistorico() const;
+    template <typename Visitante>
+    bool recorrerHistorico(ClaseHistorico clase, Fecha desde, Fecha hasta, Visitante visitante) const;
+
+    // Estado persistente (--estado): carga la instantánea de la ruta si existe, abre ruta.historico y
+    // reproduce ruta.diario. Desde entonces cada operación se registra en el diario.
+    bool abrirEstado(const std::string& ruta);
+    bool tieneEstado() const { return !archivoEstado.empty(); }
+    void cerrarEstado();    // Compacta el diario en una instantánea nueva y lo cierra
+    bool guardarInstantanea(const std::string& ruta);
+    bool cargarInstantanea(const std::string& ruta);
+    bool compactarDiario();
+    void confirmarDiario();
+    void cerrarDiario();
+
+    // Archivo histórico sin estado persistente (--historico), o antes de reproducir el diario
+    bool abrirArchivoHistorico(const std::string& ruta);
+    bool conciliarArchivoHistorico(bool estadoExistente, uint64_t registrosInstantanea);
+    bool recortarHistorico(uint64_t registros);    // Deja en el archivo solo los primeros registros
+
+    // Representaciones adicionales de los carros, mantenidas a la par de carros()
+    void activarAlmacenColumnar();
+    bool usaAlmacenColumnar() const { return usarAlmacenColumnar; }
+    void activarEspejoCarros();
+    std::shared_ptr<const VersionCarros> publicarEspejoCarros();
+
+    // Compara los agregados con un recálculo completo después de cada modificación (--verificar-agregados)
+    void setVerificarAgregadosSiempre(bool verificar) { verificarAgregadosSiempre = verificar; }
+
+    // Destruye todos los motores y carros y reinicia los contadores de producción
+    void liberarInventario();
+
+private:
+    // Plan de producción anual
+    int planMotoresAnual = 1000;
+    int planCarrosAnual = 500;
+
+    // Contadores de producción
+    ContadorProduccion motoresProducidos;
+    ContadorProduccion carrosProducidos;
+
+    // Inventarios
+    std::vector<MotorAlta*> motoresAltaDisponibles;
+    std::vector<MotorFuerza*> motoresFuerzaDisponibles;
+    InventarioMotoresTrabajo motoresTrabajoDisponibles;
+
+    std::vector<Carro*> carrosEnsamblados;
+
+    // Pools donde viven todos los motores y carros
+    PoolObjetos<MotorAlta> poolMotoresAlta;
+    PoolObjetos<MotorFuerza> poolMotoresFuerza;
+    PoolObjetos<MotorTrabajo> poolMotoresTrabajo;
+    PoolObjetos<Formula1> poolFormula1;
+    PoolObjetos<Omnibus> poolOmnibus;
+    PoolObjetos<Sport> poolSport;
+    PoolObjetos<DeLujo> poolDeLujo;
+
+    std::unordered_map<CodigoMotor, EntradaIndiceMotor, ResumenCodigoMotor> indiceMotores;
+
+    // Códigos de los motores que salieron de la planta en carros archivados, ordenados: siguen reservados
+    std::vector<CodigoMotor> codigosArchivados;
+
+    // Registros que el estado de la planta generó para el archivo histórico (se guarda en la instantánea)
+    uint64_t registrosHistoricos = 0;
+
+    TablaEspecialistas especialistas;
+
+    bool usarAlmacenColumnar = false;    // Se activa con --columnar
+    AlmacenColumnarCarros almacenColumnar;
+
+    bool usarEspejoCarros = false;    // Se activa al iniciar el servicio
+    EspejoCarros espejoCarros;
+
+    AgregadosProduccion agregados;
+    bool verificarAgregadosSiempre = false;
+
+    IndiceProduccion produccionMotores;
+    IndiceProduccion produccionCarros;
+
+    std::string archivoEstado;        // Instantánea que se carga al iniciar y se guarda al salir (--estado)
+    uint32_t generacionDiario = 0;    // Generación del diario que continúa la instantánea cargada o guardada
+
+    // Las consultas confirman el bloque en curso del archivo histórico antes de leerlo
+    mutable ArchivoHistorico archivoHistorico{especialistas};
+    ResumenHistorico totalesHistorico = {};    // Totales del archivo (sin abierto, registros ni bytes)
+
+    DiarioOperaciones diario{archivoHistorico};
+    std::string archivoDiario;
+
+    bool motorArchivado(const CodigoMotor& codigo) const;
+
+    // Altas y ensamblajes (las operaciones públicas los despachan por tipo)
+    Resultado validarMotorNuevo(std::string_view codigo, std::string_view fechaSalida, CodigoMotor& codigoMotor,
+                                Fecha& fecha) const;
+    EntradaIndiceMotor& registrarMotorNuevo(Motor* motor);
+    Resultado altaMotorAlta(std::string_view codigo, std::string_view fechaSalida, std::string_view especialista,
+                            int vecesReensamblado, double maxRPM, double consumo);
+    Resultado altaMotorFuerza(std::string_view codigo, std::string_view fechaSalida, std::string_view especialista,
+                              int vecesReensamblado, int caballosFuerza);
+    Resultado altaMotorTrabajo(std::string_view codigo, std::string_view fechaSalida, std::string_view especialista,
+                               int vecesReensamblado, bool artesanal);
+    Resultado ensamblarFormula1(std::string_view fechaSalida, double velocidad, double pesoCarroceria);
+    Resultado ensamblarOmnibus(std::string_view fechaSalida, double velocidad, int cantidadPuertas);
+    Resultado ensamblarSport(std::string_view fechaSalida, double velocidad, int cantidadPlazas,
+                             int cantidadVelocidades, bool cambioUniversal);
+    Resultado ensamblarDeLujo(std::string_view fechaSalida, double velocidad, int cantidadPlazas, double costoTapiceria);
+
+    // Ensamblaje con un motor ya elegido (lotes y reproducción del diario)
+    Carro* armarCarro(const PedidoCarro& pedido, Fecha fechaSalida, Motor* motor);
+    Resultado ensamblarConMotor(const PedidoCarro& pedido, std::string_view codigoMotor);
+    double gananciaAsignacionHabitual(const std::vector<PedidoCarro>& pedidos, const std::vector<Resultado>& resultados,
+                                      const std::vector<MotorTrabajo*>& trabajo) const;
+
+    void registrarCarroEnsamblado(Carro* carro, EntradaIndiceMotor* entrada = nullptr);
+    void quitarCarroEnsamblado(size_t posicion);
+    void destruirCarro(Carro* carro);
+    void destruirMotor(Motor* motor);
+    Resultado retirarCarro(std::string_view codigoMotor);
+    void verificarAgregados() const;
+
+    // Clasificaciones
+    template <typename Incluir, typename Valor>
+    std::vector<ElementoClasificado> mejoresCarros(size_t k, Incluir incluir, Valor valor) const;
+    std::vector<CarroClasificado> carrosClasificados(const std::vector<ElementoClasificado>& elementos) const;
+
+    // Instantánea
+    EntradaIndiceMotor& restaurarMotor(TipoMotor tipo, bool montado, const CodigoMotor& codigo, Fecha fechaSalida,
+                                       const Especialista* especialista, int veces, double valor1, double valor2,
+                                       bool artesanal);
+    void restaurarCarro(TipoCarro tipo, EntradaIndiceMotor& entrada, int cantidadPlazas, double velocidad,
+                        Fecha fechaSalida, double valor, bool cambioUniversal);
+    bool restaurarRegistros(LectorBinario& lector, uint64_t cantidadMotores, uint64_t cantidadCarros,
+                            size_t longitudCuerpo);
+    bool restaurarInstantanea(const char* datos, size_t longitud);
+
+    // Diario de operaciones (las operaciones lo registran si está abierto)
+    bool abrirDiario(const std::string& ruta);
+    void registrarAltaEnDiario(const Motor* motor);
+    void registrarEnsamblajeEnDiario(const Carro* carro);
+    void registrarBajaEnDiario(std::string_view codigoMotor);
+    void registrarArchivoEnDiario(Fecha corte);
+    bool aplicarRegistroDiario(LectorBinario& lector);
+
+    // Archivo histórico (las bajas se agregan a él si está abierto)
+    void agregarAlHistorico(const RegistroHistorico& registro);
+    void registrarRetiroEnHistorico(const Carro* carro);
+    CarrosArchivados archivarCarrosAnteriores(Fecha corte);
+    bool cargarTotalesHistorico(uint64_t registrosInstantanea);
+
+    // Importación masiva
+    const char* importarRegistro(std::string_view linea, ResumenImportacion& resumen);
+    ResumenImportacion importarArchivo(const std::string& ruta);
+};
+
+template <typename Visitante>
+bool InventarioPlanta::recorrerHistorico(ClaseHistorico clase, Fecha desde, Fecha hasta, Visitante visitante) const {
+    MedicionLatencia medicion(OperacionPlanta::ConsultarHistorico);
+    OperacionTrazada traza(OperacionPlanta::ConsultarHistorico, clase, desde, hasta);
+    return archivoHistorico.recorrer(desde.getDia(), hasta.getDia(),
+                                     [&](const RegistroHistorico& registro, uint64_t) {
+                                         return registro.clase != clase || visitarRegistroHistorico(registro, visitante);
+                                     });
+}
+
+// Lee un lote de pedidos: registros CARRO con el formato del archivo de importación. Devuelve false si no
+// se pudo abrir; los registros con errores de formato se cuentan en rechazados y no entran al lote.
+bool leerLotePedidos(const std::string& ruta, std::vector<PedidoCarro>& pedidos, long& rechazados);
+
+// Muestra las diferencias entre los agregados incrementales y un recálculo completo del inventario
+void mostrarDiferenciasAgregados(const ComparacionAgregados& comparacion);
+
+// Grabación de la carga de trabajo (el formato se describe con el grabador, en InventarioPlanta.cpp)
+
+const char MAGIA_TRAZA[8] = {'P', 'L', 'N', 'T', 'T', 'R', 'A', 'Z'};
+const uint32_t VERSION_TRAZA = 1;
+const size_t TAMANO_CABECERA_TRAZA = 8 + 4;
+const size_t TAMANO_BLOQUE_TRAZA = 1 << 16;
+
+void escribirCampoTraza(EscritorBinario& escritor, const DatosMotor& motor);
+void escribirCampoTraza(EscritorBinario& escritor, const PedidoCarro& pedido);
+void escribirCampoTraza(EscritorBinario& escritor, const std::vector<PedidoCarro>& pedidos);
+void escribirCampoTraza(EscritorBinario& escritor, std::string_view texto);
+void escribirCampoTraza(EscritorBinario& escritor, Fecha fecha);
+void escribirCampoTraza(EscritorBinario& escritor, int valor);
+void escribirCampoTraza(EscritorBinario& escritor, size_t valor);
+void escribirCampoTraza(EscritorBinario& escritor, std::optional<TipoCarro> tipo);
+void escribirCampoTraza(EscritorBinario& escritor, TipoMotor tipo);
+void escribirCampoTraza(EscritorBinario& escritor, ClaseHistorico clase);
+void escribirCampoTraza(EscritorBinario& escritor, ClasificacionTrazada clasificacion);
+
+// Agrega a la traza un registro con los datos ya codificados
+void agregarRegistroTraza(OperacionPlanta operacion, const std::string& datos);
+
+template <typename... Datos>
+void grabarEnTraza(OperacionPlanta operacion, const Datos&... datos) {
+    EscritorBinario registro;
+    (escribirCampoTraza(registro, datos), ...);
+    // Un campo demasiado largo para la traza es una entrada que la planta rechaza: se omite la operación
+    if (registro.esCorrecto()) {
+        agregarRegistroTraza(operacion, registro.contenido());
+    }
+}
+
+bool iniciarGrabacionTraza();
+void terminarGrabacionTraza();
+
+#endif
@@ -1,345 +1,17 @@
-#include <iostream>
-#include <string>
-#include <vector>
-#include <ctime>
-#include <memory>
-
-// Clases de motores
-
-class Motor {
-protected:
-    std::string codigo;             // Código único de 12 caracteres
-    std::string fechaSalida;        // Fecha de salida del área de ensamblaje
-    std::string especialista;       // Nombre del especialista que realizó la certificación
-    int vecesReensamblado;          // Veces que ha regresado al área de ensamblaje por defectos
-
-public:
-    // Constructor
-    Motor(std::string codigo, std::string fechaSalida, std::string especialista, int vecesReensamblado)
-        : codigo(codigo), fechaSalida(fechaSalida), especialista(especialista), vecesReensamblado(vecesReensamblado) {}
-
-    // Métodos getters y setters
-    std::string getCodigo() const { return codigo; }
-    void setCodigo(const std::string& codigo) { this->codigo = codigo; }
-
-    std::string getFechaSalida() const { return fechaSalida; }
-    void setFechaSalida(const std::string& fechaSalida) { this->fechaSalida = fechaSalida; }
-
-    std::string getEspecialista() const { return especialista; }
-    void setEspecialista(const std::string& especialista) { this->especialista = especialista; }
-
-    int getVecesReensamblado() const { return vecesReensamblado; }
-    void setVecesReensamblado(int veces) { vecesReensamblado = veces; }
-
-    // Método virtual para calcular el costo (será sobreescrito en las clases derivadas)
-    virtual double calcularCosto() const = 0;
-
-    // Método virtual para mostrar información del motor
-    virtual void mostrarFichaTecnica() const;
-};
-
-void Motor::mostrarFichaTecnica() const {
-    std::cout << "Código: " << codigo << std::endl;
-    std::cout << "Fecha de salida: " << fechaSalida << std::endl;
-    std::cout << "Especialista: " << especialista << std::endl;
-    std::cout << "Veces reensamblado: " << vecesReensamblado << std::endl;
-}
-
-// Clases derivadas de Motor
-
-class MotorAlta : public Motor {
-private:
-    double maxRPM;    // Máximas revoluciones por minuto
-    double consumo;   // Consumo en km por litro
-
-public:
-    // Constructor
-    MotorAlta(std::string codigo, std::string fechaSalida, std::string especialista, int vecesReensamblado,
-              double maxRPM, double consumo)
-        : Motor(codigo, fechaSalida, especialista, vecesReensamblado), maxRPM(maxRPM), consumo(consumo) {}
-
-    // Métodos getters y setters
-    double getMaxRPM() const { return maxRPM; }
-    void setMaxRPM(double rpm) { maxRPM = rpm; }
-
-    double getConsumo() const { return consumo; }
-    void setConsumo(double consumo) { this->consumo = consumo; }
-
-    // Sobrescribir el método para calcular el costo
-    double calcularCosto() const override {
-        return (maxRPM * 1.5 + consumo) - 100 * vecesReensamblado;
-    }
-
-    // Sobrescribir el método para mostrar información
-    void mostrarFichaTecnica() const override;
-};
-
-void MotorAlta::mostrarFichaTecnica() const {
-    Motor::mostrarFichaTecnica();
-    std::cout << "Máximas RPM: " << maxRPM << std::endl;
-    std::cout << "Consumo (km/l): " << consumo << std::endl;
-    std::cout << "Costo: " << calcularCosto() << std::endl;
-}
-
-class MotorFuerza : public Motor {
-private:
-    int caballosFuerza;    // Caballos de fuerza (entre 80 y 4000)
-
-public:
-    // Constructor
-    MotorFuerza(std::string codigo, std::string fechaSalida, std::string especialista, int vecesReensamblado,
-                int caballosFuerza)
-        : Motor(codigo, fechaSalida, especialista, vecesReensamblado), caballosFuerza(caballosFuerza) {}
-
-    // Métodos getters y setters
-    int getCaballosFuerza() const { return caballosFuerza; }
-    void setCaballosFuerza(int caballos) { caballosFuerza = caballos; }
-
-    // Sobrescribir el método para calcular el costo
-    double calcularCosto() const override {
-        return (caballosFuerza) * (5 - 100 * vecesReensamblado);
-    }
-
-    // Sobrescribir el método para mostrar información
-    void mostrarFichaTecnica() const override;
-};
-
-void MotorFuerza::mostrarFichaTecnica() const {
-    Motor::mostrarFichaTecnica();
-    std::cout << "Caballos de fuerza: " << caballosFuerza << std::endl;
-    std::cout << "Costo: " << calcularCosto() << std::endl;
-}
-
-class MotorTrabajo : public Motor {
-private:
-    bool artesanal;    // Indica si es artesanal (true) o no (false)
-
-public:
-    // Constructor
-    MotorTrabajo(std::string codigo, std::string fechaSalida, std::string especialista, int vecesReensamblado,
-                 bool artesanal)
-        : Motor(codigo, fechaSalida, especialista, vecesReensamblado), artesanal(artesanal) {}
-
-    // Métodos getters y setters
-    bool esArtesanal() const { return artesanal; }
-    void setArtesanal(bool artesanal) { this->artesanal = artesanal; }
-
-    // Sobrescribir el método para calcular el costo
-    double calcularCosto() const override {
-        double costo = 1000 - (100 * vecesReensamblado);
-        if (artesanal) {
-            costo *= 10;    // Aumenta su costo 10 veces si es artesanal
-        }
-        return costo;
-    }
-
-    // Sobrescribir el método para mostrar información
-    void mostrarFichaTecnica() const override;
-};
-
-void MotorTrabajo::mostrarFichaTecnica() const {
-    Motor::mostrarFichaTecnica();
-    std::cout << "Artesanal: " << (artesanal ? "Sí" : "No") << std::endl;
-    std::cout << "Costo: " << calcularCosto() << std::endl;
-}
-
-// Clases de carros
-
-class Carro {
-protected:
-    Motor* motor;                  // Motor incorporado
-    int cantidadPlazas;            // Cantidad de plazas
-    double velocidad;              // Velocidad del vehículo en km/h
-    std::string fechaSalida;       // Fecha de salida de la planta
-
-public:
-    // Constructor
-    Carro(Motor* motor, int cantidadPlazas, double velocidad, std::string fechaSalida)
-        : motor(motor), cantidadPlazas(cantidadPlazas), velocidad(velocidad), fechaSalida(fechaSalida) {}
-
-    // Métodos getters y setters
-    Motor* getMotor() const { return motor; }
-    void setMotor(Motor* motor) { this->motor = motor; }
-
-    int getCantidadPlazas() const { return cantidadPlazas; }
-    void setCantidadPlazas(int plazas) { cantidadPlazas = plazas; }
-
-    double getVelocidad() const { return velocidad; }
-    void setVelocidad(double velocidad) { this->velocidad = velocidad; }
-
-    std::string getFechaSalida() const { return fechaSalida; }
-    void setFechaSalida(const std::string& fecha) { fechaSalida = fecha; }
-
-    // Método virtual para calcular el precio de venta
-    virtual double calcularPrecioVenta() const = 0;
-
-    // Método virtual para mostrar la ficha técnica
-    virtual void mostrarFichaTecnica() const;
-};
-
-void Carro::mostrarFichaTecnica() const {
-    std::cout << "Fecha de salida: " << fechaSalida << std::endl;
-    std::cout << "Cantidad de plazas: " << cantidadPlazas << std::endl;
-    std::cout << "Velocidad: " << velocidad << " km/h" << std::endl;
-    std::cout << "--- Ficha técnica del motor ---" << std::endl;
-    motor->mostrarFichaTecnica();
-}
-
-class Formula1 : public Carro {
-private:
-    double pesoCarroceria;    // Peso de la carrocería
-
-public:
-    // Constructor
-    Formula1(MotorAlta* motor, double velocidad, std::string fechaSalida, double pesoCarroceria)
-        : Carro(motor, 1, velocidad, fechaSalida), pesoCarroceria(pesoCarroceria) {}
-
-    // Métodos getters y setters
-    double getPesoCarroceria() const { return pesoCarroceria; }
-    void setPesoCarroceria(double peso) { pesoCarroceria = peso; }
-
-    // Sobrescribir el método para calcular el precio de venta
-    double calcularPrecioVenta() const override {
-        return velocidad * 5 + 1 / pesoCarroceria + motor->calcularCosto();
-    }
-
-    // Sobrescribir el método para mostrar la ficha técnica
-    void mostrarFichaTecnica() const override;
-};
-
-void Formula1::mostrarFichaTecnica() const {
-    std::cout << "--- Ficha técnica del Formula1 ---" << std::endl;
-    Carro::mostrarFichaTecnica();
-    std::cout << "Peso de la carrocería: " << pesoCarroceria << " kg" << std::endl;
-    std::cout << "Precio de venta: " << calcularPrecioVenta() << std::endl;
-}
-
-class Omnibus : public Carro {
-private:
-    int cantidadPuertas;    // Cantidad de puertas
-
-public:
-    // Constructor
-    Omnibus(MotorFuerza* motor, double velocidad, std::string fechaSalida, int cantidadPuertas)
-        : Carro(motor, 0, velocidad, fechaSalida), cantidadPuertas(cantidadPuertas) {
-        calcularCapacidad();
-    }
-
-    // Métodos getters y setters
-    int getCantidadPuertas() const { return cantidadPuertas; }
-    void setCantidadPuertas(int puertas) { cantidadPuertas = puertas; }
-
-    // Método para calcular la capacidad en función de los caballos de fuerza del motor
-    void calcularCapacidad() {
-        MotorFuerza* motorFuerza = dynamic_cast<MotorFuerza*>(motor);
-        if (motorFuerza) {
-            int caballos = motorFuerza->getCaballosFuerza();
-            cantidadPlazas = caballos / 10;    // Por cada 10 caballos de fuerza, 1 persona
-        }
-    }
-
-    // Sobrescribir el método para calcular el precio de venta
-    double calcularPrecioVenta() const override {
-        return (cantidadPuertas * 1.5 + motor->calcularCosto()) * 3;
-    }
-
-    // Sobrescribir el método para mostrar la ficha técnica
-    void mostrarFichaTecnica() const override;
-};
-
-void Omnibus::mostrarFichaTecnica() const {
-    std::cout << "--- Ficha técnica del Ómnibus ---" << std::endl;
-    Carro::mostrarFichaTecnica();
-    std::cout << "Cantidad de puertas: " << cantidadPuertas << std::endl;
-    std::cout << "Precio de venta: " << calcularPrecioVenta() << std::endl;
-}
-
-class Sport : public Carro {
-private:
-    int cantidadVelocidades;    // Cantidad de velocidades de la caja
-    bool cambioUniversal;       // Indicador de si es de cambio universal
-
-public:
-    // Constructor
-    Sport(MotorTrabajo* motor, int cantidadPlazas, double velocidad, std::string fechaSalida,
-          int cantidadVelocidades, bool cambioUniversal)
-        : Carro(motor, cantidadPlazas, velocidad, fechaSalida),
-          cantidadVelocidades(cantidadVelocidades), cambioUniversal(cambioUniversal) {}
-
-    // Métodos getters y setters
-    int getCantidadVelocidades() const { return cantidadVelocidades; }
-    void setCantidadVelocidades(int velocidades) { cantidadVelocidades = velocidades; }
-
-    bool esCambioUniversal() const { return cambioUniversal; }
-    void setCambioUniversal(bool cambio) { cambioUniversal = cambio; }
-
-    // Sobrescribir el método para calcular el precio de venta
-    double calcularPrecioVenta() const override {
-        double precio = cantidadVelocidades * 2 + motor->calcularCosto();
-        if (cambioUniversal) {
-            precio += 1000;
-        }
-        return precio;
-    }
-
-    // Sobrescribir el método para mostrar la ficha técnica
-    void mostrarFichaTecnica() const override;
-};
-
-void Sport::mostrarFichaTecnica() const {
-    std::cout << "--- Ficha técnica del Sport ---" << std::endl;
-    Carro::mostrarFichaTecnica();
-    std::cout << "Cantidad de velocidades: " << cantidadVelocidades << std::endl;
-    std::cout << "Cambio universal: " << (cambioUniversal ? "Sí" : "No") << std::endl;
-    std::cout << "Precio de venta: " << calcularPrecioVenta() << std::endl;
-}
-
-class DeLujo : public Carro {
-private:
-    double costoTapiceria;    // Costo de la tapicería
-
-public:
-    // Constructor
-    DeLujo(MotorTrabajo* motor, int cantidadPlazas, double velocidad, std::string fechaSalida,
-           double costoTapiceria)
-        : Carro(motor, cantidadPlazas, velocidad, fechaSalida), costoTapiceria(costoTapiceria) {}
-
-    // Métodos getters y setters
-    double getCostoTapiceria() const { return costoTapiceria; }
-    void setCostoTapiceria(double costo) { costoTapiceria = costo; }
-
-    // Sobrescribir el método para calcular el precio de venta
-    double calcularPrecioVenta() const override {
-        return (costoTapiceria + motor->calcularCosto()) * 10;
-    }
-
-    // Sobrescribir el método para mostrar la ficha técnica
-    void mostrarFichaTecnica() const override;
-};
-
-void DeLujo::mostrarFichaTecnica() const {
-    std::cout << "--- Ficha técnica del Carro de Lujo ---" << std::endl;
-    Carro::mostrarFichaTecnica();
-    std::cout << "Costo de la tapicería: " << costoTapiceria << std::endl;
-    std::cout << "Precio de venta: " << calcularPrecioVenta() << std::endl;
-}
-
-// Variables y contenedores globales
+#include "InventarioPlanta.h"
 
-// Plan de producción anual
-int planMotoresAnual = 1000;
-int planCarrosAnual = 500;
-
-// Contadores de producción
-int motoresProducidos = 0;
-int carrosProducidos = 0;
+#include <ctime>
+#include <random>
+#include <condition_variable>
+#include <sys/socket.h>
+#include <sys/un.h>
 
-// Inventarios
-std::vector<MotorAlta*> motoresAltaDisponibles;
-std::vector<MotorFuerza*> motoresFuerzaDisponibles;
-std::vector<MotorTrabajo*> motoresTrabajoDisponibles;
+const int MAX_OPCION_MENU = 30;
 
-std::vector<Carro*> carrosEnsamblados;
+std::string archivoMetricas;    // Destino de los volcados periódicos (--metricas)
+double intervaloMetricas = 10;    // Segundos entre volcados
+std::chrono::steady_clock::time_point ultimoVolcadoMetricas;
+HistogramaLatencia latenciaAccionesMenu[MAX_OPCION_MENU + 1];
 
 // Funciones de gestión e interacción
 
@@ -353,10 +25,204 @@ void darDeBajaCarro();
 void mostrarCarrosConMotoresReensamblados();
 void mostrarCumplimientoPlan();
 void mostrarGananciaTotal();
+void mostrarProduccionPeriodo();
+void mostrarCumplimientoMensual();
+void mostrarCalidadEspecialistas();
+void mostrarClasificaciones();
+void archivarCarrosInteractivo();
+void consultarHistoricoInteractivo();
+void mostrarMetricas();
 void menuPrincipal();
 
-int main() {
+void importarDesdeArchivo();
+void ensamblarLoteDesdeArchivo(const std::string& ruta);
+void ensamblarLoteInteractivo();
+void mostrarEstadisticasMemoria();
+void mostrarTableroProduccion();
+void verificarAgregadosInteractivo();
+void configurarReportes();
+void configurarHilosReportes();
+void guardarInstantaneaInteractivo();
+bool volcarMetricas();
+
+// Reproducción de la carga de trabajo
+int reproducirTraza(const std::string& ruta, double ritmo);
+
+void mostrarResumenImportacion(const std::string& ruta, const ResumenImportacion& resumen);
+void compararAlmacenColumnar(size_t cantidadCarros);
+void medirLineaConcurrente(size_t cantidad, size_t maxEstaciones);
+void medirLineaConcurrenteInteractivo();
+size_t estacionesPorDefecto();
+bool generarArchivoImportacion(const std::string& ruta, size_t cantidadMotores, uint64_t semilla);
+void ejecutarBancoPruebas(const std::vector<size_t>& escalas, uint64_t semilla, const std::string& archivoResultados);
+int ejecutarServidor(const std::string& ruta);
+int ejecutarCliente(const std::string& ruta);
+
+InventarioPlanta planta;
+
+// Informa un valor que no se puede leer para una opción de la línea de comandos; devuelve el código de salida
+int valorInvalido(const std::string& opcion, std::string_view valor) {
+    std::cout << "Valor inválido para " << opcion << ": " << valor << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    // Uso: programa [--estado archivo (y archivo.diario)] [--hilos-reportes n] [--columnar] [--verificar-agregados]
+    //                [--historico archivo] [--contar-asignaciones] [--metricas archivo [segundos]]
+    //                [--importar archivo]... [--lote archivo]... [--archivar DD/MM/AAAA]... [--grabar traza]
+    //      programa --bench-columnar [cantidad]...
+    //      programa --linea-concurrente [cantidad [estaciones]]
+    //      programa --generar archivo cantidadMotores [semilla]
+    //      programa --bench [escala]... [--semilla n] [--resultados archivo]
+    //      programa [opciones de la primera forma]... --servidor ruta.sock
+    //      programa [opciones de la primera forma]... --reproducir traza [--ritmo [factor]]
+    //      programa --cliente ruta.sock
+    for (int i = 1; i < argc; ++i) {
+        std::string argumento = argv[i];
+        if (argumento == "--estado" && i + 1 < argc) {
+            if (!planta.abrirEstado(argv[++i])) {
+                return 1;
+            }
+        } else if (argumento == "--historico" && i + 1 < argc) {
+            if (!planta.abrirArchivoHistorico(argv[++i]) || !planta.conciliarArchivoHistorico(false, 0)) {
+                return 1;
+            }
+        } else if (argumento == "--archivar" && i + 1 < argc) {
+            Fecha corte;
+            if (!Fecha::desdeTexto(argv[++i], corte)) {
+                std::cout << mensajeResultado(Resultado::FechaInvalida) << std::endl;
+                return 1;
+            }
+            CarrosArchivados archivados = planta.archivarCarros(corte);
+            if (archivados.resultado != Resultado::Exito) {
+                std::cout << mensajeResultado(archivados.resultado) << std::endl;
+                return 1;
+            }
+            std::cout << "Carros archivados: " << archivados.carros << " (ganancia " << archivados.ganancia << ")."
+                      << std::endl;
+            planta.confirmarDiario();
+        } else if (argumento == "--importar" && i + 1 < argc) {
+            std::string ruta = argv[++i];
+            mostrarResumenImportacion(ruta, planta.importar(ruta));
+            planta.confirmarDiario();
+        } else if (argumento == "--lote" && i + 1 < argc) {
+            ensamblarLoteDesdeArchivo(argv[++i]);
+            planta.confirmarDiario();
+        } else if (argumento == "--columnar") {
+            planta.activarAlmacenColumnar();
+        } else if (argumento == "--hilos-reportes" && i + 1 < argc) {
+            int hilos;
+            if (!leerEntero(argv[++i], hilos)) {
+                return valorInvalido(argumento, argv[i]);
+            }
+            hilosReportes = std::max(1, hilos);
+        } else if (argumento == "--verificar-agregados") {
+            planta.setVerificarAgregadosSiempre(true);
+        } else if (argumento == "--contar-asignaciones") {
+            contarAsignaciones = true;
+        } else if (argumento == "--metricas" && i + 1 < argc) {
+            metricasActivas = true;
+            archivoMetricas = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-' && !leerDecimal(argv[++i], intervaloMetricas)) {
+                return valorInvalido(argumento, argv[i]);
+            }
+            ultimoVolcadoMetricas = std::chrono::steady_clock::now();
+        } else if (argumento == "--bench-columnar") {
+            bool conCantidad = false;
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                uint64_t cantidad;
+                if (!leerEntero(argv[++i], cantidad)) {
+                    return valorInvalido(argumento, argv[i]);
+                }
+                compararAlmacenColumnar(cantidad);
+                conCantidad = true;
+            }
+            if (!conCantidad) {
+                compararAlmacenColumnar(1000000);
+                compararAlmacenColumnar(10000000);
+            }
+            return 0;
+        } else if (argumento == "--generar" && i + 2 < argc) {
+            std::string ruta = argv[i + 1];
+            uint64_t cantidad;
+            i += 2;
+            if (!leerEntero(argv[i], cantidad)) {
+                return valorInvalido(argumento, argv[i]);
+            }
+            uint64_t semilla = 1;
+            if (i + 1 < argc && argv[i + 1][0] != '-' && !leerEntero(argv[++i], semilla)) {
+                return valorInvalido(argumento, argv[i]);
+            }
+            return generarArchivoImportacion(ruta, cantidad, semilla) ? 0 : 1;
+        } else if (argumento == "--bench") {
+            std::vector<size_t> escalas;
+            uint64_t semilla = 1;
+            std::string resultados = "resultados_banco.json";
+            while (i + 1 < argc) {
+                std::string opcion = argv[i + 1];
+                if (opcion == "--semilla" && i + 2 < argc) {
+                    i += 2;
+                    if (!leerEntero(argv[i], semilla)) {
+                        return valorInvalido(opcion, argv[i]);
+                    }
+                } else if (opcion == "--resultados" && i + 2 < argc) {
+                    resultados = argv[i + 2];
+                    i += 2;
+                } else if (opcion[0] != '-') {
+                    double escala;    // Admite notación científica (1e6)
+                    if (!leerDecimal(opcion, escala) || !(escala >= 1 && escala <= 1e12)) {
+                        return valorInvalido(argumento, opcion);
+                    }
+                    escalas.push_back(static_cast<size_t>(escala));
+                    i++;
+                } else {
+                    break;
+                }
+            }
+            if (escalas.empty()) {
+                escalas = {1000, 10000, 100000, 1000000};
+            }
+            ejecutarBancoPruebas(escalas, semilla, resultados);
+            return 0;
+        } else if (argumento == "--grabar" && i + 1 < argc) {
+            archivoTraza = argv[++i];
+        } else if (argumento == "--reproducir" && i + 1 < argc) {
+            std::string ruta = argv[++i];
+            double ritmo = 0;    // Lo más rápido posible
+            if (i + 1 < argc && std::string(argv[i + 1]) == "--ritmo") {
+                i++;
+                ritmo = 1;
+                if (i + 1 < argc && argv[i + 1][0] != '-' && !leerDecimal(argv[++i], ritmo)) {
+                    return valorInvalido("--ritmo", argv[i]);
+                }
+            }
+            return reproducirTraza(ruta, ritmo);
+        } else if (argumento == "--servidor" && i + 1 < argc) {
+            return ejecutarServidor(argv[++i]);
+        } else if (argumento == "--cliente" && i + 1 < argc) {
+            return ejecutarCliente(argv[++i]);
+        } else if (argumento == "--linea-concurrente") {
+            uint64_t cantidad = 500000;
+            uint64_t maxEstaciones = estacionesPorDefecto();
+            if (i + 1 < argc && argv[i + 1][0] != '-' && !leerEntero(argv[++i], cantidad)) {
+                return valorInvalido(argumento, argv[i]);
+            }
+            if (i + 1 < argc && argv[i + 1][0] != '-' && !leerEntero(argv[++i], maxEstaciones)) {
+                return valorInvalido(argumento, argv[i]);
+            }
+            medirLineaConcurrente(cantidad, maxEstaciones);
+            return 0;
+        } else {
+            std::cout << "Argumento desconocido: " << argumento << std::endl;
+            return 1;
+        }
+    }
+
+    if (!iniciarGrabacionTraza()) {
+        return 1;
+    }
     menuPrincipal();
+    terminarGrabacionTraza();
     return 0;
 }
 
@@ -368,62 +234,55 @@ void agregarMotor() {
     std::cout << "3. Motor de Trabajo" << std::endl;
     std::cin >> tipoMotor;
 
-    std::string codigo, fechaSalida, especialista;
-    int vecesReensamblado;
-
+    DatosMotor motor;
     std::cout << "Ingrese el código (12 caracteres): ";
-    std::cin >> codigo;
+    std::cin >> motor.codigo;
     std::cout << "Ingrese la fecha de salida (DD/MM/AAAA): ";
-    std::cin >> fechaSalida;
+    std::cin >> motor.fechaSalida;
     std::cout << "Ingrese el nombre del especialista: ";
-    std::cin >> especialista;
+    std::cin >> motor.especialista;
     std::cout << "Ingrese las veces que ha regresado al área de ensamblaje por defectos: ";
-    std::cin >> vecesReensamblado;
+    std::cin >> motor.vecesReensamblado;
 
+    const char* mensajeExito;
     switch (tipoMotor) {
-        case 1: {   // Motor de Alta
-            double maxRPM, consumo;
+        case 1:     // Motor de Alta
+            motor.tipo = TipoMotor::Alta;
+            mensajeExito = "Motor de Alta agregado exitosamente.";
             std::cout << "Ingrese las máximas RPM: ";
-            std::cin >> maxRPM;
+            std::cin >> motor.maxRPM;
             std::cout << "Ingrese el consumo (km/l): ";
-            std::cin >> consumo;
-
-            MotorAlta* motorAlta = new MotorAlta(codigo, fechaSalida, especialista, vecesReensamblado, maxRPM, consumo);
-            motoresAltaDisponibles.push_back(motorAlta);
-            motoresProducidos++;
-            std::cout << "Motor de Alta agregado exitosamente." << std::endl;
+            std::cin >> motor.consumo;
             break;
-        }
-        case 2: {   // Motor de Fuerza
-            int caballosFuerza;
+        case 2:     // Motor de Fuerza
+            motor.tipo = TipoMotor::Fuerza;
+            mensajeExito = "Motor de Fuerza agregado exitosamente.";
             std::cout << "Ingrese los caballos de fuerza (80 - 4000): ";
-            std::cin >> caballosFuerza;
-
-            if (caballosFuerza < 80 || caballosFuerza > 4000) {
-                std::cout << "Caballos de fuerza fuera del rango permitido." << std::endl;
-                return;
-            }
-
-            MotorFuerza* motorFuerza = new MotorFuerza(codigo, fechaSalida, especialista, vecesReensamblado, caballosFuerza);
-            motoresFuerzaDisponibles.push_back(motorFuerza);
-            motoresProducidos++;
-            std::cout << "Motor de Fuerza agregado exitosamente." << std::endl;
+            std::cin >> motor.caballosFuerza;
             break;
-        }
-        case 3: {   // Motor de Trabajo
-            bool artesanal;
+        case 3:     // Motor de Trabajo
+            motor.tipo = TipoMotor::Trabajo;
+            mensajeExito = "Motor de Trabajo agregado exitosamente.";
             std::cout << "¿Es artesanal? (1 = Sí, 0 = No): ";
-            std::cin >> artesanal;
-
-            MotorTrabajo* motorTrabajo = new MotorTrabajo(codigo, fechaSalida, especialista, vecesReensamblado, artesanal);
-            motoresTrabajoDisponibles.push_back(motorTrabajo);
-            motoresProducidos++;
-            std::cout << "Motor de Trabajo agregado exitosamente." << std::endl;
+            std::cin >> motor.artesanal;
             break;
-        }
         default:
             std::cout << "Tipo de motor inválido." << std::endl;
-            break;
+            return;
+    }
+
+    // Como en la importación, el registro se lee completo antes de rechazarlo: si no, los datos propios del
+    // tipo quedarían en la entrada y se leerían como opciones del menú
+    if (planta.existeMotor(motor.codigo)) {
+        std::cout << "Ya existe un motor con el código " << motor.codigo << "." << std::endl;
+        return;
+    }
+
+    Resultado resultado = planta.agregarMotor(motor);
+    if (resultado == Resultado::Exito) {
+        std::cout << mensajeExito << std::endl;
+    } else {
+        std::cout << mensajeResultado(resultado) << std::endl;
     }
 }
 
@@ -436,289 +295,2482 @@ void ensamblarCarro() {
     std::cout << "4. De Lujo" << std::endl;
     std::cin >> tipoCarro;
 
-    // Variables comunes
-    std::string fechaSalida;
-    double velocidad;
-
+    // Datos comunes
+    PedidoCarro pedido;
     std::cout << "Ingrese la fecha de salida (DD/MM/AAAA): ";
-    std::cin >> fechaSalida;
+    std::cin >> pedido.fechaSalida;
     std::cout << "Ingrese la velocidad del vehículo (km/h): ";
-    std::cin >> velocidad;
+    std::cin >> pedido.velocidad;
 
+    const char* mensajeExito;
     switch (tipoCarro) {
-        case 1: {   // Formula1
-            if (motoresAltaDisponibles.empty()) {
+        case 1:     // Formula1
+            if (!planta.hayMotorDisponible(TipoMotor::Alta)) {
                 std::cout << "No hay motores de alta disponibles." << std::endl;
                 return;
             }
-            MotorAlta* motor = motoresAltaDisponibles.back();
-            motoresAltaDisponibles.pop_back();
-
-            double pesoCarroceria;
+            pedido.tipo = TipoCarro::Formula1;
             std::cout << "Ingrese el peso de la carrocería (kg): ";
-            std::cin >> pesoCarroceria;
-
-            Formula1* formula1 = new Formula1(motor, velocidad, fechaSalida, pesoCarroceria);
-            carrosEnsamblados.push_back(formula1);
-            carrosProducidos++;
-            std::cout << "Formula1 ensamblado exitosamente." << std::endl;
+            std::cin >> pedido.pesoCarroceria;
+            mensajeExito = "Formula1 ensamblado exitosamente.";
             break;
-        }
-        case 2: {   // Ómnibus
-            if (motoresFuerzaDisponibles.empty()) {
+        case 2:     // Ómnibus
+            if (!planta.hayMotorDisponible(TipoMotor::Fuerza)) {
                 std::cout << "No hay motores de fuerza disponibles." << std::endl;
                 return;
             }
-            MotorFuerza* motor = motoresFuerzaDisponibles.back();
-            motoresFuerzaDisponibles.pop_back();
-
-            int cantidadPuertas;
+            pedido.tipo = TipoCarro::Omnibus;
             std::cout << "Ingrese la cantidad de puertas: ";
-            std::cin >> cantidadPuertas;
-
-            Omnibus* omnibus = new Omnibus(motor, velocidad, fechaSalida, cantidadPuertas);
-            carrosEnsamblados.push_back(omnibus);
-            carrosProducidos++;
-            std::cout << "Ómnibus ensamblado exitosamente." << std::endl;
+            std::cin >> pedido.cantidadPuertas;
+            mensajeExito = "Ómnibus ensamblado exitosamente.";
             break;
-        }
-        case 3: {   // Sport
-            if (motoresTrabajoDisponibles.empty()) {
+        case 3:     // Sport
+            if (!planta.hayMotorDisponible(TipoMotor::Trabajo)) {
                 std::cout << "No hay motores de trabajo disponibles." << std::endl;
                 return;
             }
-            MotorTrabajo* motor = motoresTrabajoDisponibles.back();
-            motoresTrabajoDisponibles.pop_back();
-
-            int cantidadPlazas;
+            pedido.tipo = TipoCarro::Sport;
             std::cout << "Ingrese la cantidad de plazas (entre 2 y 4): ";
-            std::cin >> cantidadPlazas;
+            std::cin >> pedido.cantidadPlazas;
 
-            if (cantidadPlazas < 2 || cantidadPlazas > 4) {
+            if (pedido.cantidadPlazas < 2 || pedido.cantidadPlazas > 4) {
                 std::cout << "Cantidad de plazas inválida." << std::endl;
                 return;
             }
 
-            int cantidadVelocidades;
             std::cout << "Ingrese la cantidad de velocidades de la caja: ";
-            std::cin >> cantidadVelocidades;
-
-            bool cambioUniversal;
+            std::cin >> pedido.cantidadVelocidades;
             std::cout << "¿Es de cambio universal? (1 = Sí, 0 = No): ";
-            std::cin >> cambioUniversal;
-
-            Sport* sport = new Sport(motor, cantidadPlazas, velocidad, fechaSalida, cantidadVelocidades, cambioUniversal);
-            carrosEnsamblados.push_back(sport);
-            carrosProducidos++;
-            std::cout << "Sport ensamblado exitosamente." << std::endl;
+            std::cin >> pedido.cambioUniversal;
+            mensajeExito = "Sport ensamblado exitosamente.";
             break;
-        }
-        case 4: {   // De Lujo
-            if (motoresTrabajoDisponibles.empty()) {
+        case 4:     // De Lujo
+            if (!planta.hayMotorDisponible(TipoMotor::Trabajo)) {
                 std::cout << "No hay motores de trabajo disponibles." << std::endl;
                 return;
             }
-
-            // Buscar un motor artesanal
-            MotorTrabajo* motor = nullptr;
-            for (auto it = motoresTrabajoDisponibles.begin(); it != motoresTrabajoDisponibles.end(); ++it) {
-                if ((*it)->esArtesanal()) {
-                    motor = *it;
-                    motoresTrabajoDisponibles.erase(it);
-                    break;
-                }
-            }
-
-            if (!motor) {
+            if (!planta.hayMotorArtesanalDisponible()) {
                 std::cout << "No hay motores artesanales disponibles." << std::endl;
                 return;
             }
-
-            int cantidadPlazas;
+            pedido.tipo = TipoCarro::DeLujo;
             std::cout << "Ingrese la cantidad de plazas (entre 2 y 4): ";
-            std::cin >> cantidadPlazas;
+            std::cin >> pedido.cantidadPlazas;
 
-            if (cantidadPlazas < 2 || cantidadPlazas > 4) {
+            if (pedido.cantidadPlazas < 2 || pedido.cantidadPlazas > 4) {
                 std::cout << "Cantidad de plazas inválida." << std::endl;
                 return;
             }
 
-            double costoTapiceria;
             std::cout << "Ingrese el costo de la tapicería: ";
-            std::cin >> costoTapiceria;
-
-            DeLujo* deLujo = new DeLujo(motor, cantidadPlazas, velocidad, fechaSalida, costoTapiceria);
-            carrosEnsamblados.push_back(deLujo);
-            carrosProducidos++;
-            std::cout << "Carro de lujo ensamblado exitosamente." << std::endl;
+            std::cin >> pedido.costoTapiceria;
+            mensajeExito = "Carro de lujo ensamblado exitosamente.";
             break;
-        }
         default:
             std::cout << "Tipo de carro inválido." << std::endl;
-            break;
+            return;
     }
-}
 
-void mostrarMotoresDisponibles() {
-    std::cout << "Motores de Alta disponibles: " << motoresAltaDisponibles.size() << std::endl;
-    for (const auto& motor : motoresAltaDisponibles) {
-        motor->mostrarFichaTecnica();
-        std::cout << "---------------------------" << std::endl;
+    Resultado resultado = planta.ensamblarCarro(pedido);
+    if (resultado == Resultado::Exito) {
+        std::cout << mensajeExito << std::endl;
+    } else {
+        std::cout << mensajeResultado(resultado) << std::endl;
     }
+}
 
-    std::cout << "Motores de Fuerza disponibles: " << motoresFuerzaDisponibles.size() << std::endl;
-    for (const auto& motor : motoresFuerzaDisponibles) {
-        motor->mostrarFichaTecnica();
-        std::cout << "---------------------------" << std::endl;
+// Escribe la ficha de un elemento de un listado, seguida del separador.
+// Devuelve false cuando se alcanzó el límite de fichas y el listado debe terminar.
+bool escribirFichaListado(EscritorReporte& escritor, const Motor& motor) {
+    if (!escritor.iniciarFicha(nombreTipoMotor(motor.getTipo()))) {
+        return !escritor.limiteAlcanzado();
     }
+    motor.escribirFicha(escritor);
+    escritor.separador();
+    escritor.terminarFicha();
+    return true;
+}
 
-    std::cout << "Motores de Trabajo disponibles: " << motoresTrabajoDisponibles.size() << std::endl;
-    for (const auto& motor : motoresTrabajoDisponibles) {
-        motor->mostrarFichaTecnica();
-        std::cout << "---------------------------" << std::endl;
+bool escribirFichaListado(EscritorReporte& escritor, const Carro& carro) {
+    if (!escritor.iniciarFicha(nombreTipoCarro(carro.getTipo()))) {
+        return !escritor.limiteAlcanzado();
     }
+    carro.escribirFicha(escritor);
+    escritor.separador();
+    escritor.terminarFicha();
+    return true;
 }
 
-void mostrarCarrosAltaVelocidad() {
-    std::cout << "Carros con velocidad mayor a 150 km/h:" << std::endl;
-    for (const auto& carro : carrosEnsamblados) {
-        if (carro->getVelocidad() > 150) {
-            carro->mostrarFichaTecnica();
-            std::cout << "---------------------------" << std::endl;
+// Escribe un listado de cantidad fichas; escribirFicha(escritor, i) escribe la ficha i como
+// escribirFichaListado. Con varios hilos, cada bloque de BLOQUE_FICHAS fichas se formatea en su propio
+// fragmento y los fragmentos se agregan al reporte en orden, por rondas para acotar la memoria.
+const size_t BLOQUE_FICHAS = 1024;
+const size_t BLOQUES_POR_HILO_RONDA = 4;
+
+template <typename EscribirFicha>
+void escribirListado(EscritorReporte& escritor, size_t cantidad, EscribirFicha escribirFicha) {
+    if (hilosReportes <= 1) {
+        for (size_t i = 0; i < cantidad; ++i) {
+            if (!escribirFicha(escritor, i)) {
+                break;
+            }
+        }
+        return;
+    }
+
+    ReservaFichas reserva = escritor.reservarFichas(cantidad);
+    size_t fichasPorRonda = BLOQUE_FICHAS * BLOQUES_POR_HILO_RONDA * hilosReportes;
+    std::vector<std::string> fragmentos;
+    for (size_t inicioRonda = reserva.inicio; inicioRonda < reserva.fin; inicioRonda += fichasPorRonda) {
+        size_t finRonda = std::min(inicioRonda + fichasPorRonda, reserva.fin);
+        size_t bloques = contarBloques(finRonda - inicioRonda, BLOQUE_FICHAS);
+        fragmentos.assign(bloques, std::string());
+        ejecutarPorBloques(bloques, [&](size_t bloque) {
+            size_t inicio = inicioRonda + bloque * BLOQUE_FICHAS;
+            size_t fin = std::min(inicio + BLOQUE_FICHAS, finRonda);
+            EscritorReporte fragmento(escritor, reserva, inicio);
+            for (size_t i = inicio; i < fin; ++i) {
+                escribirFicha(fragmento, i);
+            }
+            fragmentos[bloque] = std::move(fragmento.contenido());
+        });
+        for (const auto& fragmento : fragmentos) {
+            escritor.agregarFragmento(fragmento);
         }
     }
 }
 
-void mostrarOmnibusMayorCapacidad() {
-    Omnibus* omnibusMayor = nullptr;
-    int mayorCapacidad = 0;
+void finalizarReporte(EscritorReporte& escritor) {
+    bool enArchivo = escritor.escribeEnArchivo();
+    escritor.terminar();
+    if (enArchivo) {
+        std::cout << "Reporte guardado en " << configuracionReporte.archivo << "." << std::endl;
+    }
+}
 
-    for (const auto& carro : carrosEnsamblados) {
-        Omnibus* omnibus = dynamic_cast<Omnibus*>(carro);
-        if (omnibus) {
-            int capacidad = omnibus->getCantidadPlazas();
-            if (capacidad > mayorCapacidad) {
-                mayorCapacidad = capacidad;
-                omnibusMayor = omnibus;
-            }
+// Cuerpos de los reportes de listado, comunes al menú y al servicio
+
+void escribirReporteMotoresDisponibles(EscritorReporte& escritor, const MotoresDisponibles& motores) {
+    escritor.texto("Motores de Alta disponibles: " + std::to_string(motores.alta.size()));
+    for (const auto& motor : motores.alta) {
+        if (!escribirFichaListado(escritor, *motor)) {
+            break;
+        }
+    }
+
+    escritor.texto("Motores de Fuerza disponibles: " + std::to_string(motores.fuerza.size()));
+    for (const auto& motor : motores.fuerza) {
+        if (!escribirFichaListado(escritor, *motor)) {
+            break;
+        }
+    }
+
+    escritor.texto("Motores de Trabajo disponibles: " + std::to_string(motores.trabajo.size()));
+    for (const auto& motor : motores.trabajo) {
+        if (!escribirFichaListado(escritor, *motor)) {
+            break;
         }
     }
+}
+
+void escribirReporteAltaVelocidad(EscritorReporte& escritor, const std::vector<const Carro*>& carros) {
+    char titulo[64];
+    std::snprintf(titulo, sizeof(titulo), "Carros con velocidad mayor a %g km/h:", VELOCIDAD_ALTA);
+    escritor.texto(titulo);
+    escribirListado(escritor, carros.size(), [&carros](EscritorReporte& destino, size_t i) {
+        return escribirFichaListado(destino, *carros[i]);
+    });
+}
+
+void escribirReporteOmnibus(EscritorReporte& escritor, const Carro& omnibus) {
+    escritor.texto("Ómnibus de mayor capacidad:");
+    if (escritor.iniciarFicha(nombreTipoCarro(omnibus.getTipo()))) {
+        omnibus.escribirFicha(escritor);
+        escritor.terminarFicha();
+    }
+}
+
+// carro(i) devuelve el carro i de los cantidad carros del listado
+template <typename Acceso>
+void escribirReporteFichas(EscritorReporte& escritor, size_t cantidad, Acceso carro) {
+    escribirListado(escritor, cantidad, [&carro](EscritorReporte& destino, size_t i) {
+        return escribirFichaListado(destino, carro(i));
+    });
+}
+
+void escribirReporteReensamblados(EscritorReporte& escritor, const std::vector<CarroReensamblado>& carros) {
+    escritor.texto("Carros con motores reensamblados y disminución en el precio de venta:");
+    escribirListado(escritor, carros.size(), [&carros](EscritorReporte& destino, size_t i) {
+        const Carro* carro = carros[i].carro;
+        if (!destino.iniciarFicha(nombreTipoCarro(carro->getTipo()))) {
+            return !destino.limiteAlcanzado();
+        }
+        carro->escribirFicha(destino);
+        destino.campo("Disminución en el precio de venta", "disminucionPrecio", carros[i].disminucionPrecio);
+        destino.separador();
+        destino.terminarFicha();
+        return true;
+    });
+}
+
+void mostrarMotoresDisponibles() {
+    MotoresDisponibles motores = planta.motoresDisponibles();
+    EscritorReporte escritor(configuracionReporte);
+    escribirReporteMotoresDisponibles(escritor, motores);
+    finalizarReporte(escritor);
+}
+
+void mostrarCarrosAltaVelocidad() {
+    std::vector<const Carro*> carros = planta.carrosAltaVelocidad();
+    EscritorReporte escritor(configuracionReporte);
+    escribirReporteAltaVelocidad(escritor, carros);
+    finalizarReporte(escritor);
+}
+
+void mostrarOmnibusMayorCapacidad() {
+    const Carro* omnibusMayor = planta.omnibusMayorCapacidad();
 
     if (omnibusMayor) {
-        std::cout << "Ómnibus de mayor capacidad:" << std::endl;
-        omnibusMayor->mostrarFichaTecnica();
+        EscritorReporte escritor(configuracionReporte);
+        escribirReporteOmnibus(escritor, *omnibusMayor);
+        finalizarReporte(escritor);
     } else {
         std::cout << "No hay ómnibus en el inventario." << std::endl;
     }
 }
 
 void mostrarFichasTecnicasCarros() {
-    for (const auto& carro : carrosEnsamblados) {
-        carro->mostrarFichaTecnica();
-        std::cout << "---------------------------" << std::endl;
-    }
+    // Se mide aquí, donde se escriben las fichas: planta.carros() solo devuelve la referencia
+    MedicionLatencia medicion(OperacionPlanta::FichasCarros);
+    OperacionTrazada traza(OperacionPlanta::FichasCarros);
+    const std::vector<Carro*>& carros = planta.carros();
+    EscritorReporte escritor(configuracionReporte);
+    escribirReporteFichas(escritor, carros.size(), [&carros](size_t i) -> const Carro& { return *carros[i]; });
+    finalizarReporte(escritor);
 }
-
 void darDeBajaCarro() {
     std::string codigoCarro;
     std::cout << "Ingrese el código del motor del carro a dar de baja: ";
     std::cin >> codigoCarro;
 
-    for (auto it = carrosEnsamblados.begin(); it != carrosEnsamblados.end(); ++it) {
-        if ((*it)->getMotor()->getCodigo() == codigoCarro) {
-            // El carro no pasó la prueba, se desarma y el motor vuelve al inventario
-            Motor* motor = (*it)->getMotor();
-            motor->setVecesReensamblado(motor->getVecesReensamblado() + 1);
-
-            // Si el carro era de lujo, el motor deja de ser artesanal
-            DeLujo* deLujo = dynamic_cast<DeLujo*>(*it);
-            if (deLujo) {
-                MotorTrabajo* motorTrabajo = dynamic_cast<MotorTrabajo*>(motor);
-                if (motorTrabajo) {
-                    motorTrabajo->setArtesanal(false);
-                }
-            }
-
-            // Devolver el motor al inventario correspondiente
-            if (MotorAlta* motorAlta = dynamic_cast<MotorAlta*>(motor)) {
-                motoresAltaDisponibles.push_back(motorAlta);
-            } else if (MotorFuerza* motorFuerza = dynamic_cast<MotorFuerza*>(motor)) {
-                motoresFuerzaDisponibles.push_back(motorFuerza);
-            } else if (MotorTrabajo* motorTrabajo = dynamic_cast<MotorTrabajo*>(motor)) {
-                motoresTrabajoDisponibles.push_back(motorTrabajo);
-            }
-
-            // Eliminar el carro del inventario
-            delete *it;
-            carrosEnsamblados.erase(it);
-            std::cout << "Carro dado de baja y motor devuelto al inventario." << std::endl;
-            return;
-        }
+    Resultado resultado = planta.darDeBajaCarro(codigoCarro);
+    if (resultado == Resultado::Exito) {
+        std::cout << "Carro dado de baja y motor devuelto al inventario." << std::endl;
+    } else {
+        std::cout << mensajeResultado(resultado) << std::endl;
     }
-    std::cout << "No se encontró un carro con el código de motor proporcionado." << std::endl;
 }
 
 void mostrarCarrosConMotoresReensamblados() {
-    std::cout << "Carros con motores reensamblados y disminución en el precio de venta:" << std::endl;
-    for (const auto& carro : carrosEnsamblados) {
-        if (carro->getMotor()->getVecesReensamblado() > 0) {
-            // Aplica solo a Formula1, Sport y Ómnibus
-            if (dynamic_cast<Formula1*>(carro) || dynamic_cast<Sport*>(carro) || dynamic_cast<Omnibus*>(carro)) {
-                double precioOriginal = carro->calcularPrecioVenta();
-                carro->getMotor()->setVecesReensamblado(carro->getMotor()->getVecesReensamblado() - 1);
-                double precioAnterior = carro->calcularPrecioVenta();
-                carro->getMotor()->setVecesReensamblado(carro->getMotor()->getVecesReensamblado() + 1);
-                double disminucion = precioAnterior - precioOriginal;
+    std::vector<CarroReensamblado> carros = planta.carrosConMotoresReensamblados();
+    EscritorReporte escritor(configuracionReporte);
+    escribirReporteReensamblados(escritor, carros);
+    finalizarReporte(escritor);
+}
 
-                carro->mostrarFichaTecnica();
-                std::cout << "Disminución en el precio de venta: " << disminucion << std::endl;
-                std::cout << "---------------------------" << std::endl;
-            }
-        }
-    }
+void escribirCumplimientoPlan(const CumplimientoPlan& cumplimiento) {
+    std::cout << "Porcentaje de cumplimiento del plan de motores: " << cumplimiento.porcentajeMotores << "%" << std::endl;
+    std::cout << "Porcentaje de cumplimiento del plan de carros: " << cumplimiento.porcentajeCarros << "%" << std::endl;
 }
 
 void mostrarCumplimientoPlan() {
-    double porcentajeMotores = (static_cast<double>(motoresProducidos) / planMotoresAnual) * 100;
-    double porcentajeCarros = (static_cast<double>(carrosProducidos) / planCarrosAnual) * 100;
+    escribirCumplimientoPlan(planta.cumplimientoPlan());
+}
 
-    std::cout << "Porcentaje de cumplimiento del plan de motores: " << porcentajeMotores << "%" << std::endl;
-    std::cout << "Porcentaje de cumplimiento del plan de carros: " << porcentajeCarros << "%" << std::endl;
+// Lee una fecha DD/MM/AAAA; muestra el error y devuelve false si no es válida
+bool leerFecha(const char* indicacion, Fecha& fecha) {
+    std::string texto;
+    std::cout << indicacion;
+    std::cin >> texto;
+    if (!Fecha::desdeTexto(texto, fecha)) {
+        std::cout << mensajeResultado(Resultado::FechaInvalida) << std::endl;
+        return false;
+    }
+    return true;
 }
 
-void mostrarGananciaTotal() {
-    double gananciaFormula1 = 0;
-    double gananciaOmnibus = 0;
-    double gananciaSport = 0;
-    double gananciaDeLujo = 0;
+void mostrarProduccionPeriodo() {
+    Fecha desde, hasta;
+    if (!leerFecha("Ingrese la fecha inicial (DD/MM/AAAA): ", desde) ||
+        !leerFecha("Ingrese la fecha final (DD/MM/AAAA): ", hasta)) {
+        return;
+    }
 
-    for (const auto& carro : carrosEnsamblados) {
-        double precioVenta = carro->calcularPrecioVenta();
-        double costoMotor = carro->getMotor()->calcularCosto();
+    ProduccionPeriodo produccion = planta.produccionEntre(desde, hasta);
+    std::cout << "Producción del " << produccion.desde.texto() << " al " << produccion.hasta.texto() << ": "
+              << produccion.motores << " motores, " << produccion.carros << " carros" << std::endl;
+}
 
-        if (Formula1* f1 = dynamic_cast<Formula1*>(carro)) {
-            gananciaFormula1 += precioVenta - costoMotor;
-        } else if (Omnibus* bus = dynamic_cast<Omnibus*>(carro)) {
-            gananciaOmnibus += precioVenta - costoMotor;
-        } else if (Sport* sport = dynamic_cast<Sport*>(carro)) {
-            gananciaSport += precioVenta - costoMotor;
-        } else if (DeLujo* lujo = dynamic_cast<DeLujo*>(carro)) {
-            gananciaDeLujo += precioVenta - costoMotor;
-        }
+void mostrarCumplimientoMensual() {
+    Fecha corte;
+    if (!leerFecha("Ingrese la fecha de corte (DD/MM/AAAA): ", corte)) {
+        return;
     }
+    int dia, mes, anio;
+    corte.aCivil(dia, mes, anio);
+
+    std::cout << "Cumplimiento mensual del plan (plan mensual: " << planta.getPlanMotoresAnual() / 12.0
+              << " motores, " << planta.getPlanCarrosAnual() / 12.0 << " carros):" << std::endl;
+    for (const CumplimientoMensual& cumplimiento : planta.cumplimientoMensual(anio, mes)) {
+        char periodo[16];
+        std::snprintf(periodo, sizeof(periodo), "%02d/%04d", cumplimiento.mes, anio);
+        std::cout << "  " << periodo << ": " << cumplimiento.motores << " motores (" << cumplimiento.porcentajeMotores
+                  << "%), " << cumplimiento.carros << " carros (" << cumplimiento.porcentajeCarros << "%)" << std::endl;
+    }
+
+    ProyeccionPlan proyeccion = planta.proyeccionPlan(corte);
+    std::cout << "Acumulado al " << proyeccion.corte.texto() << " (" << proyeccion.diasTranscurridos << " de "
+              << proyeccion.diasAnio << " días): " << proyeccion.motoresAcumulados << " motores, "
+              << proyeccion.carrosAcumulados << " carros" << std::endl;
+    std::cout << "Proyección anual al ritmo actual: " << proyeccion.motoresProyectados << " motores ("
+              << proyeccion.porcentajeMotores << "% del plan), " << proyeccion.carrosProyectados << " carros ("
+              << proyeccion.porcentajeCarros << "% del plan)" << std::endl;
+}
+
+void mostrarGananciaTotal() {
+    GananciasPorTipo ganancias = planta.ganancias();
 
     std::cout << "Ganancia total por tipo de carro:" << std::endl;
-    std::cout << "Formula1: " << gananciaFormula1 << std::endl;
-    std::cout << "Ómnibus: " << gananciaOmnibus << std::endl;
-    std::cout << "Sport: " << gananciaSport << std::endl;
-    std::cout << "De Lujo: " << gananciaDeLujo << std::endl;
+    std::cout << "Formula1: " << ganancias.porTipo[static_cast<int>(TipoCarro::Formula1)] << std::endl;
+    std::cout << "Ómnibus: " << ganancias.porTipo[static_cast<int>(TipoCarro::Omnibus)] << std::endl;
+    std::cout << "Sport: " << ganancias.porTipo[static_cast<int>(TipoCarro::Sport)] << std::endl;
+    std::cout << "De Lujo: " << ganancias.porTipo[static_cast<int>(TipoCarro::DeLujo)] << std::endl;
+
+    ResumenHistorico historico = planta.resumenHistorico();
+    double gananciaArchivada = 0;
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        gananciaArchivada += historico.gananciaArchivada[i];
+    }
+    if (historico.abierto) {
+        std::cout << "Ganancia de los carros archivados: " << gananciaArchivada << std::endl;
+    }
 }
 
-void menuPrincipal() {
-    int opcion = 0;
-    do {
-        std::cout << "\n----- Menú Principal -----" << std::endl;
-        std::cout << "1. Agregar motor" << std::endl;
+void mostrarTableroProduccion() {
+    const char* nombres[CANTIDAD_TIPOS_CARRO] = {"Formula1", "Ómnibus", "Sport", "De Lujo"};
+    TableroProduccion tablero = planta.tablero();
+
+    std::cout << "----- Tablero de producción -----" << std::endl;
+    std::cout << "Motores disponibles: " << tablero.motoresAlta << " de alta, " << tablero.motoresFuerza
+              << " de fuerza, " << tablero.motoresTrabajo << " de trabajo (" << tablero.motoresArtesanales
+              << " artesanales)" << std::endl;
+    std::cout << "Carros ensamblados: " << tablero.carrosEnsamblados << std::endl;
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        std::cout << "  " << nombres[i] << ": " << tablero.carrosPorTipo[i] << " carros, ganancia "
+                  << tablero.ganancias.porTipo[i] << std::endl;
+    }
+    std::cout << "Ganancia total: " << tablero.ganancias.total << std::endl;
+    std::cout << "Carros con velocidad mayor a " << VELOCIDAD_ALTA << " km/h: " << tablero.carrosAltaVelocidad
+              << std::endl;
+
+    if (tablero.mayorCapacidadOmnibus > 0) {
+        std::cout << "Mayor capacidad de un ómnibus: " << tablero.mayorCapacidadOmnibus << " plazas" << std::endl;
+    }
+    escribirCumplimientoPlan(tablero.cumplimiento);
+
+    const ResumenHistorico& historico = tablero.historico;
+    if (historico.abierto) {
+        long archivados = 0;
+        for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+            archivados += historico.archivadosPorTipo[i];
+        }
+        std::cout << "Archivo histórico: " << archivados << " carros archivados, " << historico.retirados
+                  << " retirados (" << historico.bytes << " bytes)" << std::endl;
+    }
+}
+
+void verificarAgregadosInteractivo() {
+    ComparacionAgregados comparacion = planta.compararAgregados();
+    mostrarDiferenciasAgregados(comparacion);
+    if (comparacion.coinciden) {
+        std::cout << "Los agregados incrementales coinciden con el recálculo completo." << std::endl;
+    }
+}
+
+void mostrarEstadisticasMemoria() {
+    std::printf("%-15s %10s %10s %8s %8s %12s %12s\n", "Pool", "Vivos", "Capacidad", "Ocupac.", "Bloques",
+                "Asignaciones", "Reutilizadas");
+    for (const EstadisticasPool& pool : planta.estadisticasMemoria()) {
+        double ocupacion = pool.capacidad ? 100.0 * pool.vivos / pool.capacidad : 0;
+        std::printf("%-15s %10zu %10zu %7.1f%% %8zu %12zu %12zu\n", pool.nombre, pool.vivos, pool.capacidad,
+                    ocupacion, pool.bloques, pool.asignaciones, pool.reutilizaciones);
+    }
+    std::fflush(stdout);
+}
+
+void mostrarCalidadEspecialistas() {
+    std::vector<EstadisticasEspecialista> estadisticas = planta.estadisticasEspecialistas();
+    if (estadisticas.empty()) {
+        std::cout << "No hay especialistas registrados." << std::endl;
+        return;
+    }
+    std::printf("%-20s %10s %14s %9s %16s\n", "Especialista", "Motores", "Reensamblajes", "Promedio",
+                "Carros retirados");
+    for (const EstadisticasEspecialista& especialista : estadisticas) {
+        const CalidadEspecialista& calidad = especialista.calidad;
+        double promedio = calidad.motores ? static_cast<double>(calidad.reensamblados) / calidad.motores : 0;
+        std::printf("%-20s %10ld %14ld %9.2f %16ld\n", especialista.nombre->c_str(), calidad.motores,
+                    calidad.reensamblados, promedio, calidad.carrosRetirados);
+    }
+    std::fflush(stdout);
+}
+
+void imprimirCarrosClasificados(const std::vector<CarroClasificado>& carros, const char* valor) {
+    if (carros.empty()) {
+        std::cout << "No hay carros para clasificar." << std::endl;
+        return;
+    }
+    std::printf("%4s %-10s %-14s %-12s %16s\n", "#", "Tipo", "Motor", "Salida", valor);
+    for (size_t i = 0; i < carros.size(); ++i) {
+        const Carro& carro = *carros[i].carro;
+        std::printf("%4zu %-10s %-14s %-12s %16.2f\n", i + 1, nombreTipoCarro(carro.getTipo()),
+                    carro.getMotor()->getCodigo().texto().c_str(), carro.getFechaSalida().texto().c_str(),
+                    carros[i].valor);
+    }
+    std::fflush(stdout);
+}
+
+void mostrarClasificaciones() {
+    int cantidad;
+    std::cout << "Cantidad de posiciones a mostrar: ";
+    std::cin >> cantidad;
+    if (cantidad < 1) {
+        std::cout << "Cantidad inválida." << std::endl;
+        return;
+    }
+    size_t k = static_cast<size_t>(cantidad);
+
+    int clasificacion;
+    std::cout << "1. Carros más rentables" << std::endl;
+    std::cout << "2. Carros más rentables de un tipo" << std::endl;
+    std::cout << "3. Omnibus de mayor capacidad" << std::endl;
+    std::cout << "4. Carros más rápidos" << std::endl;
+    std::cout << "5. Motores disponibles más baratos de un tipo" << std::endl;
+    std::cout << "Seleccione la clasificación: ";
+    std::cin >> clasificacion;
+    switch (clasificacion) {
+        case 1:
+            imprimirCarrosClasificados(planta.carrosMasRentables(k), "Ganancia");
+            break;
+        case 2: {
+            int tipo;
+            std::cout << "Tipo de carro (1 = Formula1, 2 = Omnibus, 3 = Sport, 4 = DeLujo): ";
+            std::cin >> tipo;
+            if (tipo < 1 || tipo > 4) {
+                std::cout << "Tipo de carro inválido." << std::endl;
+                return;
+            }
+            imprimirCarrosClasificados(planta.carrosMasRentables(k, static_cast<TipoCarro>(tipo - 1)), "Ganancia");
+            break;
+        }
+        case 3:
+            imprimirCarrosClasificados(planta.omnibusDeMayorCapacidad(k), "Plazas");
+            break;
+        case 4:
+            imprimirCarrosClasificados(planta.carrosMasRapidos(k), "Velocidad");
+            break;
+        case 5: {
+            int tipo;
+            std::cout << "Tipo de motor (1 = Alta, 2 = Fuerza, 3 = Trabajo): ";
+            std::cin >> tipo;
+            if (tipo < 1 || tipo > 3) {
+                std::cout << "Tipo de motor inválido." << std::endl;
+                return;
+            }
+            std::vector<MotorClasificado> motores = planta.motoresMasBaratos(static_cast<TipoMotor>(tipo - 1), k);
+            if (motores.empty()) {
+                std::cout << "No hay motores disponibles de ese tipo." << std::endl;
+                return;
+            }
+            std::printf("%4s %-14s %-12s %16s\n", "#", "Motor", "Salida", "Costo");
+            for (size_t i = 0; i < motores.size(); ++i) {
+                const Motor& motor = *motores[i].motor;
+                std::printf("%4zu %-14s %-12s %16.2f\n", i + 1, motor.getCodigo().texto().c_str(),
+                            motor.getFechaSalida().texto().c_str(), motores[i].costo);
+            }
+            std::fflush(stdout);
+            break;
+        }
+        default:
+            std::cout << "Clasificación inválida." << std::endl;
+            break;
+    }
+}
+
+void archivarCarrosInteractivo() {
+    Fecha corte;
+    if (!leerFecha("Archivar los carros con fecha de salida anterior a (DD/MM/AAAA): ", corte)) {
+        return;
+    }
+    CarrosArchivados archivados = planta.archivarCarros(corte);
+    if (archivados.resultado != Resultado::Exito) {
+        std::cout << mensajeResultado(archivados.resultado) << std::endl;
+        return;
+    }
+    std::cout << "Carros archivados: " << archivados.carros << " (ganancia " << archivados.ganancia
+              << "). Quedan " << planta.carros().size() << " carros en el inventario." << std::endl;
+}
+
+void consultarHistoricoInteractivo() {
+    ResumenHistorico historico = planta.resumenHistorico();
+    if (!historico.abierto) {
+        std::cout << mensajeResultado(Resultado::SinArchivoHistorico) << std::endl;
+        return;
+    }
+
+    int consulta;
+    std::cout << "1. Resumen del archivo histórico" << std::endl;
+    std::cout << "2. Fichas técnicas de los carros archivados entre dos fechas" << std::endl;
+    std::cout << "3. Fichas técnicas de los carros retirados entre dos fechas" << std::endl;
+    std::cout << "Seleccione la consulta: ";
+    std::cin >> consulta;
+    if (consulta == 1) {
+        const char* nombres[CANTIDAD_TIPOS_CARRO] = {"Formula1", "Ómnibus", "Sport", "De Lujo"};
+        std::cout << "Registros: " << historico.registros << " (" << historico.bytes << " bytes)" << std::endl;
+        for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+            std::cout << "  " << nombres[i] << ": " << historico.archivadosPorTipo[i] << " archivados, ganancia "
+                      << historico.gananciaArchivada[i] << std::endl;
+        }
+        std::cout << "Carros retirados: " << historico.retirados << std::endl;
+        return;
+    }
+    if (consulta != 2 && consulta != 3) {
+        std::cout << "Consulta inválida." << std::endl;
+        return;
+    }
+
+    Fecha desde, hasta;
+    if (!leerFecha("Ingrese la fecha inicial (DD/MM/AAAA): ", desde) ||
+        !leerFecha("Ingrese la fecha final (DD/MM/AAAA): ", hasta)) {
+        return;
+    }
+    ClaseHistorico clase = consulta == 2 ? ClaseHistorico::Archivado : ClaseHistorico::Retirado;
+    EscritorReporte escritor(configuracionReporte);
+    escritor.texto(consulta == 2 ? "Carros archivados:" : "Carros retirados:");
+    bool correcto = planta.recorrerHistorico(clase, desde, hasta, [&escritor](const Carro& carro) {
+        return escribirFichaListado(escritor, carro);
+    });
+    finalizarReporte(escritor);
+    if (!correcto) {
+        std::cout << "No se pudo leer el archivo histórico." << std::endl;
+    }
+}
+
+void configurarReportes() {
+    int formato;
+    std::cout << "Formato de los reportes (1 = Texto, 2 = CSV, 3 = JSON): ";
+    std::cin >> formato;
+    switch (formato) {
+        case 1: configuracionReporte.formato = FormatoReporte::Texto; break;
+        case 2: configuracionReporte.formato = FormatoReporte::CSV; break;
+        case 3: configuracionReporte.formato = FormatoReporte::JSON; break;
+        default:
+            std::cout << "Formato inválido." << std::endl;
+            return;
+    }
+
+    std::string archivo;
+    std::cout << "Archivo de destino (- para la pantalla): ";
+    std::cin >> archivo;
+    configuracionReporte.archivo = archivo == "-" ? "" : archivo;
+
+    std::cout << "Cantidad de fichas a omitir al inicio: ";
+    std::cin >> configuracionReporte.desde;
+    std::cout << "Cantidad máxima de fichas por reporte (0 = sin límite): ";
+    std::cin >> configuracionReporte.limite;
+    std::cout << "Configuración de reportes actualizada." << std::endl;
+}
+
+void configurarHilosReportes() {
+    int hilos;
+    std::cout << "Hilos para los reportes (1 = sin paralelismo, núcleos disponibles: "
+              << std::thread::hardware_concurrency() << "): ";
+    std::cin >> hilos;
+    if (hilos < 1) {
+        std::cout << "Cantidad de hilos inválida." << std::endl;
+        return;
+    }
+    hilosReportes = hilos;
+    std::cout << "Los reportes usarán " << hilosReportes << " hilos." << std::endl;
+}
+
+void guardarInstantaneaInteractivo() {
+    if (planta.tieneEstado()) {
+        planta.compactarDiario();
+        return;
+    }
+    std::string ruta;
+    std::cout << "Ingrese la ruta de la instantánea: ";
+    std::cin >> ruta;
+    planta.guardarInstantanea(ruta);
+}
+
+// Exportación de métricas
+// Las métricas se escriben en el formato de texto de Prometheus: un histograma por operación de
+// InventarioPlanta y por acción del menú (la acción incluye la lectura de los datos que pide), y el
+// tamaño de los inventarios. Con --metricas archivo [segundos] se vuelcan al archivo, reemplazándolo de
+// forma atómica, al terminar una opción del menú si pasó el intervalo, y al salir. No hace falta un
+// hilo propio: entre dos opciones del menú nada cambia.
+
+const char* nombreAccionMenu(int opcion) {
+    switch (opcion) {
+        case 1:  return "agregar_motor";
+        case 2:  return "ensamblar_carro";
+        case 3:  return "mostrar_motores_disponibles";
+        case 4:  return "mostrar_carros_alta_velocidad";
+        case 5:  return "mostrar_omnibus_mayor_capacidad";
+        case 6:  return "mostrar_fichas_tecnicas";
+        case 7:  return "dar_de_baja_carro";
+        case 8:  return "mostrar_motores_reensamblados";
+        case 9:  return "mostrar_cumplimiento_plan";
+        case 10: return "mostrar_ganancia_total";
+        case 12: return "importar_archivo";
+        case 13: return "mostrar_estadisticas_memoria";
+        case 14: return "mostrar_tablero_produccion";
+        case 15: return "verificar_agregados";
+        case 16: return "configurar_reportes";
+        case 17: return "guardar_instantanea";
+        case 18: return "simular_linea_concurrente";
+        case 19: return "configurar_hilos_reportes";
+        case 20: return "mostrar_produccion_periodo";
+        case 21: return "mostrar_cumplimiento_mensual";
+        case 22: return "mostrar_calidad_especialistas";
+        case 23: return "mostrar_metricas";
+        case 24: return "ensamblar_lote";
+        case 25: return "mostrar_clasificaciones";
+        case 26: return "archivar_carros";
+        case 27: return "consultar_historico";
+        default: return nullptr;
+    }
+}
+
+void agregarLinea(std::string& salida, const char* formato, ...) __attribute__((format(printf, 2, 3)));
+
+void agregarLinea(std::string& salida, const char* formato, ...) {
+    char linea[256];
+    va_list argumentos;
+    va_start(argumentos, formato);
+    int longitud = std::vsnprintf(linea, sizeof(linea), formato, argumentos);
+    va_end(argumentos);
+    salida.append(linea, std::min<size_t>(std::max(longitud, 0), sizeof(linea) - 1));
+}
+
+void escribirHistograma(std::string& salida, const char* metrica, const char* etiqueta, const char* valor,
+                        const HistogramaLatencia& histograma) {
+    uint64_t acumulado = 0;
+    for (int i = 0; i < CUBETAS_LATENCIA; ++i) {
+        acumulado += histograma.getCubeta(i);
+        agregarLinea(salida, "%s_bucket{%s=\"%s\",le=\"%.9g\"} %llu\n", metrica, etiqueta, valor,
+                     HistogramaLatencia::limiteNs(i) * 1e-9, static_cast<unsigned long long>(acumulado));
+    }
+    acumulado += histograma.getCubeta(CUBETAS_LATENCIA);
+    agregarLinea(salida, "%s_bucket{%s=\"%s\",le=\"+Inf\"} %llu\n", metrica, etiqueta, valor,
+                 static_cast<unsigned long long>(acumulado));
+    agregarLinea(salida, "%s_sum{%s=\"%s\"} %.9f\n", metrica, etiqueta, valor, histograma.getSumaNs() * 1e-9);
+    agregarLinea(salida, "%s_count{%s=\"%s\"} %llu\n", metrica, etiqueta, valor,
+                 static_cast<unsigned long long>(histograma.getCantidad()));
+}
+
+std::string escribirMetricas() {
+    std::string salida;
+    salida += "# HELP planta_operacion_segundos Duración de las operaciones de la planta.\n";
+    salida += "# TYPE planta_operacion_segundos histogram\n";
+    for (int i = 0; i < CANTIDAD_OPERACIONES_PLANTA; ++i) {
+        escribirHistograma(salida, "planta_operacion_segundos", "operacion",
+                           nombreOperacionPlanta(static_cast<OperacionPlanta>(i)), latenciaOperaciones[i]);
+    }
+    salida += "# HELP planta_accion_menu_segundos Duración de las acciones del menú principal.\n";
+    salida += "# TYPE planta_accion_menu_segundos histogram\n";
+    for (int opcion = 0; opcion <= MAX_OPCION_MENU; ++opcion) {
+        if (nombreAccionMenu(opcion)) {
+            escribirHistograma(salida, "planta_accion_menu_segundos", "accion", nombreAccionMenu(opcion),
+                               latenciaAccionesMenu[opcion]);
+        }
+    }
+
+    salida += "# HELP planta_motores_disponibles Motores en el inventario por tipo.\n";
+    salida += "# TYPE planta_motores_disponibles gauge\n";
+    agregarLinea(salida, "planta_motores_disponibles{tipo=\"alta\"} %zu\n",
+                 planta.cantidadMotoresDisponibles(TipoMotor::Alta));
+    agregarLinea(salida, "planta_motores_disponibles{tipo=\"fuerza\"} %zu\n",
+                 planta.cantidadMotoresDisponibles(TipoMotor::Fuerza));
+    agregarLinea(salida, "planta_motores_disponibles{tipo=\"trabajo\"} %zu\n",
+                 planta.cantidadMotoresDisponibles(TipoMotor::Trabajo));
+    salida += "# HELP planta_carros_ensamblados Carros ensamblados en el inventario.\n";
+    salida += "# TYPE planta_carros_ensamblados gauge\n";
+    agregarLinea(salida, "planta_carros_ensamblados %zu\n", planta.carros().size());
+    salida += "# HELP planta_motores_producidos_total Motores producidos.\n";
+    salida += "# TYPE planta_motores_producidos_total counter\n";
+    agregarLinea(salida, "planta_motores_producidos_total %ld\n", planta.getMotoresProducidos());
+    salida += "# HELP planta_carros_producidos_total Carros producidos.\n";
+    salida += "# TYPE planta_carros_producidos_total counter\n";
+    agregarLinea(salida, "planta_carros_producidos_total %ld\n", planta.getCarrosProducidos());
+    return salida;
+}
+
+bool volcarMetricas() {
+    ultimoVolcadoMetricas = std::chrono::steady_clock::now();
+    if (!escribirArchivoAtomico(archivoMetricas, escribirMetricas())) {
+        std::cout << "No se pudieron escribir las métricas en " << archivoMetricas << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void volcarMetricasSiCorresponde() {
+    if (archivoMetricas.empty()) {
+        return;
+    }
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - ultimoVolcadoMetricas).count();
+    if (segundos >= intervaloMetricas) {
+        volcarMetricas();
+    }
+}
+
+void mostrarMetricas() {
+    if (!metricasActivas) {
+        metricasActivas = true;
+        std::cout << "Las métricas estaban desactivadas; se registran a partir de ahora." << std::endl;
+    }
+    std::cout << escribirMetricas() << std::flush;
+}
+
+void mostrarResumenImportacion(const std::string& ruta, const ResumenImportacion& resumen) {
+    if (!resumen.abierto) {
+        std::cout << "No se pudo abrir el archivo " << ruta << "." << std::endl;
+        return;
+    }
+    for (const std::string& rechazo : resumen.primerosRechazos) {
+        std::cout << rechazo << std::endl;
+    }
+
+    long cargados = resumen.motoresCargados + resumen.carrosCargados;
+    double porSegundo = resumen.segundos > 0 ? cargados / resumen.segundos : 0;
+
+    std::cout << "Importación de " << ruta << " terminada en " << resumen.segundos << " s." << std::endl;
+    std::cout << "Motores cargados: " << resumen.motoresCargados << std::endl;
+    std::cout << "Carros ensamblados: " << resumen.carrosCargados << std::endl;
+    std::cout << "Registros rechazados: " << resumen.rechazados << std::endl;
+    std::cout << "Registros cargados por segundo: " << porSegundo << std::endl;
+}
+
+void importarDesdeArchivo() {
+    std::string ruta;
+    std::cout << "Ingrese la ruta del archivo a importar: ";
+    std::cin >> ruta;
+    mostrarResumenImportacion(ruta, planta.importar(ruta));
+}
+
+void ensamblarLoteDesdeArchivo(const std::string& ruta) {
+    std::vector<PedidoCarro> pedidos;
+    long rechazados = 0;
+    if (!leerLotePedidos(ruta, pedidos, rechazados)) {
+        std::cout << "No se pudo abrir el archivo " << ruta << "." << std::endl;
+        return;
+    }
+    AsignacionLote lote = planta.ensamblarLote(pedidos);
+
+    long sinMotor = 0;
+    long invalidos = 0;
+    for (Resultado resultado : lote.resultados) {
+        if (resultado == Resultado::SinMotoresDisponibles || resultado == Resultado::SinMotoresArtesanales) {
+            sinMotor++;
+        } else if (resultado != Resultado::Exito) {
+            invalidos++;
+        }
+    }
+    std::cout << "Pedidos del lote: " << pedidos.size() << " (" << rechazados << " registros con formato inválido)"
+              << std::endl;
+    std::cout << "Carros ensamblados: " << lote.ensamblados << std::endl;
+    std::cout << "Pedidos sin motor disponible: " << sinMotor << std::endl;
+    std::cout << "Pedidos con datos inválidos: " << invalidos << std::endl;
+    std::cout << "Ganancia del lote: " << lote.ganancia << " (pedido por pedido: " << lote.gananciaHabitual << ")"
+              << std::endl;
+    std::cout << "Planificación terminada en " << lote.milisegundosPlan << " ms." << std::endl;
+}
+
+void ensamblarLoteInteractivo() {
+    std::string ruta;
+    std::cout << "Ingrese la ruta del archivo de pedidos: ";
+    std::cin >> ruta;
+    ensamblarLoteDesdeArchivo(ruta);
+}
+
+// Servicio de la planta por un socket local
+// Con --servidor ruta la planta atiende a varios clientes por un socket Unix en lugar del menú, con un
+// hilo por conexión. Cada petición es una línea de texto:
+//   MOTOR,... y CARRO,...     Alta de motor y ensamblaje, con los campos del archivo de importación
+//   BAJA,codigo               Baja del carro que lleva el motor indicado
+//   TABLERO                   Tablero de producción, en líneas clave=valor
+//   PRODUCCION,desde,hasta    Producción entre dos fechas DD/MM/AAAA, en líneas clave=valor
+//   METRICAS                  Métricas en el formato de texto de Prometheus
+//   MOTORES, ALTA_VELOCIDAD, OMNIBUS, FICHAS o REENSAMBLADOS [,formato[,desde[,limite]]]
+//                             Reportes de listado; formato es TEXTO, CSV o JSON y desde y limite paginan
+//   APAGAR                    Detiene el servicio
+// La respuesta es una línea "OK" o "ERROR motivo" seguida de los datos en bloques "<longitud>\n<bytes>"
+// y de un bloque vacío "0\n" (también cuando no hay datos).
+//
+// Las escrituras se ejecutan de a una con mutexPlanta tomado y se confirman en el diario antes de
+// responder. Los reportes de carros toman el mutex solo para publicar una versión del espejo de carros
+// y se escriben después sin bloquear a los escritores, aunque el cliente los lea despacio. Los motores
+// disponibles y el ómnibus de mayor capacidad se copian con el mutex tomado (la copia es proporcional a
+// los motores en inventario, no a los carros), y las consultas cortas (tablero, producción, métricas)
+// se calculan con el mutex tomado porque leen los agregados incrementales.
+
+const size_t MAX_PETICION = 64 * 1024;
+
+struct ServicioPlanta {
+    int escucha = -1;
+    std::atomic<bool> apagando{false};
+    std::mutex mutexPlanta;                  // Serializa las escrituras y las lecturas del inventario
+    std::mutex mutexClientes;
+    std::condition_variable sinClientes;
+    std::vector<int> clientes;               // Conexiones abiertas, para cerrarlas al apagar
+};
+
+// Motores disponibles copiados por valor, para escribir el reporte sin el mutex tomado
+struct CopiaMotoresDisponibles {
+    std::vector<MotorAlta> alta;
+    std::vector<MotorFuerza> fuerza;
+    std::vector<MotorTrabajo> trabajo;
+
+    explicit CopiaMotoresDisponibles(const MotoresDisponibles& motores) {
+        alta.reserve(motores.alta.size());
+        for (const MotorAlta* motor : motores.alta) {
+            alta.push_back(*motor);
+        }
+        fuerza.reserve(motores.fuerza.size());
+        for (const MotorFuerza* motor : motores.fuerza) {
+            fuerza.push_back(*motor);
+        }
+        trabajo.reserve(motores.trabajo.size());
+        for (const MotorTrabajo* motor : motores.trabajo) {
+            trabajo.push_back(*motor);
+        }
+    }
+
+    MotoresDisponibles punteros() const {
+        MotoresDisponibles motores;
+        for (const auto& motor : alta) {
+            motores.alta.push_back(&motor);
+        }
+        for (const auto& motor : fuerza) {
+            motores.fuerza.push_back(&motor);
+        }
+        for (const auto& motor : trabajo) {
+            motores.trabajo.push_back(&motor);
+        }
+        return motores;
+    }
+};
+
+bool enviarTodo(int descriptor, const char* datos, size_t longitud) {
+    while (longitud > 0) {
+        ssize_t enviados = send(descriptor, datos, longitud, MSG_NOSIGNAL);
+        if (enviados < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        datos += enviados;
+        longitud -= static_cast<size_t>(enviados);
+    }
+    return true;
+}
+
+// Envía la línea de estado, los datos en un solo bloque (si hay) y el bloque final
+bool responder(int descriptor, std::string_view estado, std::string_view datos = std::string_view()) {
+    std::string respuesta(estado);
+    respuesta += '\n';
+    if (!datos.empty()) {
+        respuesta += std::to_string(datos.size());
+        respuesta += '\n';
+        respuesta += datos;
+    }
+    respuesta += "0\n";
+    return enviarTodo(descriptor, respuesta.data(), respuesta.size());
+}
+
+// Flujo de escritura que envía cada volcado del reporte como un bloque de la respuesta
+ssize_t escribirBloqueRespuesta(void* cookie, const char* datos, size_t longitud) {
+    int descriptor = static_cast<int>(reinterpret_cast<intptr_t>(cookie));
+    char cabecera[24];
+    int longitudCabecera = std::snprintf(cabecera, sizeof(cabecera), "%zu\n", longitud);
+    if (!enviarTodo(descriptor, cabecera, longitudCabecera) || !enviarTodo(descriptor, datos, longitud)) {
+        return -1;
+    }
+    return static_cast<ssize_t>(longitud);
+}
+
+// Responde OK y escribe el reporte de escribirCuerpo(escritor) en bloques
+template <typename EscribirCuerpo>
+bool responderReporte(int descriptor, const ConfiguracionReporte& configuracion, EscribirCuerpo escribirCuerpo) {
+    if (!enviarTodo(descriptor, "OK\n", 3)) {
+        return false;
+    }
+    cookie_io_functions_t funciones = {nullptr, escribirBloqueRespuesta, nullptr, nullptr};
+    FILE* bloques = fopencookie(reinterpret_cast<void*>(static_cast<intptr_t>(descriptor)), "w", funciones);
+    if (!bloques) {
+        return false;
+    }
+    {
+        EscritorReporte escritor(configuracion, bloques);
+        escribirCuerpo(escritor);
+    }
+    bool enviado = std::ferror(bloques) == 0;
+    enviado = std::fclose(bloques) == 0 && enviado;
+    return enviado && enviarTodo(descriptor, "0\n", 2);
+}
+
+bool leerFormatoReporte(std::string_view texto, FormatoReporte& formato) {
+    if (texto == "TEXTO") {
+        formato = FormatoReporte::Texto;
+    } else if (texto == "CSV") {
+        formato = FormatoReporte::CSV;
+    } else if (texto == "JSON") {
+        formato = FormatoReporte::JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string escribirTableroClaveValor(const TableroProduccion& tablero) {
+    const char* claves[CANTIDAD_TIPOS_CARRO] = {"formula1", "omnibus", "sport", "de_lujo"};
+    std::string salida;
+    agregarLinea(salida, "motores_alta=%zu\n", tablero.motoresAlta);
+    agregarLinea(salida, "motores_fuerza=%zu\n", tablero.motoresFuerza);
+    agregarLinea(salida, "motores_trabajo=%zu\n", tablero.motoresTrabajo);
+    agregarLinea(salida, "motores_artesanales=%zu\n", tablero.motoresArtesanales);
+    agregarLinea(salida, "carros_ensamblados=%zu\n", tablero.carrosEnsamblados);
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        agregarLinea(salida, "carros_%s=%ld\n", claves[i], tablero.carrosPorTipo[i]);
+        agregarLinea(salida, "ganancia_%s=%.15g\n", claves[i], tablero.ganancias.porTipo[i]);
+    }
+    agregarLinea(salida, "ganancia_total=%.15g\n", tablero.ganancias.total);
+    agregarLinea(salida, "carros_alta_velocidad=%ld\n", tablero.carrosAltaVelocidad);
+    agregarLinea(salida, "mayor_capacidad_omnibus=%d\n", tablero.mayorCapacidadOmnibus);
+    agregarLinea(salida, "cumplimiento_motores=%.15g\n", tablero.cumplimiento.porcentajeMotores);
+    agregarLinea(salida, "cumplimiento_carros=%.15g\n", tablero.cumplimiento.porcentajeCarros);
+    if (tablero.historico.abierto) {
+        for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+            agregarLinea(salida, "archivados_%s=%ld\n", claves[i], tablero.historico.archivadosPorTipo[i]);
+            agregarLinea(salida, "ganancia_archivada_%s=%.15g\n", claves[i], tablero.historico.gananciaArchivada[i]);
+        }
+        agregarLinea(salida, "retirados_historico=%ld\n", tablero.historico.retirados);
+    }
+    return salida;
+}
+
+// Atiende una petición; devuelve false si la conexión debe cerrarse
+bool atenderPeticion(ServicioPlanta& servicio, int descriptor, std::string_view peticion) {
+    std::string_view campos[4];
+    int cantidadCampos = 0;
+    std::string_view resto = peticion;
+    while (cantidadCampos < 4) {
+        size_t coma = resto.find(',');
+        campos[cantidadCampos++] = resto.substr(0, coma);
+        if (coma == std::string_view::npos) {
+            break;
+        }
+        resto.remove_prefix(coma + 1);
+    }
+    std::string_view comando = campos[0];
+
+    // Escrituras
+    if (comando == "MOTOR" || comando == "CARRO" || comando == "BAJA") {
+        const char* motivo = nullptr;
+        {
+            std::lock_guard<std::mutex> bloqueo(servicio.mutexPlanta);
+            if (comando == "BAJA") {
+                Resultado resultado = cantidadCampos == 2 ? planta.darDeBajaCarro(campos[1]) : Resultado::CarroNoEncontrado;
+                if (resultado != Resultado::Exito) {
+                    motivo = mensajeResultado(resultado);
+                }
+            } else {
+                motivo = planta.importarLinea(peticion);
+            }
+            planta.confirmarDiario();
+            volcarMetricasSiCorresponde();
+        }
+        return motivo ? responder(descriptor, std::string("ERROR ") + motivo) : responder(descriptor, "OK");
+    }
+
+    // Consultas cortas
+    if (comando == "TABLERO") {
+        TableroProduccion tablero;
+        {
+            std::lock_guard<std::mutex> bloqueo(servicio.mutexPlanta);
+            tablero = planta.tablero();
+        }
+        return responder(descriptor, "OK", escribirTableroClaveValor(tablero));
+    }
+    if (comando == "PRODUCCION") {
+        Fecha desde, hasta;
+        if (cantidadCampos != 3 || !Fecha::desdeTexto(campos[1], desde) || !Fecha::desdeTexto(campos[2], hasta)) {
+            return responder(descriptor, std::string("ERROR ") + mensajeResultado(Resultado::FechaInvalida));
+        }
+        ProduccionPeriodo produccion;
+        {
+            std::lock_guard<std::mutex> bloqueo(servicio.mutexPlanta);
+            produccion = planta.produccionEntre(desde, hasta);
+        }
+        std::string datos;
+        agregarLinea(datos, "motores=%ld\ncarros=%ld\n", produccion.motores, produccion.carros);
+        return responder(descriptor, "OK", datos);
+    }
+    if (comando == "METRICAS") {
+        std::string metricas;
+        {
+            std::lock_guard<std::mutex> bloqueo(servicio.mutexPlanta);
+            metricas = escribirMetricas();
+        }
+        return responder(descriptor, "OK", metricas);
+    }
+    if (comando == "APAGAR") {
+        // Se responde antes de despertar al hilo principal, que cierra todas las conexiones
+        responder(descriptor, "OK");
+        servicio.apagando = true;
+        shutdown(servicio.escucha, SHUT_RDWR);
+        return false;
+    }
+
+    // Reportes de listado
+    ConfiguracionReporte configuracion;
+    int desde = 0;
+    int limite = 0;
+    if ((cantidadCampos > 1 && !leerFormatoReporte(campos[1], configuracion.formato)) ||
+        (cantidadCampos > 2 && !leerEntero(campos[2], desde)) || (cantidadCampos > 3 && !leerEntero(campos[3], limite))) {
+        return responder(descriptor, "ERROR formato inválido");
+    }
+    configuracion.desde = desde;
+    configuracion.limite = limite;
+
+    if (comando == "MOTORES") {
+        std::optional<CopiaMotoresDisponibles> motores;
+        {
+            std::lock_guard<std::mutex> bloqueo(servicio.mutexPlanta);
+            motores.emplace(planta.motoresDisponibles());
+        }
+        MotoresDisponibles punteros = motores->punteros();
+        return responderReporte(descriptor, configuracion, [&punteros](EscritorReporte& escritor) {
+            escribirReporteMotoresDisponibles(escritor, punteros);
+        });
+    }
+    if (comando == "OMNIBUS") {
+        std::optional<CopiaCarro> omnibus;
+        {
+            std::lock_guard<std::mutex> bloqueo(servicio.mutexPlanta);
+            if (const Carro* mayor = planta.omnibusMayorCapacidad()) {
+                omnibus.emplace(*mayor);
+            }
+        }
+        if (!omnibus) {
+            return responder(descriptor, "ERROR No hay ómnibus en el inventario.");
+        }
+        return responderReporte(descriptor, configuracion, [&omnibus](EscritorReporte& escritor) {
+            escribirReporteOmnibus(escritor, omnibus->getCarro());
+        });
+    }
+    if (comando != "ALTA_VELOCIDAD" && comando != "FICHAS" && comando != "REENSAMBLADOS") {
+        return responder(descriptor, "ERROR petición desconocida");
+    }
+
+    std::shared_ptr<const VersionCarros> version;
+    {
+        std::lock_guard<std::mutex> bloqueo(servicio.mutexPlanta);
+        version = planta.publicarEspejoCarros();
+    }
+    const VersionCarros& carros = *version;
+    auto acceso = [&carros](size_t i) -> const Carro& { return carros[i]; };
+    if (comando == "ALTA_VELOCIDAD") {
+        MedicionLatencia medicion(OperacionPlanta::CarrosAltaVelocidad);
+        OperacionTrazada traza(OperacionPlanta::CarrosAltaVelocidad);
+        std::vector<size_t> posiciones;
+        filtrarAltaVelocidad(carros, posiciones);
+        std::vector<const Carro*> rapidos;
+        rapidos.reserve(posiciones.size());
+        for (size_t posicion : posiciones) {
+            rapidos.push_back(&carros[posicion]);
+        }
+        return responderReporte(descriptor, configuracion, [&rapidos](EscritorReporte& escritor) {
+            escribirReporteAltaVelocidad(escritor, rapidos);
+        });
+    }
+    if (comando == "FICHAS") {
+        MedicionLatencia medicion(OperacionPlanta::FichasCarros);
+        OperacionTrazada traza(OperacionPlanta::FichasCarros);
+        return responderReporte(descriptor, configuracion, [&](EscritorReporte& escritor) {
+            escribirReporteFichas(escritor, carros.size(), acceso);
+        });
+    }
+    MedicionLatencia medicion(OperacionPlanta::CarrosReensamblados);
+    OperacionTrazada traza(OperacionPlanta::CarrosReensamblados);
+    std::vector<CarroReensamblado> reensamblados = buscarCarrosReensamblados(carros.size(), acceso);
+    return responderReporte(descriptor, configuracion, [&reensamblados](EscritorReporte& escritor) {
+        escribirReporteReensamblados(escritor, reensamblados);
+    });
+}
+
+void atenderCliente(ServicioPlanta& servicio, int descriptor) {
+    {
+        std::string pendiente;
+        char bufer[4096];
+        bool abierta = true;
+        while (abierta) {
+            ssize_t leidos = read(descriptor, bufer, sizeof(bufer));
+            if (leidos < 0 && errno == EINTR) {
+                continue;
+            }
+            if (leidos <= 0) {
+                break;
+            }
+            pendiente.append(bufer, static_cast<size_t>(leidos));
+
+            size_t inicio = 0;
+            size_t fin;
+            while (abierta && (fin = pendiente.find('\n', inicio)) != std::string::npos) {
+                std::string_view peticion(pendiente.data() + inicio, fin - inicio);
+                if (!peticion.empty() && peticion.back() == '\r') {
+                    peticion.remove_suffix(1);
+                }
+                if (!peticion.empty()) {
+                    abierta = atenderPeticion(servicio, descriptor, peticion);
+                }
+                inicio = fin + 1;
+            }
+            pendiente.erase(0, inicio);
+            if (pendiente.size() > MAX_PETICION) {
+                responder(descriptor, "ERROR petición demasiado larga");
+                break;
+            }
+        }
+    }
+
+    // La conexión se quita de la lista antes de cerrarla, para que al apagar no se cierre otra que
+    // reciba el mismo descriptor
+    std::lock_guard<std::mutex> bloqueo(servicio.mutexClientes);
+    servicio.clientes.erase(std::find(servicio.clientes.begin(), servicio.clientes.end(), descriptor));
+    close(descriptor);
+    if (servicio.clientes.empty()) {
+        servicio.sinClientes.notify_all();
+    }
+}
+
+bool direccionSocket(const std::string& ruta, sockaddr_un& direccion) {
+    if (ruta.size() >= sizeof(direccion.sun_path)) {
+        std::cout << "La ruta del socket es demasiado larga: " << ruta << std::endl;
+        return false;
+    }
+    std::memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    std::memcpy(direccion.sun_path, ruta.c_str(), ruta.size() + 1);
+    return true;
+}
+
+int ejecutarServidor(const std::string& ruta) {
+    sockaddr_un direccion;
+    if (!direccionSocket(ruta, direccion)) {
+        return 1;
+    }
+    ServicioPlanta servicio;
+    servicio.escucha = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(ruta.c_str());
+    if (servicio.escucha < 0 || bind(servicio.escucha, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 ||
+        listen(servicio.escucha, 64) != 0) {
+        std::cout << "No se pudo escuchar en " << ruta << ": " << std::strerror(errno) << std::endl;
+        if (servicio.escucha >= 0) {
+            close(servicio.escucha);
+        }
+        return 1;
+    }
+
+    planta.activarEspejoCarros();
+    if (!iniciarGrabacionTraza()) {
+        close(servicio.escucha);
+        unlink(ruta.c_str());
+        return 1;
+    }
+    std::cout << "Planta atendiendo en " << ruta << " (" << planta.carros().size() << " carros ensamblados)."
+              << std::endl;
+
+    while (!servicio.apagando) {
+        int cliente = accept4(servicio.escucha, nullptr, nullptr, SOCK_CLOEXEC);
+        if (cliente < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        std::lock_guard<std::mutex> bloqueo(servicio.mutexClientes);
+        servicio.clientes.push_back(cliente);
+        std::thread(atenderCliente, std::ref(servicio), cliente).detach();
+    }
+
+    // Despertar a los clientes que esperan una petición y esperar a que terminen
+    {
+        std::unique_lock<std::mutex> bloqueo(servicio.mutexClientes);
+        for (int cliente : servicio.clientes) {
+            shutdown(cliente, SHUT_RDWR);
+        }
+        servicio.sinClientes.wait(bloqueo, [&servicio] { return servicio.clientes.empty(); });
+    }
+    close(servicio.escucha);
+    unlink(ruta.c_str());
+    std::cout << "Servicio detenido." << std::endl;
+    terminarGrabacionTraza();
+
+    planta.cerrarEstado();
+    if (!archivoMetricas.empty()) {
+        volcarMetricas();
+    }
+    planta.liberarInventario();
+    return 0;
+}
+
+// Cliente de línea de comandos: envía cada línea de la entrada estándar como una petición y escribe los
+// datos de las respuestas en la salida estándar y los errores en la salida de errores
+int ejecutarCliente(const std::string& ruta) {
+    sockaddr_un direccion;
+    if (!direccionSocket(ruta, direccion)) {
+        return 1;
+    }
+    int descriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (descriptor < 0 || connect(descriptor, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0) {
+        std::cout << "No se pudo conectar con " << ruta << ": " << std::strerror(errno) << std::endl;
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+        return 1;
+    }
+    FILE* respuestas = fdopen(descriptor, "r");
+
+    int codigoSalida = 0;
+    std::string peticion;
+    std::vector<char> bloque;
+    char* linea = nullptr;
+    size_t capacidadLinea = 0;
+    while (std::getline(std::cin, peticion)) {
+        if (peticion.empty()) {
+            continue;
+        }
+        peticion += '\n';
+        if (!enviarTodo(descriptor, peticion.data(), peticion.size()) ||
+            getline(&linea, &capacidadLinea, respuestas) <= 0) {
+            std::cerr << "Se perdió la conexión con el servicio." << std::endl;
+            codigoSalida = 1;
+            break;
+        }
+        if (std::strncmp(linea, "OK", 2) != 0) {
+            std::cerr << linea;
+            codigoSalida = 1;
+        }
+        size_t longitud;
+        while (getline(&linea, &capacidadLinea, respuestas) > 0 && (longitud = std::strtoul(linea, nullptr, 10)) > 0) {
+            bloque.resize(longitud);
+            if (std::fread(bloque.data(), 1, longitud, respuestas) != longitud) {
+                break;
+            }
+            std::fwrite(bloque.data(), 1, longitud, stdout);
+        }
+        std::fflush(stdout);
+    }
+    std::free(linea);
+    std::fclose(respuestas);
+    return codigoSalida;
+}
+
+// Comparación de rendimiento entre carrosEnsamblados (punteros) y el almacén columnar
+// Genera carros sintéticos fuera del inventario y mide los cálculos de los tres reportes agregados.
+
+const int REPETICIONES_MEDICION = 5;
+
+template <typename Funcion>
+double medirMejorTiempoMs(Funcion funcion) {
+    double mejor = 0;
+    for (int i = 0; i < REPETICIONES_MEDICION; ++i) {
+        auto inicio = std::chrono::steady_clock::now();
+        funcion();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        if (i == 0 || ms < mejor) {
+            mejor = ms;
+        }
+    }
+    return mejor;
+}
+
+void compararAlmacenColumnar(size_t cantidadCarros) {
+    std::mt19937 generador(12345);
+    std::uniform_int_distribution<int> tipoAleatorio(0, CANTIDAD_TIPOS_CARRO - 1);
+    std::uniform_real_distribution<double> velocidadAleatoria(60, 350);
+    std::uniform_int_distribution<int> entero(0, 1 << 30);
+
+    std::vector<Carro*> carros;
+    carros.reserve(cantidadCarros);
+    AlmacenColumnarCarros almacen;
+    almacen.reservar(cantidadCarros);
+
+    const Fecha salidaMotor = Fecha::desdeCivil(1, 1, 2024);
+    const Fecha salidaCarro = Fecha::desdeCivil(2, 1, 2024);
+    TablaEspecialistas especialistas;
+    const Especialista* especialista = especialistas.registrar("Banco");
+    char texto[24];
+    CodigoMotor codigo;
+    for (size_t i = 0; i < cantidadCarros; ++i) {
+        std::snprintf(texto, sizeof(texto), "B%011zu", i);
+        CodigoMotor::desdeTexto(texto, codigo);
+        int veces = entero(generador) % 4;
+        double velocidad = velocidadAleatoria(generador);
+        Carro* carro = nullptr;
+        switch (static_cast<TipoCarro>(tipoAleatorio(generador))) {
+            case TipoCarro::Formula1:
+                carro = new Formula1(new MotorAlta(codigo, salidaMotor, especialista, veces, 8000 + entero(generador) % 7000,
+                                                   2 + entero(generador) % 8),
+                                     velocidad, salidaCarro, 500 + entero(generador) % 300);
+                break;
+            case TipoCarro::Omnibus:
+                carro = new Omnibus(new MotorFuerza(codigo, salidaMotor, especialista, veces, 80 + entero(generador) % 3921),
+                                    velocidad, salidaCarro, 1 + entero(generador) % 4);
+                break;
+            case TipoCarro::Sport:
+                carro = new Sport(new MotorTrabajo(codigo, salidaMotor, especialista, veces, false), 2 + entero(generador) % 3,
+                                  velocidad, salidaCarro, 4 + entero(generador) % 4, entero(generador) % 2);
+                break;
+            case TipoCarro::DeLujo:
+                carro = new DeLujo(new MotorTrabajo(codigo, salidaMotor, especialista, veces, true), 2 + entero(generador) % 3,
+                                   velocidad, salidaCarro, 100 + entero(generador) % 900);
+                break;
+        }
+        carros.push_back(carro);
+        almacen.agregar(carro);
+    }
+
+    double gananciasPunteros[CANTIDAD_TIPOS_CARRO], gananciasColumnar[CANTIDAD_TIPOS_CARRO];
+    std::vector<size_t> rapidosPunteros, rapidosColumnar;
+    size_t omnibusPunteros = SIN_CARRO, omnibusColumnar = SIN_CARRO;
+
+    double msGananciaPunteros = medirMejorTiempoMs([&] { calcularGananciasPorTipo(carros, gananciasPunteros); });
+    double msGananciaColumnar = medirMejorTiempoMs([&] { calcularGananciasPorTipo(almacen, gananciasColumnar); });
+    double msVelocidadPunteros = medirMejorTiempoMs([&] { filtrarAltaVelocidad(carros, rapidosPunteros); });
+    double msVelocidadColumnar = medirMejorTiempoMs([&] { filtrarAltaVelocidad(almacen, rapidosColumnar); });
+    double msOmnibusPunteros = medirMejorTiempoMs([&] { omnibusPunteros = buscarOmnibusMayorCapacidad(carros); });
+    double msOmnibusColumnar = medirMejorTiempoMs([&] { omnibusColumnar = buscarOmnibusMayorCapacidad(almacen); });
+
+    bool coinciden = rapidosPunteros == rapidosColumnar && omnibusPunteros == omnibusColumnar;
+    for (int i = 0; i < CANTIDAD_TIPOS_CARRO; ++i) {
+        coinciden = coinciden && gananciasPunteros[i] == gananciasColumnar[i];
+    }
+
+    auto mostrarFila = [](const char* reporte, double msPunteros, double msColumnar) {
+        std::printf("%-28s %12.2f ms %12.2f ms %8.1fx\n", reporte, msPunteros, msColumnar, msPunteros / msColumnar);
+    };
+    std::printf("Carros: %zu\n", cantidadCarros);
+    std::printf("%-28s %15s %15s %9s\n", "Reporte", "Punteros", "Columnar", "Mejora");
+    mostrarFila("Ganancia total por tipo", msGananciaPunteros, msGananciaColumnar);
+    mostrarFila("Carros de mayor velocidad", msVelocidadPunteros, msVelocidadColumnar);
+    mostrarFila("Omnibus de mayor capacidad", msOmnibusPunteros, msOmnibusColumnar);
+    std::printf("Resultados %s\n\n", coinciden ? "idénticos" : "DIFERENTES");
+
+    for (auto carro : carros) {
+        delete carro->getMotor();
+        delete carro;
+    }
+}
+
+// Línea de ensamblaje concurrente
+// Simula varias estaciones de motores y de ensamblaje trabajando a la vez, sobre una línea separada del
+// inventario de la planta. Las estaciones de motores fabrican los motores en sus propios pools y los
+// dejan en colas acotadas sin bloqueos, una por tipo (los de trabajo divididos en estándar y
+// artesanales). Las estaciones de ensamblaje toman pedidos de una lista común, sacan el motor de la cola
+// correspondiente, arman el carro en sus propios pools y lo anotan en un registro concurrente.
+// El pedido i usa el tipo de motor que fabrica el motor i, así que con las colas en orden de llegada
+// todos los pedidos se atienden; un Sport solo usa un motor artesanal cuando ya no llegarán más motores.
+
+// Cola acotada con varios productores y consumidores, sin bloqueos (algoritmo de D. Vyukov).
+// Cada celda lleva un número de secuencia que indica si está libre para la vuelta actual del productor
+// o lista para la del consumidor; las posiciones de encolar y desencolar se reservan con compare_exchange.
+template <typename T>
+class ColaAcotadaMPMC {
+private:
+    struct Celda {
+        std::atomic<size_t> secuencia;
+        T valor;
+    };
+
+    std::unique_ptr<Celda[]> celdas;
+    size_t mascara;
+    alignas(64) std::atomic<size_t> posicionEncolar{0};
+    alignas(64) std::atomic<size_t> posicionDesencolar{0};
+
+public:
+    explicit ColaAcotadaMPMC(size_t capacidad) {
+        size_t tamano = 2;
+        while (tamano < capacidad) {
+            tamano <<= 1;
+        }
+        celdas.reset(new Celda[tamano]);
+        mascara = tamano - 1;
+        for (size_t i = 0; i < tamano; ++i) {
+            celdas[i].secuencia.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Devuelve false si la cola está llena
+    bool intentarEncolar(T valor) {
+        size_t posicion = posicionEncolar.load(std::memory_order_relaxed);
+        while (true) {
+            Celda& celda = celdas[posicion & mascara];
+            size_t secuencia = celda.secuencia.load(std::memory_order_acquire);
+            intptr_t diferencia = static_cast<intptr_t>(secuencia) - static_cast<intptr_t>(posicion);
+            if (diferencia == 0) {
+                if (posicionEncolar.compare_exchange_weak(posicion, posicion + 1, std::memory_order_relaxed)) {
+                    celda.valor = valor;
+                    celda.secuencia.store(posicion + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diferencia < 0) {
+                return false;
+            } else {
+                posicion = posicionEncolar.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Devuelve false si la cola está vacía
+    bool intentarDesencolar(T& valor) {
+        size_t posicion = posicionDesencolar.load(std::memory_order_relaxed);
+        while (true) {
+            Celda& celda = celdas[posicion & mascara];
+            size_t secuencia = celda.secuencia.load(std::memory_order_acquire);
+            intptr_t diferencia = static_cast<intptr_t>(secuencia) - static_cast<intptr_t>(posicion + 1);
+            if (diferencia == 0) {
+                if (posicionDesencolar.compare_exchange_weak(posicion, posicion + 1, std::memory_order_relaxed)) {
+                    valor = celda.valor;
+                    celda.secuencia.store(posicion + mascara + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diferencia < 0) {
+                return false;
+            } else {
+                posicion = posicionDesencolar.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Registro de carros de capacidad fija donde varios hilos anotan a la vez: cada carro reserva su
+// posición con fetch_add. Una posición reservada que todavía no se escribió se lee como nullptr.
+class RegistroConcurrenteCarros {
+private:
+    std::unique_ptr<std::atomic<Carro*>[]> carros;
+    size_t capacidad;
+    alignas(64) std::atomic<size_t> reservadas{0};
+
+public:
+    explicit RegistroConcurrenteCarros(size_t capacidad) : carros(new std::atomic<Carro*>[capacidad]), capacidad(capacidad) {
+        for (size_t i = 0; i < capacidad; ++i) {
+            carros[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    bool registrar(Carro* carro) {
+        size_t posicion = reservadas.fetch_add(1, std::memory_order_relaxed);
+        if (posicion >= capacidad) {
+            return false;
+        }
+        carros[posicion].store(carro, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const { return std::min(reservadas.load(std::memory_order_acquire), capacidad); }
+    Carro* operator[](size_t posicion) const { return carros[posicion].load(std::memory_order_acquire); }
+};
+
+const size_t CAPACIDAD_COLA_LINEA = 4096;
+const size_t LOTE_LINEA = 64;    // Motores o pedidos que una estación reserva de una vez
+
+struct EstacionMotores {
+    PoolObjetos<MotorAlta> poolAlta;
+    PoolObjetos<MotorFuerza> poolFuerza;
+    PoolObjetos<MotorTrabajo> poolTrabajo;
+};
+
+struct EstacionEnsamblaje {
+    PoolObjetos<Formula1> poolFormula1;
+    PoolObjetos<Omnibus> poolOmnibus;
+    PoolObjetos<Sport> poolSport;
+    PoolObjetos<DeLujo> poolDeLujo;
+    long rechazados = 0;
+};
+
+struct LineaEnsamblaje {
+    ColaAcotadaMPMC<MotorAlta*> colaAlta{CAPACIDAD_COLA_LINEA};
+    ColaAcotadaMPMC<MotorFuerza*> colaFuerza{CAPACIDAD_COLA_LINEA};
+    ColaAcotadaMPMC<MotorTrabajo*> colaTrabajoEstandar{CAPACIDAD_COLA_LINEA};
+    ColaAcotadaMPMC<MotorTrabajo*> colaTrabajoArtesanal{CAPACIDAD_COLA_LINEA};
+    RegistroConcurrenteCarros registro;
+    size_t cantidad;
+    TablaEspecialistas especialistas;    // Propia de la línea; no admite registros concurrentes
+    const Especialista* especialista;    // Registrado antes de lanzar los hilos
+    alignas(64) std::atomic<size_t> siguienteMotor{0};
+    alignas(64) std::atomic<size_t> siguientePedido{0};
+    alignas(64) std::atomic<int> estacionesMotoresActivas{0};
+    ContadorProduccion motores;
+    ContadorProduccion carros;
+
+    explicit LineaEnsamblaje(size_t cantidad)
+        : registro(cantidad), cantidad(cantidad), especialista(especialistas.registrar("Linea")) {}
+};
+
+template <typename T>
+void encolarEsperando(ColaAcotadaMPMC<T*>& cola, T* motor) {
+    while (!cola.intentarEncolar(motor)) {
+        std::this_thread::yield();
+    }
+}
+
+// Saca un motor de la cola; si está vacía espera mientras queden estaciones de motores trabajando
+template <typename T>
+bool desencolarEsperando(ColaAcotadaMPMC<T*>& cola, const LineaEnsamblaje& linea, T*& motor) {
+    while (!cola.intentarDesencolar(motor)) {
+        if (linea.estacionesMotoresActivas.load(std::memory_order_acquire) == 0) {
+            return cola.intentarDesencolar(motor);
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void trabajarEstacionMotores(LineaEnsamblaje& linea, EstacionMotores& estacion, size_t ranura) {
+    ranuraContadorHilo = ranura;
+    const Fecha salida = Fecha::desdeCivil(1, 1, 2024);
+    char texto[24];
+    CodigoMotor codigo;
+    while (true) {
+        size_t inicio = linea.siguienteMotor.fetch_add(LOTE_LINEA, std::memory_order_relaxed);
+        if (inicio >= linea.cantidad) {
+            break;
+        }
+        size_t fin = std::min(inicio + LOTE_LINEA, linea.cantidad);
+        for (size_t i = inicio; i < fin; ++i) {
+            std::snprintf(texto, sizeof(texto), "L%011zu", i);
+            CodigoMotor::desdeTexto(texto, codigo);
+            int veces = static_cast<int>(i % 3);
+            switch (i % 4) {
+                case 0:
+                    encolarEsperando(linea.colaAlta, estacion.poolAlta.crear(codigo, salida, linea.especialista, veces,
+                                                                             8000.0 + i % 7000, 2.0 + i % 8));
+                    break;
+                case 1:
+                    encolarEsperando(linea.colaFuerza, estacion.poolFuerza.crear(codigo, salida, linea.especialista, veces,
+                                                                                 static_cast<int>(80 + i % 3921)));
+                    break;
+                case 2:
+                    encolarEsperando(linea.colaTrabajoEstandar,
+                                     estacion.poolTrabajo.crear(codigo, salida, linea.especialista, veces, false));
+                    break;
+                default:
+                    encolarEsperando(linea.colaTrabajoArtesanal,
+                                     estacion.poolTrabajo.crear(codigo, salida, linea.especialista, veces, true));
+                    break;
+            }
+            linea.motores++;
+        }
+    }
+    linea.estacionesMotoresActivas.fetch_sub(1, std::memory_order_release);
+}
+
+void trabajarEstacionEnsamblaje(LineaEnsamblaje& linea, EstacionEnsamblaje& estacion, size_t ranura) {
+    ranuraContadorHilo = ranura;
+    const Fecha salida = Fecha::desdeCivil(2, 1, 2024);
+    while (true) {
+        size_t inicio = linea.siguientePedido.fetch_add(LOTE_LINEA, std::memory_order_relaxed);
+        if (inicio >= linea.cantidad) {
+            break;
+        }
+        size_t fin = std::min(inicio + LOTE_LINEA, linea.cantidad);
+        for (size_t i = inicio; i < fin; ++i) {
+            double velocidad = 60.0 + i % 290;
+            Carro* carro = nullptr;
+            switch (i % 4) {
+                case 0: {
+                    MotorAlta* motor;
+                    if (desencolarEsperando(linea.colaAlta, linea, motor)) {
+                        carro = estacion.poolFormula1.crear(motor, velocidad, salida, 500.0 + i % 300);
+                    }
+                    break;
+                }
+                case 1: {
+                    MotorFuerza* motor;
+                    if (desencolarEsperando(linea.colaFuerza, linea, motor)) {
+                        carro = estacion.poolOmnibus.crear(motor, velocidad, salida, static_cast<int>(1 + i % 4));
+                    }
+                    break;
+                }
+                case 2: {
+                    MotorTrabajo* motor;
+                    if (desencolarEsperando(linea.colaTrabajoEstandar, linea, motor) ||
+                        linea.colaTrabajoArtesanal.intentarDesencolar(motor)) {
+                        carro = estacion.poolSport.crear(motor, static_cast<int>(2 + i % 3), velocidad, salida,
+                                                         static_cast<int>(4 + i % 4), i % 2 == 0);
+                    }
+                    break;
+                }
+                default: {
+                    MotorTrabajo* motor;
+                    if (desencolarEsperando(linea.colaTrabajoArtesanal, linea, motor)) {
+                        carro = estacion.poolDeLujo.crear(motor, static_cast<int>(2 + i % 3), velocidad, salida,
+                                                          100.0 + i % 900);
+                    }
+                    break;
+                }
+            }
+            if (carro && linea.registro.registrar(carro)) {
+                linea.carros++;
+            } else {
+                estacion.rechazados++;
+            }
+        }
+    }
+}
+
+struct MedicionLinea {
+    double ms = 0;
+    long motores = 0;
+    long carros = 0;
+    long rechazados = 0;
+    bool consistente = false;
+};
+
+// Fabrica cantidad motores y atiende cantidad pedidos con el número de estaciones indicado de cada clase
+MedicionLinea ejecutarLineaConcurrente(size_t cantidad, size_t estaciones) {
+    LineaEnsamblaje linea(cantidad);
+    std::vector<EstacionMotores> estacionesMotores(estaciones);
+    std::vector<EstacionEnsamblaje> estacionesEnsamblaje(estaciones);
+    linea.estacionesMotoresActivas.store(static_cast<int>(estaciones));
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<std::thread> hilos;
+    for (size_t i = 0; i < estaciones; ++i) {
+        hilos.emplace_back(trabajarEstacionMotores, std::ref(linea), std::ref(estacionesMotores[i]), 1 + i);
+        hilos.emplace_back(trabajarEstacionEnsamblaje, std::ref(linea), std::ref(estacionesEnsamblaje[i]),
+                           1 + estaciones + i);
+    }
+    for (auto& hilo : hilos) {
+        hilo.join();
+    }
+
+    MedicionLinea medicion;
+    medicion.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    medicion.motores = linea.motores.valor();
+    medicion.carros = linea.carros.valor();
+    for (const auto& estacion : estacionesEnsamblaje) {
+        medicion.rechazados += estacion.rechazados;
+    }
+
+    // Cada motor debe haber terminado en exactamente un carro
+    std::unordered_map<const Motor*, int> usos;
+    usos.reserve(linea.registro.size());
+    bool registroCompleto = true;
+    for (size_t i = 0; i < linea.registro.size(); ++i) {
+        const Carro* carro = linea.registro[i];
+        registroCompleto = registroCompleto && carro && ++usos[carro->getMotor()] == 1;
+    }
+    medicion.consistente = registroCompleto && medicion.motores == static_cast<long>(cantidad) &&
+                           medicion.carros == static_cast<long>(linea.registro.size()) &&
+                           medicion.carros + medicion.rechazados == static_cast<long>(cantidad);
+
+    // Los carros se destruyen antes que los motores que llevan
+    estacionesEnsamblaje.clear();
+    estacionesMotores.clear();
+    return medicion;
+}
+
+// Mide la línea con 1 a maxEstaciones estaciones de motores y otras tantas de ensamblaje
+void medirLineaConcurrente(size_t cantidad, size_t maxEstaciones) {
+    std::printf("Línea concurrente: %zu motores y %zu pedidos, %u núcleos\n", cantidad, cantidad,
+                std::thread::hardware_concurrency());
+    std::printf("%-11s %12s %14s %14s %10s %12s\n", "Estaciones", "Tiempo", "Motores/s", "Carros/s", "Aceleración",
+                "Resultado");
+    double msBase = 0;
+    for (size_t estaciones = 1; estaciones <= maxEstaciones; ++estaciones) {
+        MedicionLinea medicion = ejecutarLineaConcurrente(cantidad, estaciones);
+        if (estaciones == 1) {
+            msBase = medicion.ms;
+        }
+        std::printf("%-11zu %9.1f ms %14.0f %14.0f %9.2fx %12s\n", estaciones, medicion.ms,
+                    medicion.motores / (medicion.ms / 1000), medicion.carros / (medicion.ms / 1000),
+                    msBase / medicion.ms, medicion.consistente ? "consistente" : "INCONSISTENTE");
+    }
+    std::fflush(stdout);
+}
+
+size_t estacionesPorDefecto() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void medirLineaConcurrenteInteractivo() {
+    size_t cantidad, maxEstaciones;
+    std::cout << "Cantidad de motores y pedidos a simular: ";
+    std::cin >> cantidad;
+    std::cout << "Máximo de estaciones de cada clase (0 = una por núcleo, " << estacionesPorDefecto() << "): ";
+    std::cin >> maxEstaciones;
+    if (cantidad == 0) {
+        std::cout << "Cantidad inválida." << std::endl;
+        return;
+    }
+    medirLineaConcurrente(cantidad, maxEstaciones ? maxEstaciones : estacionesPorDefecto());
+}
+
+// Generador sintético de datos de la planta
+// Produce motores y pedidos de carros realistas a partir de una semilla: la misma semilla da siempre
+// los mismos datos. mt19937_64 está definido por el estándar y la conversión a rangos se hace aquí (las
+// distribuciones de la biblioteca estándar dan resultados distintos según la implementación).
+
+const char* const ESPECIALISTAS_GENERADOS[] = {"Ana", "Luis", "Marta", "Carlos", "Elena",
+                                               "Jorge", "Sofia", "Pedro", "Lucia", "Diego"};
+
+class GeneradorPlanta {
+private:
+    std::mt19937_64 aleatorio;
+    size_t siguienteCodigo = 0;
+
+public:
+    // Mezcla de tipos de motor (el resto son de trabajo) y proporción de motores de trabajo artesanales
+    double proporcionAlta = 0.40;
+    double proporcionFuerza = 0.25;
+    double proporcionArtesanal = 0.30;
+
+    explicit GeneradorPlanta(uint64_t semilla) : aleatorio(semilla) {}
+
+    // Entero uniforme en [minimo, maximo]
+    long entero(long minimo, long maximo) {
+        return minimo + static_cast<long>(aleatorio() % static_cast<uint64_t>(maximo - minimo + 1));
+    }
+
+    // Decimal uniforme en [minimo, maximo)
+    double decimal(double minimo, double maximo) {
+        return minimo + (aleatorio() >> 11) * (1.0 / 9007199254740992.0) * (maximo - minimo);
+    }
+
+    bool probabilidad(double p) {
+        return decimal(0, 1) < p;
+    }
+
+    // Fecha al azar de 2024 entre los meses primerMes y ultimoMes
+    std::string fecha(long primerMes, long ultimoMes) {
+        char texto[16];
+        std::snprintf(texto, sizeof(texto), "%02ld/%02ld/2024", entero(1, 28), entero(primerMes, ultimoMes));
+        return texto;
+    }
+
+    // Cantidad de veces que el motor volvió a ensamblaje: la mayoría nunca, pocos varias veces
+    int vecesReensamblado() {
+        double p = decimal(0, 1);
+        return p < 0.70 ? 0 : p < 0.90 ? 1 : static_cast<int>(entero(2, 5));
+    }
+
+    DatosMotor generarMotor() {
+        DatosMotor motor;
+        double p = decimal(0, 1);
+        motor.tipo = p < proporcionAlta ? TipoMotor::Alta
+                   : p < proporcionAlta + proporcionFuerza ? TipoMotor::Fuerza : TipoMotor::Trabajo;
+
+        // Código de 12 caracteres: letra del tipo y número de serie de 11 dígitos
+        char codigo[24];
+        const char letra = motor.tipo == TipoMotor::Alta ? 'A' : motor.tipo == TipoMotor::Fuerza ? 'F' : 'T';
+        std::snprintf(codigo, sizeof(codigo), "%c%011zu", letra, siguienteCodigo++);
+        motor.codigo = codigo;
+        motor.fechaSalida = fecha(1, 6);
+        motor.especialista = ESPECIALISTAS_GENERADOS[entero(0, std::size(ESPECIALISTAS_GENERADOS) - 1)];
+        motor.vecesReensamblado = vecesReensamblado();
+        motor.maxRPM = static_cast<double>(entero(6000, 15000));
+        motor.consumo = std::round(decimal(3, 15) * 10) / 10;
+        motor.caballosFuerza = static_cast<int>(entero(80, 4000));
+        motor.artesanal = probabilidad(proporcionArtesanal);
+        return motor;
+    }
+
+    // Los pedidos siguen la misma mezcla que los motores; los de trabajo son De Lujo con la proporción
+    // de motores artesanales. Los motores salen en el primer semestre y los carros en el segundo, así que
+    // ningún carro sale antes que el motor que se le asigne, sea cual sea.
+    PedidoCarro generarPedido() {
+        PedidoCarro pedido;
+        double p = decimal(0, 1);
+        if (p < proporcionAlta) {
+            pedido.tipo = TipoCarro::Formula1;
+        } else if (p < proporcionAlta + proporcionFuerza) {
+            pedido.tipo = TipoCarro::Omnibus;
+        } else {
+            pedido.tipo = probabilidad(proporcionArtesanal) ? TipoCarro::DeLujo : TipoCarro::Sport;
+        }
+        pedido.fechaSalida = fecha(7, 12);
+        pedido.velocidad = std::round(decimal(60, 350));
+        pedido.pesoCarroceria = std::round(decimal(500, 800));
+        pedido.cantidadPuertas = static_cast<int>(entero(1, 4));
+        pedido.cantidadPlazas = static_cast<int>(entero(2, 4));
+        pedido.cantidadVelocidades = static_cast<int>(entero(4, 7));
+        pedido.cambioUniversal = probabilidad(0.5);
+        pedido.costoTapiceria = std::round(decimal(100, 1000));
+        return pedido;
+    }
+};
+
+// Escribe un archivo de importación con cantidadMotores motores y un pedido de carro por cada dos motores,
+// intercalados en el orden en que llegarían a la planta
+bool generarArchivoImportacion(const std::string& ruta, size_t cantidadMotores, uint64_t semilla) {
+    FILE* archivo = std::fopen(ruta.c_str(), "w");
+    if (!archivo) {
+        std::cout << "No se pudo crear " << ruta << "." << std::endl;
+        return false;
+    }
+    GeneradorPlanta generador(semilla);
+    std::fprintf(archivo, "# Datos sintéticos: %zu motores, semilla %llu\n", cantidadMotores,
+                 static_cast<unsigned long long>(semilla));
+    for (size_t i = 0; i < cantidadMotores; ++i) {
+        DatosMotor motor = generador.generarMotor();
+        const char* codigo = motor.codigo.c_str();
+        switch (motor.tipo) {
+            case TipoMotor::Alta:
+                std::fprintf(archivo, "MOTOR,ALTA,%s,%s,%s,%d,%g,%g\n", codigo, motor.fechaSalida.c_str(),
+                             motor.especialista.c_str(), motor.vecesReensamblado, motor.maxRPM, motor.consumo);
+                break;
+            case TipoMotor::Fuerza:
+                std::fprintf(archivo, "MOTOR,FUERZA,%s,%s,%s,%d,%d\n", codigo, motor.fechaSalida.c_str(),
+                             motor.especialista.c_str(), motor.vecesReensamblado, motor.caballosFuerza);
+                break;
+            default:
+                std::fprintf(archivo, "MOTOR,TRABAJO,%s,%s,%s,%d,%d\n", codigo, motor.fechaSalida.c_str(),
+                             motor.especialista.c_str(), motor.vecesReensamblado, motor.artesanal ? 1 : 0);
+                break;
+        }
+        if (i % 2 == 1) {
+            PedidoCarro pedido = generador.generarPedido();
+            const char* fecha = pedido.fechaSalida.c_str();
+            switch (pedido.tipo) {
+                case TipoCarro::Formula1:
+                    std::fprintf(archivo, "CARRO,FORMULA1,%s,%g,%g\n", fecha, pedido.velocidad, pedido.pesoCarroceria);
+                    break;
+                case TipoCarro::Omnibus:
+                    std::fprintf(archivo, "CARRO,OMNIBUS,%s,%g,%d\n", fecha, pedido.velocidad, pedido.cantidadPuertas);
+                    break;
+                case TipoCarro::Sport:
+                    std::fprintf(archivo, "CARRO,SPORT,%s,%g,%d,%d,%d\n", fecha, pedido.velocidad, pedido.cantidadPlazas,
+                                 pedido.cantidadVelocidades, pedido.cambioUniversal ? 1 : 0);
+                    break;
+                default:
+                    std::fprintf(archivo, "CARRO,DELUJO,%s,%g,%d,%g\n", fecha, pedido.velocidad, pedido.cantidadPlazas,
+                                 pedido.costoTapiceria);
+                    break;
+            }
+        }
+    }
+    bool correcto = std::fclose(archivo) == 0;
+    std::cout << "Archivo " << ruta << " generado con " << cantidadMotores << " motores." << std::endl;
+    return correcto;
+}
+
+// Banco de pruebas de las operaciones del menú
+// Para cada escala genera la planta desde cero con la misma semilla y mide: alta de motores, ensamblaje
+// de un pedido por cada dos motores, baja de uno de cada diez carros, los diez reportes del menú (con la
+// salida descartada en /dev/null) y, al final, el reensamblaje de los carros dados de baja (régimen
+// estable: los contenedores ya tienen capacidad y los pools ranuras libres). Cada medición incluye las
+// asignaciones de memoria. Los resultados se muestran en una tabla y se escriben en JSON para comparar
+// versiones.
+
+struct MedicionBanco {
+    size_t escala;
+    std::string operacion;
+    size_t cantidad;
+    double ms;
+    ConteoAsignaciones asignaciones;
+};
+
+// Ejecuta funcion con la salida estándar redirigida a /dev/null y devuelve los milisegundos
+template <typename Funcion>
+double medirSinSalida(Funcion funcion) {
+    std::cout.flush();
+    std::fflush(stdout);
+    int salidaOriginal = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    dup2(nulo, STDOUT_FILENO);
+    close(nulo);
+
+    auto inicio = std::chrono::steady_clock::now();
+    funcion();
+    std::cout.flush();
+    std::fflush(stdout);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+
+    dup2(salidaOriginal, STDOUT_FILENO);
+    close(salidaOriginal);
+    return ms;
+}
+
+template <typename Funcion>
+double medirMs(Funcion funcion) {
+    auto inicio = std::chrono::steady_clock::now();
+    funcion();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// Pedido que vuelve a ensamblar un carro como carro (con el motor que esté disponible en ese momento)
+PedidoCarro pedidoDeCarro(const Carro& carro) {
+    PedidoCarro pedido;
+    pedido.tipo = carro.getTipo();
+    pedido.fechaSalida = carro.getFechaSalida().texto();
+    pedido.velocidad = carro.getVelocidad();
+    pedido.cantidadPlazas = carro.getCantidadPlazas();
+    visitarCarro(carro, Sobrecarga{
+        [&](const Formula1& formula1) { pedido.pesoCarroceria = formula1.getPesoCarroceria(); },
+        [&](const Omnibus& omnibus) { pedido.cantidadPuertas = omnibus.getCantidadPuertas(); },
+        [&](const Sport& sport) {
+            pedido.cantidadVelocidades = sport.getCantidadVelocidades();
+            pedido.cambioUniversal = sport.esCambioUniversal();
+        },
+        [&](const DeLujo& deLujo) { pedido.costoTapiceria = deLujo.getCostoTapiceria(); }
+    });
+    return pedido;
+}
+
+void medirEscalaBanco(size_t escala, uint64_t semilla, std::vector<MedicionBanco>& mediciones) {
+    planta.liberarInventario();
+
+    GeneradorPlanta generador(semilla);
+    std::vector<DatosMotor> motores;
+    motores.reserve(escala);
+    for (size_t i = 0; i < escala; ++i) {
+        motores.push_back(generador.generarMotor());
+    }
+    std::vector<PedidoCarro> pedidos;
+    pedidos.reserve(escala / 2);
+    for (size_t i = 0; i < escala / 2; ++i) {
+        pedidos.push_back(generador.generarPedido());
+    }
+
+    // Mide funcion (sin salida o con ella) y las asignaciones que hace
+    auto medir = [&](const char* operacion, size_t cantidad, bool sinSalida, auto funcion) {
+        ConteoAsignaciones inicio = leerAsignaciones();
+        double ms = sinSalida ? medirSinSalida(funcion) : medirMs(funcion);
+        ConteoAsignaciones asignaciones = asignacionesDesde(inicio);
+        mediciones.push_back({escala, operacion, cantidad, ms, asignaciones});
+    };
+
+    size_t altas = 0, ensamblados = 0, bajas = 0, reensamblados = 0;
+    medir("agregar_motor", escala, false, [&] {
+        for (const auto& motor : motores) {
+            altas += planta.agregarMotor(motor) == Resultado::Exito;
+        }
+    });
+    medir("ensamblar_carro", pedidos.size(), false, [&] {
+        for (const auto& pedido : pedidos) {
+            ensamblados += planta.ensamblarCarro(pedido) == Resultado::Exito;
+        }
+    });
+
+    std::vector<std::string> codigosBaja;
+    std::vector<PedidoCarro> pedidosBaja;
+    const std::vector<Carro*>& carros = planta.carros();
+    for (size_t i = 0; i < carros.size(); i += 10) {
+        codigosBaja.push_back(carros[i]->getMotor()->getCodigo().texto());
+        pedidosBaja.push_back(pedidoDeCarro(*carros[i]));
+    }
+    medir("dar_de_baja_carro", codigosBaja.size(), false, [&] {
+        for (const auto& codigo : codigosBaja) {
+            bajas += planta.darDeBajaCarro(codigo) == Resultado::Exito;
+        }
+    });
+
+    struct ReporteBanco {
+        const char* nombre;
+        void (*funcion)();
+    };
+    const ReporteBanco reportes[] = {
+        {"reporte_motores_disponibles", mostrarMotoresDisponibles},
+        {"reporte_carros_alta_velocidad", mostrarCarrosAltaVelocidad},
+        {"reporte_omnibus_mayor_capacidad", mostrarOmnibusMayorCapacidad},
+        {"reporte_fichas_tecnicas", mostrarFichasTecnicasCarros},
+        {"reporte_motores_reensamblados", mostrarCarrosConMotoresReensamblados},
+        {"reporte_cumplimiento_plan", mostrarCumplimientoPlan},
+        {"reporte_ganancia_total", mostrarGananciaTotal},
+        {"reporte_estadisticas_memoria", mostrarEstadisticasMemoria},
+        {"reporte_tablero_produccion", mostrarTableroProduccion},
+        {"reporte_verificar_agregados", verificarAgregadosInteractivo},
+    };
+    size_t motoresDisponibles = planta.cantidadMotoresDisponibles(TipoMotor::Alta) +
+                                planta.cantidadMotoresDisponibles(TipoMotor::Fuerza) +
+                                planta.cantidadMotoresDisponibles(TipoMotor::Trabajo);
+    ConfiguracionReporte configuracionAnterior = configuracionReporte;
+    configuracionReporte = ConfiguracionReporte();
+    for (const auto& reporte : reportes) {
+        size_t cantidad = reporte.funcion == mostrarMotoresDisponibles ? motoresDisponibles : carros.size();
+        medir(reporte.nombre, cantidad, true, reporte.funcion);
+    }
+    configuracionReporte = configuracionAnterior;
+    medir("reensamblar_carro", pedidosBaja.size(), false, [&] {
+        for (const auto& pedido : pedidosBaja) {
+            reensamblados += planta.ensamblarCarro(pedido) == Resultado::Exito;
+        }
+    });
+
+    std::printf("Escala %zu: %zu motores, %zu carros ensamblados, %zu bajas, %zu reensamblados\n", escala, altas,
+                ensamblados, bajas, reensamblados);
+    planta.liberarInventario();
+}
+
+bool escribirResultadosBanco(const std::string& ruta, uint64_t semilla, const std::vector<MedicionBanco>& mediciones) {
+    FILE* archivo = std::fopen(ruta.c_str(), "w");
+    if (!archivo) {
+        return false;
+    }
+    std::fprintf(archivo, "{\n  \"compilacion\": \"%s %s\",\n  \"fecha\": %lld,\n  \"semilla\": %llu,\n", __DATE__,
+                 __TIME__, static_cast<long long>(std::time(nullptr)), static_cast<unsigned long long>(semilla));
+    std::fprintf(archivo, "  \"hilosReportes\": %d,\n  \"columnar\": %s,\n  \"mediciones\": [\n", hilosReportes,
+                 planta.usaAlmacenColumnar() ? "true" : "false");
+    for (size_t i = 0; i < mediciones.size(); ++i) {
+        const MedicionBanco& medicion = mediciones[i];
+        std::fprintf(archivo, "    {\"escala\": %zu, \"operacion\": \"%s\", \"cantidad\": %zu, \"ms\": %.4f, "
+                              "\"nsPorElemento\": %.2f, \"asignaciones\": %llu, \"bytesAsignados\": %llu}%s\n",
+                     medicion.escala, medicion.operacion.c_str(), medicion.cantidad, medicion.ms,
+                     medicion.cantidad ? medicion.ms * 1e6 / medicion.cantidad : 0.0,
+                     static_cast<unsigned long long>(medicion.asignaciones.asignaciones),
+                     static_cast<unsigned long long>(medicion.asignaciones.bytes), i + 1 < mediciones.size() ? "," : "");
+    }
+    std::fprintf(archivo, "  ]\n}\n");
+    return std::fclose(archivo) == 0;
+}
+
+void ejecutarBancoPruebas(const std::vector<size_t>& escalas, uint64_t semilla, const std::string& archivoResultados) {
+    // El banco reemplaza el inventario: no debe quedar registrado en el diario
+    planta.cerrarDiario();
+
+    bool contabaAsignaciones = contarAsignaciones.exchange(true);
+    std::vector<MedicionBanco> mediciones;
+    for (size_t escala : escalas) {
+        medirEscalaBanco(escala, semilla, mediciones);
+    }
+    contarAsignaciones = contabaAsignaciones;
+
+    std::printf("%-12s %-34s %10s %12s %12s %12s\n", "Escala", "Operación", "Cantidad", "ms", "ns/elemento",
+                "Asignaciones");
+    for (const auto& medicion : mediciones) {
+        std::printf("%-12zu %-34s %10zu %12.3f %12.1f %12llu\n", medicion.escala, medicion.operacion.c_str(),
+                    medicion.cantidad, medicion.ms, medicion.cantidad ? medicion.ms * 1e6 / medicion.cantidad : 0.0,
+                    static_cast<unsigned long long>(medicion.asignaciones.asignaciones));
+    }
+    if (escribirResultadosBanco(archivoResultados, semilla, mediciones)) {
+        std::printf("Resultados guardados en %s\n", archivoResultados.c_str());
+    } else {
+        std::printf("No se pudieron guardar los resultados en %s\n", archivoResultados.c_str());
+    }
+    std::fflush(stdout);
+}
+
+// Una operación leída de la traza; se reutiliza entre registros para no volver a asignar sus cadenas
+struct OperacionGrabada {
+    uint64_t nanosegundos = 0;    // Desde la operación anterior
+    OperacionPlanta operacion = OperacionPlanta::AgregarMotor;
+    DatosMotor motor;
+    std::vector<PedidoCarro> pedidos;    // Uno para EnsamblarCarro
+    std::string codigo;
+    Fecha desde;                         // También la fecha de corte
+    Fecha hasta;
+    int anio = 0;
+    int hastaMes = 0;
+    ClasificacionTrazada clasificacion = ClasificacionTrazada::Rentables;
+    size_t k = 0;
+    uint8_t tipo = 0;                    // Tipo de carro o de motor de la clasificación
+    ClaseHistorico clase = ClaseHistorico::Archivado;
+};
+
+int leerEnteroTraza(LectorBinario& lector) {
+    return static_cast<int>(decodificarZigzag(lector.varint()));
+}
+
+Fecha leerFechaTraza(LectorBinario& lector) {
+    return Fecha::desdeDia(static_cast<int32_t>(decodificarZigzag(lector.varint())));
+}
+
+bool leerMotorTraza(LectorBinario& lector, DatosMotor& motor) {
+    uint8_t tipo = lector.valor<uint8_t>();
+    if (tipo > static_cast<uint8_t>(TipoMotor::Trabajo)) {
+        return false;
+    }
+    motor.tipo = static_cast<TipoMotor>(tipo);
+    motor.codigo = lector.vistaCadena();
+    motor.fechaSalida = lector.vistaCadena();
+    motor.especialista = lector.vistaCadena();
+    motor.vecesReensamblado = leerEnteroTraza(lector);
+    switch (motor.tipo) {
+        case TipoMotor::Alta:
+            motor.maxRPM = lector.valor<double>();
+            motor.consumo = lector.valor<double>();
+            break;
+        case TipoMotor::Fuerza:
+            motor.caballosFuerza = leerEnteroTraza(lector);
+            break;
+        default:
+            motor.artesanal = lector.valor<uint8_t>();
+            break;
+    }
+    return lector.esCorrecto();
+}
+
+bool leerPedidoTraza(LectorBinario& lector, PedidoCarro& pedido) {
+    uint8_t tipo = lector.valor<uint8_t>();
+    if (tipo >= CANTIDAD_TIPOS_CARRO) {
+        return false;
+    }
+    pedido = PedidoCarro();
+    pedido.tipo = static_cast<TipoCarro>(tipo);
+    pedido.fechaSalida = lector.vistaCadena();
+    pedido.velocidad = lector.valor<double>();
+    switch (pedido.tipo) {
+        case TipoCarro::Formula1:
+            pedido.pesoCarroceria = lector.valor<double>();
+            break;
+        case TipoCarro::Omnibus:
+            pedido.cantidadPuertas = leerEnteroTraza(lector);
+            break;
+        case TipoCarro::Sport:
+            pedido.cantidadPlazas = leerEnteroTraza(lector);
+            pedido.cantidadVelocidades = leerEnteroTraza(lector);
+            pedido.cambioUniversal = lector.valor<uint8_t>();
+            break;
+        default:
+            pedido.cantidadPlazas = leerEnteroTraza(lector);
+            pedido.costoTapiceria = lector.valor<double>();
+            break;
+    }
+    return lector.esCorrecto();
+}
+
+// Lee el contenido de un registro; devuelve false si está dañado
+bool leerOperacionGrabada(LectorBinario& lector, OperacionGrabada& grabada) {
+    grabada.nanosegundos = lector.varint();
+    uint8_t operacion = lector.valor<uint8_t>();
+    if (!lector.esCorrecto() || operacion >= CANTIDAD_OPERACIONES_PLANTA ||
+        operacion == static_cast<uint8_t>(OperacionPlanta::Importar)) {
+        return false;
+    }
+    grabada.operacion = static_cast<OperacionPlanta>(operacion);
+    bool correcto = true;
+    switch (grabada.operacion) {
+        case OperacionPlanta::AgregarMotor:
+            correcto = leerMotorTraza(lector, grabada.motor);
+            break;
+        case OperacionPlanta::EnsamblarCarro:
+            grabada.pedidos.resize(1);
+            correcto = leerPedidoTraza(lector, grabada.pedidos[0]);
+            break;
+        case OperacionPlanta::EnsamblarLote: {
+            uint64_t cantidad = lector.varint();
+            // Cada pedido ocupa al menos 11 bytes: una cantidad mayor es un registro dañado
+            if (cantidad > lector.restantes() / 11) {
+                return false;
+            }
+            grabada.pedidos.resize(cantidad);
+            for (PedidoCarro& pedido : grabada.pedidos) {
+                correcto = correcto && leerPedidoTraza(lector, pedido);
+            }
+            break;
+        }
+        case OperacionPlanta::DarDeBajaCarro:
+            grabada.codigo = lector.vistaCadena();
+            break;
+        case OperacionPlanta::ArchivarCarros:
+        case OperacionPlanta::ProyeccionPlan:
+            grabada.desde = leerFechaTraza(lector);
+            break;
+        case OperacionPlanta::ProduccionEntre:
+            grabada.desde = leerFechaTraza(lector);
+            grabada.hasta = leerFechaTraza(lector);
+            break;
+        case OperacionPlanta::CumplimientoMensual:
+            grabada.anio = leerEnteroTraza(lector);
+            grabada.hastaMes = leerEnteroTraza(lector);
+            correcto = grabada.hastaMes <= 12;
+            break;
+        case OperacionPlanta::Clasificacion: {
+            uint8_t clasificacion = lector.valor<uint8_t>();
+            grabada.k = lector.varint();
+            grabada.tipo = 0;
+            if (clasificacion == static_cast<uint8_t>(ClasificacionTrazada::Rentables)) {
+                grabada.tipo = lector.valor<uint8_t>();
+                correcto = grabada.tipo <= CANTIDAD_TIPOS_CARRO;
+            } else if (clasificacion == static_cast<uint8_t>(ClasificacionTrazada::MotoresBaratos)) {
+                grabada.tipo = lector.valor<uint8_t>();
+                correcto = grabada.tipo <= static_cast<uint8_t>(TipoMotor::Trabajo);
+            } else if (clasificacion > static_cast<uint8_t>(ClasificacionTrazada::MotoresBaratos)) {
+                return false;
+            }
+            grabada.clasificacion = static_cast<ClasificacionTrazada>(clasificacion);
+            break;
+        }
+        case OperacionPlanta::ConsultarHistorico: {
+            uint8_t clase = lector.valor<uint8_t>();
+            grabada.desde = leerFechaTraza(lector);
+            grabada.hasta = leerFechaTraza(lector);
+            correcto = clase <= static_cast<uint8_t>(ClaseHistorico::Retirado);
+            grabada.clase = static_cast<ClaseHistorico>(clase);
+            break;
+        }
+        default:
+            break;
+    }
+    return correcto && lector.esCorrecto() && lector.terminado();
+}
+
+// Ejecuta la operación como lo harían el menú o el servicio, con los reportes escritos en descarte.
+// Devuelve false si la planta la rechazó, si no había ómnibus para el reporte, si los agregados no
+// coincidieron con el recálculo o si no se pudo leer el archivo histórico.
+bool ejecutarOperacionGrabada(const OperacionGrabada& grabada, FILE* descarte) {
+    ConfiguracionReporte configuracion;
+    switch (grabada.operacion) {
+        case OperacionPlanta::AgregarMotor: {
+            bool exito = planta.agregarMotor(grabada.motor) == Resultado::Exito;
+            planta.confirmarDiario();
+            return exito;
+        }
+        case OperacionPlanta::EnsamblarCarro: {
+            bool exito = planta.ensamblarCarro(grabada.pedidos[0]) == Resultado::Exito;
+            planta.confirmarDiario();
+            return exito;
+        }
+        case OperacionPlanta::EnsamblarLote: {
+            AsignacionLote lote = planta.ensamblarLote(grabada.pedidos);
+            planta.confirmarDiario();
+            return lote.ensamblados == static_cast<long>(grabada.pedidos.size());
+        }
+        case OperacionPlanta::DarDeBajaCarro: {
+            bool exito = planta.darDeBajaCarro(grabada.codigo) == Resultado::Exito;
+            planta.confirmarDiario();
+            return exito;
+        }
+        case OperacionPlanta::ArchivarCarros: {
+            bool exito = planta.archivarCarros(grabada.desde).resultado == Resultado::Exito;
+            planta.confirmarDiario();
+            return exito;
+        }
+        case OperacionPlanta::MotoresDisponibles: {
+            MotoresDisponibles motores = planta.motoresDisponibles();
+            EscritorReporte escritor(configuracion, descarte);
+            escribirReporteMotoresDisponibles(escritor, motores);
+            return true;
+        }
+        case OperacionPlanta::CarrosAltaVelocidad: {
+            std::vector<const Carro*> carros = planta.carrosAltaVelocidad();
+            EscritorReporte escritor(configuracion, descarte);
+            escribirReporteAltaVelocidad(escritor, carros);
+            return true;
+        }
+        case OperacionPlanta::OmnibusMayorCapacidad: {
+            const Carro* omnibus = planta.omnibusMayorCapacidad();
+            if (!omnibus) {
+                return false;
+            }
+            EscritorReporte escritor(configuracion, descarte);
+            escribirReporteOmnibus(escritor, *omnibus);
+            return true;
+        }
+        case OperacionPlanta::FichasCarros: {
+            MedicionLatencia medicion(OperacionPlanta::FichasCarros);
+            const std::vector<Carro*>& carros = planta.carros();
+            EscritorReporte escritor(configuracion, descarte);
+            escribirReporteFichas(escritor, carros.size(), [&carros](size_t i) -> const Carro& { return *carros[i]; });
+            return true;
+        }
+        case OperacionPlanta::CarrosReensamblados: {
+            std::vector<CarroReensamblado> carros = planta.carrosConMotoresReensamblados();
+            EscritorReporte escritor(configuracion, descarte);
+            escribirReporteReensamblados(escritor, carros);
+            return true;
+        }
+        case OperacionPlanta::CumplimientoPlan:
+            planta.cumplimientoPlan();
+            return true;
+        case OperacionPlanta::ProduccionEntre:
+            planta.produccionEntre(grabada.desde, grabada.hasta);
+            return true;
+        case OperacionPlanta::CumplimientoMensual:
+            planta.cumplimientoMensual(grabada.anio, grabada.hastaMes);
+            return true;
+        case OperacionPlanta::ProyeccionPlan:
+            planta.proyeccionPlan(grabada.desde);
+            return true;
+        case OperacionPlanta::Ganancias:
+            planta.ganancias();
+            return true;
+        case OperacionPlanta::Tablero:
+            planta.tablero();
+            return true;
+        case OperacionPlanta::CompararAgregados:
+            return planta.compararAgregados().coinciden;
+        case OperacionPlanta::EstadisticasMemoria:
+            planta.estadisticasMemoria();
+            return true;
+        case OperacionPlanta::EstadisticasEspecialistas:
+            planta.estadisticasEspecialistas();
+            return true;
+        case OperacionPlanta::Clasificacion:
+            switch (grabada.clasificacion) {
+                case ClasificacionTrazada::Rentables: {
+                    std::optional<TipoCarro> tipo;
+                    if (grabada.tipo > 0) {
+                        tipo = static_cast<TipoCarro>(grabada.tipo - 1);
+                    }
+                    planta.carrosMasRentables(grabada.k, tipo);
+                    return true;
+                }
+                case ClasificacionTrazada::Rapidos:
+                    planta.carrosMasRapidos(grabada.k);
+                    return true;
+                case ClasificacionTrazada::Omnibus:
+                    planta.omnibusDeMayorCapacidad(grabada.k);
+                    return true;
+                default:
+                    planta.motoresMasBaratos(static_cast<TipoMotor>(grabada.tipo), grabada.k);
+                    return true;
+            }
+        case OperacionPlanta::ConsultarHistorico: {
+            EscritorReporte escritor(configuracion, descarte);
+            auto escribirFicha = [&escritor](const Carro& carro) { return escribirFichaListado(escritor, carro); };
+            return planta.recorrerHistorico(grabada.clase, grabada.desde, grabada.hasta, escribirFicha);
+        }
+        default:
+            return false;
+    }
+}
+
+// Percentil por el método del rango más cercano, sobre latencias ordenadas
+uint64_t percentilOrdenado(const std::vector<uint64_t>& ordenadas, double percentil) {
+    size_t rango = static_cast<size_t>(std::ceil(percentil / 100 * ordenadas.size()));
+    return ordenadas[std::max<size_t>(rango, 1) - 1];
+}
+
+struct LatenciasReproduccion {
+    std::vector<uint64_t> ns;
+    long rechazadas = 0;
+};
+
+// ritmo 0: lo más rápido posible; si no, factor de velocidad respecto de los tiempos grabados
+int reproducirTraza(const std::string& ruta, double ritmo) {
+    FILE* archivo = std::fopen(ruta.c_str(), "rb");
+    if (!archivo) {
+        std::cout << "No se pudo abrir la traza " << ruta << "." << std::endl;
+        return 1;
+    }
+    std::string contenido;
+    char bloque[1 << 16];
+    size_t leidos;
+    while ((leidos = std::fread(bloque, 1, sizeof(bloque), archivo)) > 0) {
+        contenido.append(bloque, leidos);
+    }
+    std::fclose(archivo);
+    LectorBinario cabecera(contenido.data(), contenido.size());
+    std::string_view magia = cabecera.vistaBytes(sizeof(MAGIA_TRAZA));
+    uint32_t version = cabecera.valor<uint32_t>();
+    if (!cabecera.esCorrecto() || magia != std::string_view(MAGIA_TRAZA, sizeof(MAGIA_TRAZA)) ||
+        version != VERSION_TRAZA) {
+        std::cout << "El archivo " << ruta << " no es una traza de carga soportada." << std::endl;
+        return 1;
+    }
+
+    FILE* descarte = std::fopen("/dev/null", "w");
+    if (!descarte) {
+        std::cout << "No se pudo abrir /dev/null para descartar los reportes." << std::endl;
+        return 1;
+    }
+    // La reproducción es una prueba de carga: no se registra en el diario, y los carros que agregue al
+    // archivo histórico se recortan al terminar
+    planta.cerrarDiario();
+    uint64_t registrosHistoricoIniciales = planta.resumenHistorico().registros;
+    std::vector<LatenciasReproduccion> latencias(CANTIDAD_OPERACIONES_PLANTA);
+    LectorBinario lector(contenido.data() + TAMANO_CABECERA_TRAZA, contenido.size() - TAMANO_CABECERA_TRAZA);
+    OperacionGrabada grabada;
+    uint64_t instanteGrabado = 0;    // Nanosegundos desde el inicio de la grabación
+    uint64_t mayorAtrasoNs = 0;
+    long reproducidas = 0;
+    bool incompleta = false;
+    bool danada = false;
+
+    auto inicio = std::chrono::steady_clock::now();
+    while (!lector.terminado()) {
+        uint64_t longitud = lector.varint();
+        std::string_view registro = lector.vistaBytes(longitud);
+        if (!lector.esCorrecto()) {
+            incompleta = true;
+            break;
+        }
+        LectorBinario campos(registro.data(), registro.size());
+        if (!leerOperacionGrabada(campos, grabada)) {
+            danada = true;
+            break;
+        }
+
+        instanteGrabado += grabada.nanosegundos;
+        if (ritmo > 0) {
+            auto programado = inicio + std::chrono::nanoseconds(static_cast<int64_t>(instanteGrabado / ritmo));
+            auto ahora = std::chrono::steady_clock::now();
+            if (ahora < programado) {
+                std::this_thread::sleep_until(programado);
+            } else {
+                mayorAtrasoNs = std::max<uint64_t>(
+                    mayorAtrasoNs, std::chrono::duration_cast<std::chrono::nanoseconds>(ahora - programado).count());
+            }
+        }
+
+        auto comienzo = std::chrono::steady_clock::now();
+        bool exito = ejecutarOperacionGrabada(grabada, descarte);
+        auto duracion = std::chrono::steady_clock::now() - comienzo;
+        LatenciasReproduccion& destino = latencias[static_cast<int>(grabada.operacion)];
+        destino.ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(duracion).count());
+        destino.rechazadas += !exito;
+        reproducidas++;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    std::fclose(descarte);
+
+    std::printf("Reproducción de %s: %ld operaciones en %.3f ms (%.0f por segundo)\n", ruta.c_str(), reproducidas,
+                ms, ms > 0 ? reproducidas * 1000 / ms : 0.0);
+    if (ritmo > 0) {
+        std::printf("Al ritmo grabado (x%g); mayor atraso respecto de la traza: %.3f ms\n", ritmo, mayorAtrasoNs / 1e6);
+    }
+    if (incompleta) {
+        std::printf("Se descartó un registro incompleto al final de la traza.\n");
+    }
+    if (danada) {
+        std::printf("El registro %ld de la traza está dañado; la reproducción se detuvo ahí.\n", reproducidas + 1);
+    }
+    std::printf("%-28s %10s %10s %11s %11s %11s %11s %11s\n", "Operación", "Cantidad", "Rechazadas", "p50 (us)",
+                "p90 (us)", "p99 (us)", "p99.9 (us)", "Máx (us)");
+    for (int i = 0; i < CANTIDAD_OPERACIONES_PLANTA; ++i) {
+        std::vector<uint64_t>& ns = latencias[i].ns;
+        if (ns.empty()) {
+            continue;
+        }
+        std::sort(ns.begin(), ns.end());
+        std::printf("%-28s %10zu %10ld %11.1f %11.1f %11.1f %11.1f %11.1f\n",
+                    nombreOperacionPlanta(static_cast<OperacionPlanta>(i)), ns.size(), latencias[i].rechazadas,
+                    percentilOrdenado(ns, 50) / 1e3, percentilOrdenado(ns, 90) / 1e3, percentilOrdenado(ns, 99) / 1e3,
+                    percentilOrdenado(ns, 99.9) / 1e3, ns.back() / 1e3);
+    }
+    std::fflush(stdout);
+
+    bool historicoRestaurado = planta.recortarHistorico(registrosHistoricoIniciales);
+    if (!archivoMetricas.empty()) {
+        volcarMetricas();
+    }
+    planta.liberarInventario();
+    return danada || !historicoRestaurado ? 1 : 0;
+}
+
+void menuPrincipal() {
+    int opcion = 0;
+    do {
+        std::cout << "\n----- Menú Principal -----" << std::endl;
+        std::cout << "1. Agregar motor" << std::endl;
         std::cout << "2. Ensamblar carro" << std::endl;
         std::cout << "3. Mostrar motores disponibles" << std::endl;
         std::cout << "4. Mostrar carros de mayor velocidad" << std::endl;
@@ -728,9 +2780,30 @@ void menuPrincipal() {
         std::cout << "8. Mostrar carros con motores reensamblados" << std::endl;
         std::cout << "9. Mostrar porcentaje de cumplimiento del plan" << std::endl;
         std::cout << "10. Mostrar ganancia total" << std::endl;
+        std::cout << "12. Importar motores y pedidos desde archivo" << std::endl;
+        std::cout << "13. Mostrar estadísticas de memoria" << std::endl;
+        std::cout << "14. Mostrar tablero de producción" << std::endl;
+        std::cout << "15. Verificar agregados de producción" << std::endl;
+        std::cout << "16. Configurar salida de reportes" << std::endl;
+        std::cout << "17. Guardar instantánea del estado (compacta el diario)" << std::endl;
+        std::cout << "18. Simular línea de ensamblaje concurrente" << std::endl;
+        std::cout << "19. Configurar hilos de los reportes" << std::endl;
+        std::cout << "20. Mostrar producción entre dos fechas" << std::endl;
+        std::cout << "21. Mostrar cumplimiento mensual y proyección del plan" << std::endl;
+        std::cout << "22. Mostrar calidad por especialista" << std::endl;
+        std::cout << "23. Mostrar métricas de operaciones" << std::endl;
+        std::cout << "24. Ensamblar lote de pedidos con la mayor ganancia" << std::endl;
+        std::cout << "25. Mostrar clasificaciones (los K mejores)" << std::endl;
+        std::cout << "26. Archivar carros anteriores a una fecha" << std::endl;
+        std::cout << "27. Consultar el archivo histórico" << std::endl;
         std::cout << "11. Salir" << std::endl;
         std::cout << "Seleccione una opción: ";
         std::cin >> opcion;
+        ConteoAsignaciones inicioOpcion = leerAsignaciones();
+        std::optional<MedicionLatencia> medicionAccion;
+        if (opcion >= 0 && opcion <= MAX_OPCION_MENU) {
+            medicionAccion.emplace(latenciaAccionesMenu[opcion]);
+        }
 
         switch (opcion) {
             case 1:
@@ -763,6 +2836,54 @@ void menuPrincipal() {
             case 10:
                 mostrarGananciaTotal();
                 break;
+            case 12:
+                importarDesdeArchivo();
+                break;
+            case 13:
+                mostrarEstadisticasMemoria();
+                break;
+            case 14:
+                mostrarTableroProduccion();
+                break;
+            case 15:
+                verificarAgregadosInteractivo();
+                break;
+            case 16:
+                configurarReportes();
+                break;
+            case 17:
+                guardarInstantaneaInteractivo();
+                break;
+            case 18:
+                medirLineaConcurrenteInteractivo();
+                break;
+            case 19:
+                configurarHilosReportes();
+                break;
+            case 20:
+                mostrarProduccionPeriodo();
+                break;
+            case 21:
+                mostrarCumplimientoMensual();
+                break;
+            case 22:
+                mostrarCalidadEspecialistas();
+                break;
+            case 23:
+                mostrarMetricas();
+                break;
+            case 24:
+                ensamblarLoteInteractivo();
+                break;
+            case 25:
+                mostrarClasificaciones();
+                break;
+            case 26:
+                archivarCarrosInteractivo();
+                break;
+            case 27:
+                consultarHistoricoInteractivo();
+                break;
             case 11:
                 std::cout << "Saliendo del programa..." << std::endl;
                 break;
@@ -770,19 +2891,21 @@ void menuPrincipal() {
                 std::cout << "Opción inválida. Intente de nuevo." << std::endl;
                 break;
         }
+        planta.confirmarDiario();
+        medicionAccion.reset();
+        volcarMetricasSiCorresponde();
+        if (contarAsignaciones) {
+            ConteoAsignaciones asignaciones = asignacionesDesde(inicioOpcion);
+            std::cout << "Asignaciones de memoria de la opción: " << asignaciones.asignaciones << " ("
+                      << asignaciones.bytes << " bytes)." << std::endl;
+        }
     } while (opcion != 11);
 
-    // Liberar memoria antes de salir
-    for (auto motor : motoresAltaDisponibles) {
-        delete motor;
-    }
-    for (auto motor : motoresFuerzaDisponibles) {
-        delete motor;
-    }
-    for (auto motor : motoresTrabajoDisponibles) {
-        delete motor;
-    }
-    for (auto carro : carrosEnsamblados) {
-        delete carro;
+    planta.cerrarEstado();
+    if (!archivoMetricas.empty()) {
+        volcarMetricas();
     }
+
+    // Liberar memoria antes de salir
+    planta.liberarInventario();
 }
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Prueba de regresión de ensamblarLote: un De Lujo y un Sport compiten por el único motor artesanal.
+# El motor tiene costo negativo (12 reensamblajes), así que en el De Lujo la ganancia sería -11000; el
+# lote debe dárselo al Sport (+1010) porque con cualquiera de los dos se atiende un pedido.
+#
+# Uso: pruebas/lote_artesanal.sh [ejecutable]    (por omisión, ./planta)
+
+PLANTA=${1:-./planta}
+DIRECTORIO=$(mktemp -d)
+trap 'rm -rf "$DIRECTORIO"' EXIT
+
+printf 'MOTOR,TRABAJO,ART000000001,01/01/2024,Ana,12,1\n' > "$DIRECTORIO/motores.csv"
+printf 'CARRO,DELUJO,02/02/2024,200,4,700\nCARRO,SPORT,02/02/2024,200,2,5,1\n' > "$DIRECTORIO/lote.csv"
+
+# La opción 11 sale del menú
+SALIDA=$(echo 11 | "$PLANTA" --importar "$DIRECTORIO/motores.csv" --lote "$DIRECTORIO/lote.csv")
+
+fallas=0
+for esperado in "Carros ensamblados: 1" "Ganancia del lote: 1010 "; do
+    if ! printf '%s\n' "$SALIDA" | grep -q "^$esperado"; then
+        echo "FALLA: no se encontró \"$esperado\""
+        fallas=1
+    fi
+done
+if [ $fallas -ne 0 ]; then
+    printf '%s\n' "$SALIDA" | grep "^Carros ensamblados\|^Ganancia del lote"
+    exit 1
+fi
+echo "lote_artesanal: correcto"